@@ -298,6 +298,9 @@ int guac_common_ssh_sftp_handle_file_stream(
             LIBSSH2_FXF_WRITE | LIBSSH2_FXF_CREAT | LIBSSH2_FXF_TRUNC,
             S_IRUSR | S_IWUSR);
 
+    /* Cached listings may no longer reflect the directory contents */
+    guac_common_listing_cache_invalidate(filesystem->listing_cache);
+
     /* Inform of status */
     if (file != NULL) {
 
@@ -474,31 +477,72 @@ void guac_common_ssh_sftp_set_upload_path(
 static int guac_common_ssh_sftp_ls_ack_handler(guac_user* user,
         guac_stream* stream, char* message, guac_protocol_status status) {
 
-    int bytes_read;
-    int blob_written = 0;
-
-    char filename[GUAC_COMMON_SSH_SFTP_MAX_PATH];
-    LIBSSH2_SFTP_ATTRIBUTES attributes;
-
     guac_common_ssh_sftp_ls_state* list_state =
         (guac_common_ssh_sftp_ls_state*) stream->data;
 
-    guac_common_ssh_sftp_filesystem* filesystem = list_state->filesystem;
-
-    LIBSSH2_SFTP* sftp = filesystem->sftp_session;
-
     /* If unsuccessful, free stream and abort */
     if (status != GUAC_PROTOCOL_STATUS_SUCCESS) {
-        libssh2_sftp_closedir(list_state->directory);
-        guac_user_free_stream(user, stream);
+        guac_common_listing_stream_abort(&list_state->listing, user, stream);
         free(list_state);
         return 0;
     }
 
-    /* While directory entries remain */
-    while ((bytes_read = libssh2_sftp_readdir(list_state->directory,
-                filename, sizeof(filename), &attributes)) > 0
-            && !blob_written) {
+    /* Send further entries, cleaning up once the listing is complete */
+    if (guac_common_listing_stream_ack(&list_state->listing, user, stream))
+        free(list_state);
+
+    return 0;
+
+}
+
+/**
+ * Reads the entire contents of the given directory over SFTP, or retrieves
+ * the contents from the listing cache of the given filesystem if the
+ * directory was read recently. The SFTP server returns many entries in
+ * response to each underlying read request, along with their attributes,
+ * such that only symbolic links require additional requests.
+ *
+ * @param user
+ *     The user requesting the directory listing.
+ *
+ * @param filesystem
+ *     The SFTP filesystem containing the directory.
+ *
+ * @param path
+ *     The absolute path of the directory.
+ *
+ * @return
+ *     A new reference to the listing of the given directory, which must be
+ *     released with guac_common_listing_release(), or NULL if the directory
+ *     cannot be opened.
+ */
+static guac_common_listing* guac_common_ssh_sftp_read_listing(
+        guac_user* user, guac_common_ssh_sftp_filesystem* filesystem,
+        const char* path) {
+
+    int bytes_read;
+
+    char filename[GUAC_COMMON_SSH_SFTP_MAX_PATH];
+    LIBSSH2_SFTP_ATTRIBUTES attributes;
+
+    LIBSSH2_SFTP* sftp = filesystem->sftp_session;
+
+    /* Use cached listing if available */
+    guac_common_listing* listing =
+        guac_common_listing_cache_get(filesystem->listing_cache, path);
+    if (listing != NULL)
+        return listing;
+
+    /* Open as directory */
+    LIBSSH2_SFTP_HANDLE* dir = libssh2_sftp_opendir(sftp, path);
+    if (dir == NULL)
+        return NULL;
+
+    listing = guac_common_listing_alloc(path);
+
+    /* Read all directory entries at once */
+    while ((bytes_read = libssh2_sftp_readdir(dir,
+                filename, sizeof(filename), &attributes)) > 0) {
 
         char absolute_path[GUAC_COMMON_SSH_SFTP_MAX_PATH];
 
@@ -507,8 +551,7 @@ static int guac_common_ssh_sftp_ls_ack_handler(guac_user* user,
             continue;
 
         /* Concatenate into absolute path - skip if invalid */
-        if (!guac_ssh_append_filename(absolute_path, 
-                    list_state->directory_name, filename)) {
+        if (!guac_ssh_append_filename(absolute_path, path, filename)) {
 
             guac_user_log(user, GUAC_LOG_DEBUG,
                     "Skipping filename \"%s\" - filename is invalid or "
@@ -528,31 +571,14 @@ static int guac_common_ssh_sftp_ls_ack_handler(guac_user* user,
         else
             mimetype = "application/octet-stream";
 
-        /* Write entry */
-        blob_written |= guac_common_json_write_property(user, stream,
-                &list_state->json_state, absolute_path, mimetype);
+        guac_common_listing_add(listing, absolute_path, mimetype);
 
     }
 
-    /* Complete JSON and cleanup at end of directory */
-    if (bytes_read <= 0) {
-
-        /* Complete JSON object */
-        guac_common_json_end_object(user, stream, &list_state->json_state);
-        guac_common_json_flush(user, stream, &list_state->json_state);
-
-        /* Clean up resources */
-        libssh2_sftp_closedir(list_state->directory);
-        free(list_state);
-
-        /* Signal of stream */
-        guac_protocol_send_end(user->socket, stream);
-        guac_user_free_stream(user, stream);
-
-    }
+    libssh2_sftp_closedir(dir);
 
-    guac_socket_flush(user->socket);
-    return 0;
+    guac_common_listing_cache_put(filesystem->listing_cache, listing);
+    return listing;
 
 }
 
@@ -592,9 +618,10 @@ static int guac_common_ssh_sftp_get_handler(guac_user* user,
     /* If directory, send contents of directory */
     if (LIBSSH2_SFTP_S_ISDIR(attributes.permissions)) {
 
-        /* Open as directory */
-        LIBSSH2_SFTP_HANDLE* dir = libssh2_sftp_opendir(sftp, name);
-        if (dir == NULL) {
+        /* Read entire directory (or use cached listing) */
+        guac_common_listing* listing =
+            guac_common_ssh_sftp_read_listing(user, filesystem, name);
+        if (listing == NULL) {
             guac_user_log(user, GUAC_LOG_INFO,
                     "Unable to read directory \"%s\"", name);
             return 0;
@@ -604,18 +631,16 @@ static int guac_common_ssh_sftp_get_handler(guac_user* user,
         guac_common_ssh_sftp_ls_state* list_state =
             malloc(sizeof(guac_common_ssh_sftp_ls_state));
 
-        list_state->directory = dir;
         list_state->filesystem = filesystem;
-        strncpy(list_state->directory_name, name,
-                sizeof(list_state->directory_name) - 1);
 
         /* Allocate stream for body */
         guac_stream* stream = guac_user_alloc_stream(user);
         stream->ack_handler = guac_common_ssh_sftp_ls_ack_handler;
         stream->data = list_state;
 
-        /* Init JSON object state */
-        guac_common_json_begin_object(user, stream, &list_state->json_state);
+        /* Init listing stream state */
+        guac_common_listing_stream_init(&list_state->listing, user, stream,
+                filesystem->listing_cache, listing);
 
         /* Associate new stream with get request */
         guac_protocol_send_body(user->socket, object, stream,
@@ -687,6 +712,9 @@ static int guac_common_ssh_sftp_put_handler(guac_user* user,
             LIBSSH2_FXF_WRITE | LIBSSH2_FXF_CREAT | LIBSSH2_FXF_TRUNC,
             S_IRUSR | S_IWUSR);
 
+    /* Cached listings may no longer reflect the directory contents */
+    guac_common_listing_cache_invalidate(filesystem->listing_cache);
+
     /* Acknowledge stream if successful */
     if (file != NULL) {
         guac_user_log(user, GUAC_LOG_DEBUG, "File \"%s\" opened", name);
@@ -764,6 +792,9 @@ guac_common_ssh_sftp_filesystem* guac_common_ssh_create_sftp_filesystem(
     /* Initially upload files to current directory */
     strcpy(filesystem->upload_path, ".");
 
+    /* No directories have been listed yet */
+    filesystem->listing_cache = guac_common_listing_cache_alloc();
+
     /* Return allocated filesystem */
     return filesystem;
 
@@ -776,6 +807,7 @@ void guac_common_ssh_destroy_sftp_filesystem(
     libssh2_sftp_shutdown(filesystem->sftp_session);
 
     /* Free associated memory */
+    guac_common_listing_cache_free(filesystem->listing_cache);
     free(filesystem->name);
     free(filesystem);
 
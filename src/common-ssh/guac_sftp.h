@@ -21,6 +21,7 @@
 #define GUAC_COMMON_SSH_SFTP_H
 
 #include "guac_json.h"
+#include "guac_listing.h"
 #include "guac_ssh.h"
 
 #include <guacamole/object.h>
@@ -60,6 +61,12 @@ typedef struct guac_common_ssh_sftp_filesystem {
      */
     char upload_path[GUAC_COMMON_SSH_SFTP_MAX_PATH];
 
+    /**
+     * Recently-read directory listings. This cache is invalidated whenever a
+     * file is written through this filesystem.
+     */
+    guac_common_listing_cache* listing_cache;
+
 } guac_common_ssh_sftp_filesystem;
 
 /**
@@ -73,20 +80,9 @@ typedef struct guac_common_ssh_sftp_ls_state {
     guac_common_ssh_sftp_filesystem* filesystem;
 
     /**
-     * Reference to the directory currently being listed over SFTP. This
-     * directory must already be open from a call to libssh2_sftp_opendir().
-     */
-    LIBSSH2_SFTP_HANDLE* directory;
-
-    /**
-     * The absolute path of the directory being listed.
-     */
-    char directory_name[GUAC_COMMON_SSH_SFTP_MAX_PATH];
-
-    /**
-     * The current state of the JSON directory object being written.
+     * The state of the directory listing being streamed.
      */
-    guac_common_json_state json_state;
+    guac_common_listing_stream listing;
 
 } guac_common_ssh_sftp_ls_state;
 
@@ -22,8 +22,9 @@
 
 #include <guacamole/client.h>
 #include <guacamole/protocol.h>
+#include <guacamole/socket.h>
 #include <guacamole/stream.h>
-#include <guacamole/user.h>
+#include <pthread.h>
 #include <string.h>
 #include <stdlib.h>
 
@@ -36,86 +37,283 @@ guac_common_clipboard* guac_common_clipboard_alloc(int size) {
     clipboard->buffer = malloc(size);
     clipboard->length = 0;
     clipboard->available = size;
+    clipboard->contents_sent = 0;
+    clipboard->contents_sent_before_reset = 0;
+
+    /* Init send state (send thread is started upon first send) */
+    pthread_mutex_init(&(clipboard->send_lock), NULL);
+    pthread_cond_init(&(clipboard->send_modified), NULL);
+    clipboard->send_thread_started = 0;
+    clipboard->send_stopping = 0;
+    clipboard->send_client = NULL;
+    clipboard->send_mimetype[0] = '\0';
+    clipboard->send_buffer = malloc(size);
+    clipboard->sending_buffer = malloc(size);
+    clipboard->send_length = 0;
+    clipboard->send_hash = 0;
+    clipboard->send_generation = 0;
+    clipboard->sent_generation = 0;
 
     return clipboard;
 
 }
 
 void guac_common_clipboard_free(guac_common_clipboard* clipboard) {
+
+    /* Stop send thread, if running */
+    pthread_mutex_lock(&(clipboard->send_lock));
+    clipboard->send_stopping = 1;
+    pthread_cond_signal(&(clipboard->send_modified));
+    pthread_mutex_unlock(&(clipboard->send_lock));
+
+    if (clipboard->send_thread_started)
+        pthread_join(clipboard->send_thread, NULL);
+
+    pthread_cond_destroy(&(clipboard->send_modified));
+    pthread_mutex_destroy(&(clipboard->send_lock));
+
+    free(clipboard->sending_buffer);
+    free(clipboard->send_buffer);
     free(clipboard->buffer);
     free(clipboard);
+
 }
 
 /**
- * Callback for guac_client_foreach_user() which sends clipboard data to each
- * connected client.
+ * Returns a 32-bit FNV-1a hash of the given mimetype and clipboard contents.
  *
- * @param user
- *     The user to send the clipboard data to.
+ * @param mimetype
+ *     The mimetype of the clipboard contents.
  *
- * @param
- *     A pointer to the guac_common_clipboard structure containing the
- *     clipboard data that should be sent to the given user.
+ * @param data
+ *     The clipboard contents.
+ *
+ * @param length
+ *     The number of bytes of clipboard contents.
  *
  * @return
- *     Always NULL.
+ *     A hash of the given mimetype and contents.
  */
-static void* __send_user_clipboard(guac_user* user, void* data) {
+static unsigned int __guac_common_clipboard_hash(const char* mimetype,
+        const char* data, int length) {
 
-    guac_common_clipboard* clipboard = (guac_common_clipboard*) data;
+    unsigned int hash = 2166136261U;
+
+    /* Hash mimetype, including null terminator */
+    do {
+        hash ^= (unsigned char) *mimetype;
+        hash *= 16777619U;
+    } while (*(mimetype++) != '\0');
+
+    /* Hash contents */
+    while (length-- > 0) {
+        hash ^= (unsigned char) *(data++);
+        hash *= 16777619U;
+    }
+
+    return hash;
+
+}
 
-    char* current = clipboard->buffer;
-    int remaining = clipboard->length;
+/**
+ * Sends the given clipboard contents to all users over the broadcast socket
+ * of the client, one block at a time. The contents are always sent in their
+ * entirety: there is no means of aborting a stream sent to the client other
+ * than ending it, and ending a stream early would cause users to receive
+ * truncated clipboard contents. Newer contents queued while sending are sent
+ * once this stream is complete.
+ *
+ * @param clipboard
+ *     The clipboard whose contents are being sent.
+ *
+ * @param mimetype
+ *     The mimetype of the contents being sent.
+ *
+ * @param data
+ *     The contents to send. This must be the clipboard's sending_buffer,
+ *     which is not modified by other threads while sending.
+ *
+ * @param length
+ *     The total number of bytes being sent.
+ */
+static void __guac_common_clipboard_send_queued(
+        guac_common_clipboard* clipboard, const char* mimetype,
+        const char* data, int length) {
+
+    guac_client* client = clipboard->send_client;
+    guac_socket* socket = client->socket;
+    int offset = 0;
 
     /* Begin stream */
-    guac_stream* stream = guac_user_alloc_stream(user);
-    guac_protocol_send_clipboard(user->socket, stream, clipboard->mimetype);
+    guac_stream* stream = guac_client_alloc_stream(client);
+    if (stream == NULL) {
+        guac_client_log(client, GUAC_LOG_WARNING, "Unable to allocate stream "
+                "for clipboard data.");
+        return;
+    }
 
-    guac_user_log(user, GUAC_LOG_DEBUG,
+    guac_protocol_send_clipboard(socket, stream, mimetype);
+    guac_socket_flush(socket);
+
+    guac_client_log(client, GUAC_LOG_DEBUG,
             "Created stream %i for %s clipboard data.",
-            stream->index, clipboard->mimetype);
+            stream->index, mimetype);
 
     /* Split clipboard into chunks */
-    while (remaining > 0) {
+    while (offset < length) {
 
         /* Calculate size of next block */
         int block_size = GUAC_COMMON_CLIPBOARD_BLOCK_SIZE;
-        if (remaining < block_size)
-            block_size = remaining; 
+        if (length - offset < block_size)
+            block_size = length - offset;
+
+        /* Stop without ending stream if the clipboard is being freed (no
+         * users remain to receive the stream) */
+        pthread_mutex_lock(&(clipboard->send_lock));
+        if (clipboard->send_stopping) {
+            pthread_mutex_unlock(&(clipboard->send_lock));
+            guac_client_free_stream(client, stream);
+            return;
+        }
+        pthread_mutex_unlock(&(clipboard->send_lock));
 
-        /* Send block */
-        guac_protocol_send_blob(user->socket, stream, current, block_size);
-        guac_user_log(user, GUAC_LOG_DEBUG,
-                "Sent %i bytes of clipboard data on stream %i.",
-                block_size, stream->index);
+        /* Send block, flushing such that other output may be interleaved */
+        guac_protocol_send_blob(socket, stream, data + offset, block_size);
+        guac_socket_flush(socket);
 
         /* Next block */
-        remaining -= block_size;
-        current += block_size;
+        offset += block_size;
 
     }
 
-    guac_user_log(user, GUAC_LOG_DEBUG,
+    guac_client_log(client, GUAC_LOG_DEBUG,
             "Clipboard stream %i complete.",
             stream->index);
 
     /* End stream */
-    guac_protocol_send_end(user->socket, stream);
-    guac_user_free_stream(user, stream);
+    guac_protocol_send_end(socket, stream);
+    guac_socket_flush(socket);
+    guac_client_free_stream(client, stream);
+
+}
+
+/**
+ * Thread which sends clipboard contents queued via
+ * guac_common_clipboard_send(), running until the clipboard is freed. Only
+ * the most recently queued contents are sent; contents replaced before their
+ * send begins are skipped.
+ *
+ * @param data
+ *     The guac_common_clipboard whose queued contents should be sent.
+ *
+ * @return
+ *     Always NULL.
+ */
+static void* __guac_common_clipboard_send_thread(void* data) {
+
+    guac_common_clipboard* clipboard = (guac_common_clipboard*) data;
+
+    char mimetype[sizeof(clipboard->send_mimetype)];
+    char* contents;
+    int length;
+
+    pthread_mutex_lock(&(clipboard->send_lock));
+
+    while (!clipboard->send_stopping) {
+
+        /* Wait for new contents */
+        if (clipboard->sent_generation == clipboard->send_generation) {
+            pthread_cond_wait(&(clipboard->send_modified),
+                    &(clipboard->send_lock));
+            continue;
+        }
+
+        /* Take the queued contents, leaving send_buffer free to receive
+         * newer contents */
+        contents = clipboard->send_buffer;
+        clipboard->send_buffer = clipboard->sending_buffer;
+        clipboard->sending_buffer = contents;
+
+        clipboard->sent_generation = clipboard->send_generation;
+        length = clipboard->send_length;
+        strcpy(mimetype, clipboard->send_mimetype);
+
+        /* Send without holding lock, such that new contents may be queued */
+        pthread_mutex_unlock(&(clipboard->send_lock));
+        __guac_common_clipboard_send_queued(clipboard, mimetype,
+                contents, length);
+        pthread_mutex_lock(&(clipboard->send_lock));
+
+    }
+
+    pthread_mutex_unlock(&(clipboard->send_lock));
 
     return NULL;
 
 }
 
 void guac_common_clipboard_send(guac_common_clipboard* clipboard, guac_client* client) {
-    guac_client_log(client, GUAC_LOG_DEBUG, "Broadcasting clipboard to all connected users.");
-    guac_client_foreach_user(client, __send_user_clipboard, clipboard);
-    guac_client_log(client, GUAC_LOG_DEBUG, "Broadcast of clipboard complete.");
+
+    const char* queued;
+
+    unsigned int hash = __guac_common_clipboard_hash(clipboard->mimetype,
+            clipboard->buffer, clipboard->length);
+
+    pthread_mutex_lock(&(clipboard->send_lock));
+
+    /* Locate most recently queued contents, which may already have been
+     * taken by the send thread */
+    if (clipboard->sent_generation == clipboard->send_generation)
+        queued = clipboard->sending_buffer;
+    else
+        queued = clipboard->send_buffer;
+
+    /* Do not resend contents which have not changed */
+    if (clipboard->contents_sent_before_reset
+            && hash == clipboard->send_hash
+            && clipboard->length == clipboard->send_length
+            && strcmp(clipboard->mimetype, clipboard->send_mimetype) == 0
+            && memcmp(clipboard->buffer, queued, clipboard->length) == 0) {
+        pthread_mutex_unlock(&(clipboard->send_lock));
+        clipboard->contents_sent = 1;
+        guac_client_log(client, GUAC_LOG_DEBUG, "Clipboard unchanged. "
+                "Skipping broadcast.");
+        return;
+    }
+
+    /* Queue copy of current contents */
+    memcpy(clipboard->send_buffer, clipboard->buffer, clipboard->length);
+    strcpy(clipboard->send_mimetype, clipboard->mimetype);
+    clipboard->send_length = clipboard->length;
+    clipboard->send_hash = hash;
+    clipboard->send_client = client;
+    clipboard->send_generation++;
+
+    /* Start send thread if not yet running */
+    if (!clipboard->send_thread_started) {
+        if (pthread_create(&(clipboard->send_thread), NULL,
+                    __guac_common_clipboard_send_thread, clipboard))
+            guac_client_log(client, GUAC_LOG_ERROR, "Unable to start "
+                    "clipboard thread. Clipboard will not be sent.");
+        else
+            clipboard->send_thread_started = 1;
+    }
+
+    pthread_cond_signal(&(clipboard->send_modified));
+    pthread_mutex_unlock(&(clipboard->send_lock));
+
+    clipboard->contents_sent = 1;
+    guac_client_log(client, GUAC_LOG_DEBUG, "Queued clipboard for broadcast "
+            "to all connected users.");
+
 }
 
 void guac_common_clipboard_reset(guac_common_clipboard* clipboard, const char* mimetype) {
+    clipboard->contents_sent_before_reset = clipboard->contents_sent;
+    clipboard->contents_sent = 0;
     clipboard->length = 0;
     strncpy(clipboard->mimetype, mimetype, sizeof(clipboard->mimetype)-1);
+    clipboard->mimetype[sizeof(clipboard->mimetype)-1] = '\0';
 }
 
 void guac_common_clipboard_append(guac_common_clipboard* clipboard, const char* data, int length) {
@@ -132,4 +330,3 @@ void guac_common_clipboard_append(guac_common_clipboard* clipboard, const char*
     clipboard->length += length;
 
 }
-
@@ -24,6 +24,8 @@
 
 #include <guacamole/client.h>
 
+#include <pthread.h>
+
 /**
  * The maximum number of bytes to send in an individual blob when
  * transmitting the clipboard contents to a connected client.
@@ -55,6 +57,98 @@ typedef struct guac_common_clipboard {
      */
     int available;
 
+    /**
+     * Non-zero if the current contents of the clipboard are those most
+     * recently queued for sending, zero if the clipboard has since been
+     * reset.
+     */
+    int contents_sent;
+
+    /**
+     * The value of contents_sent immediately prior to the most recent call to
+     * guac_common_clipboard_reset(). Contents are only considered unchanged
+     * (and thus not resent) if the clipboard held the most recently sent
+     * contents prior to being reset, such that contents received from a user
+     * in the meantime are always overwritten.
+     */
+    int contents_sent_before_reset;
+
+    /**
+     * Lock which guards the pending send state of this clipboard, including
+     * send_buffer, and which is signalled via send_modified.
+     */
+    pthread_mutex_t send_lock;
+
+    /**
+     * Condition which is signalled whenever new clipboard contents are
+     * queued for sending, or the clipboard is being freed.
+     */
+    pthread_cond_t send_modified;
+
+    /**
+     * The thread which sends queued clipboard contents to all users.
+     */
+    pthread_t send_thread;
+
+    /**
+     * Non-zero if send_thread has been started, zero otherwise.
+     */
+    int send_thread_started;
+
+    /**
+     * Non-zero if the clipboard is being freed and send_thread must stop.
+     */
+    int send_stopping;
+
+    /**
+     * The client whose users should receive sent clipboard contents.
+     */
+    guac_client* send_client;
+
+    /**
+     * The mimetype of the most recently queued clipboard contents.
+     */
+    char send_mimetype[256];
+
+    /**
+     * Copy of the most recently queued clipboard contents, if those contents
+     * have not yet been taken by send_thread. This copy is distinct from
+     * buffer, such that the clipboard may be modified while its previous
+     * contents are still being sent.
+     */
+    char* send_buffer;
+
+    /**
+     * The clipboard contents most recently taken by send_thread, which may
+     * still be in the process of being sent. When send_thread takes newly
+     * queued contents, this buffer is swapped with send_buffer while
+     * send_lock is held, rather than copied.
+     */
+    char* sending_buffer;
+
+    /**
+     * The number of bytes of clipboard contents most recently queued.
+     */
+    int send_length;
+
+    /**
+     * Hash of the mimetype and contents most recently queued, used to avoid
+     * resending unchanged contents.
+     */
+    unsigned int send_hash;
+
+    /**
+     * Incremented each time new contents are queued for sending.
+     */
+    int send_generation;
+
+    /**
+     * The value of send_generation as of the contents most recently taken by
+     * send_thread. If equal to send_generation, the most recently queued
+     * contents are within sending_buffer rather than send_buffer.
+     */
+    int sent_generation;
+
 } guac_common_clipboard;
 
 /**
@@ -74,7 +168,14 @@ void guac_common_clipboard_free(guac_common_clipboard* clipboard);
 
 /**
  * Sends the contents of the clipboard along the given client, splitting
- * the contents as necessary.
+ * the contents as necessary. The contents are copied and queued, and are sent
+ * to all users by a dedicated thread over the broadcast socket of the client,
+ * such that the contents are encoded only once and this function does not
+ * block. A send which has begun always completes, such that users never
+ * receive truncated contents, but if contents are queued several times
+ * before a previous send completes, only the most recent contents are sent
+ * next. Contents identical to those most recently queued are not sent
+ * again.
  *
  * @param clipboard The clipboard whose contents should be sent.
  * @param client The client to send the clipboard contents on.
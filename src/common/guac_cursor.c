@@ -29,8 +29,10 @@
 #include <guacamole/layer.h>
 #include <guacamole/protocol.h>
 #include <guacamole/socket.h>
+#include <guacamole/timestamp.h>
 #include <guacamole/user.h>
 
+#include <pthread.h>
 #include <stdlib.h>
 #include <string.h>
 
@@ -61,6 +63,14 @@ guac_common_cursor* guac_common_cursor_alloc(guac_client* client) {
     /* Start cursor in upper-left */
     cursor->x = 0;
     cursor->y = 0;
+    cursor->moved = 0;
+
+    /* No cursor images cached yet */
+    memset(cursor->cache, 0, sizeof(cursor->cache));
+    cursor->cache_clock = 0;
+    cursor->current = NULL;
+
+    pthread_mutex_init(&(cursor->_lock), NULL);
 
     return cursor;
 
@@ -71,12 +81,28 @@ void guac_common_cursor_free(guac_common_cursor* cursor) {
     guac_client* client = cursor->client;
     guac_layer* layer = cursor->layer;
     cairo_surface_t* surface = cursor->surface;
+    int i;
 
     /* Free image buffer and surface */
     free(cursor->image_buffer);
     if (surface != NULL)
         cairo_surface_destroy(surface);
 
+    /* Free all cached cursor images */
+    for (i = 0; i < GUAC_COMMON_CURSOR_CACHE_SIZE; i++) {
+
+        guac_common_cursor_cache_entry* entry = &(cursor->cache[i]);
+        if (entry->buffer == NULL)
+            continue;
+
+        guac_protocol_send_dispose(client->socket, entry->buffer);
+        guac_client_free_buffer(client, entry->buffer);
+        free(entry->image);
+
+    }
+
+    pthread_mutex_destroy(&(cursor->_lock));
+
     /* Destroy layer within remotely-connected client */
     guac_protocol_send_dispose(client->socket, layer);
 
@@ -87,9 +113,52 @@ void guac_common_cursor_free(guac_common_cursor* cursor) {
 
 }
 
+/**
+ * Sends the given cached cursor image to a single user, such that the buffer
+ * associated with the cache entry contains the cursor image.
+ *
+ * @param entry
+ *     The cache entry containing the cursor image to send.
+ *
+ * @param user
+ *     The user to send the cursor image to.
+ *
+ * @param socket
+ *     The socket over which the cursor image should be sent.
+ */
+static void guac_common_cursor_send_entry(
+        guac_common_cursor_cache_entry* entry, guac_user* user,
+        guac_socket* socket) {
+
+    cairo_surface_t* surface = cairo_image_surface_create_for_data(
+            entry->image, CAIRO_FORMAT_ARGB32, entry->width, entry->height,
+            entry->width * 4);
+
+    guac_protocol_send_size(socket, entry->buffer,
+            entry->width, entry->height);
+
+    guac_user_stream_png(user, socket, GUAC_COMP_SRC,
+            entry->buffer, 0, 0, surface);
+
+    cairo_surface_destroy(surface);
+
+}
+
 void guac_common_cursor_dup(guac_common_cursor* cursor, guac_user* user,
         guac_socket* socket) {
 
+    int i;
+
+    /* Cached images and cursor state must not change while being read */
+    pthread_mutex_lock(&(cursor->_lock));
+
+    /* Synchronize cached cursor images */
+    for (i = 0; i < GUAC_COMMON_CURSOR_CACHE_SIZE; i++) {
+        guac_common_cursor_cache_entry* entry = &(cursor->cache[i]);
+        if (entry->buffer != NULL)
+            guac_common_cursor_send_entry(entry, user, socket);
+    }
+
     /* Synchronize location */
     guac_protocol_send_move(socket, cursor->layer, GUAC_DEFAULT_LAYER,
             cursor->x - cursor->hotspot_x,
@@ -97,14 +166,17 @@ void guac_common_cursor_dup(guac_common_cursor* cursor, guac_user* user,
             0);
 
     /* Synchronize cursor image */
-    if (cursor->surface != NULL) {
+    if (cursor->current != NULL) {
         guac_protocol_send_size(socket, cursor->layer,
                 cursor->width, cursor->height);
 
-        guac_user_stream_png(user, socket, GUAC_COMP_SRC,
-                cursor->layer, 0, 0, cursor->surface);
+        guac_protocol_send_copy(socket, cursor->current->buffer,
+                0, 0, cursor->width, cursor->height,
+                GUAC_COMP_SRC, cursor->layer, 0, 0);
     }
 
+    pthread_mutex_unlock(&(cursor->_lock));
+
     guac_socket_flush(socket);
 
 }
@@ -113,7 +185,9 @@ void guac_common_cursor_dup(guac_common_cursor* cursor, guac_user* user,
  * Callback for guac_client_for_user() which shows the cursor layer for the
  * given user (if they exist). The cursor layer is normally hidden when a user
  * is moving the mouse, and will only be shown if a DIFFERENT user is moving
- * the mouse.
+ * the mouse. As a user moving the mouse does not receive updates to the
+ * location of the cursor layer, the location of the cursor layer is also
+ * updated.
  *
  * @param user
  *     The user to show the cursor to, or NULL if that user does not exist.
@@ -131,14 +205,100 @@ static void* guac_common_cursor_show(guac_user* user, void* data) {
 
     /* Make cursor layer visible to given user */
     if (user != NULL) {
+        guac_protocol_send_move(user->socket, cursor->layer,
+                GUAC_DEFAULT_LAYER,
+                cursor->x - cursor->hotspot_x,
+                cursor->y - cursor->hotspot_y,
+                0);
         guac_protocol_send_shade(user->socket, cursor->layer, 255);
-        guac_socket_flush(user->socket);
     }
 
     return NULL;
 
 }
 
+/**
+ * The location of a mouse cursor, as sent to all users other than the user
+ * moving that cursor.
+ */
+typedef struct guac_common_cursor_location {
+
+    /**
+     * The cursor whose location is being sent.
+     */
+    guac_common_cursor* cursor;
+
+    /**
+     * The user moving the cursor, who should not receive the location.
+     */
+    guac_user* user;
+
+    /**
+     * The X coordinate of the upper-left corner of the cursor layer.
+     */
+    int x;
+
+    /**
+     * The Y coordinate of the upper-left corner of the cursor layer.
+     */
+    int y;
+
+} guac_common_cursor_location;
+
+/**
+ * Callback for guac_client_foreach_user() which sends the location of the
+ * cursor layer to the given user, unless that user is the user moving the
+ * cursor (and thus rendering the cursor locally).
+ *
+ * @param user
+ *     The user to send the cursor location to.
+ *
+ * @param data
+ *     A pointer to the guac_common_cursor_location structure describing the
+ *     location to send.
+ *
+ * @return
+ *     Always NULL.
+ */
+static void* guac_common_cursor_send_location(guac_user* user, void* data) {
+
+    guac_common_cursor_location* location =
+        (guac_common_cursor_location*) data;
+
+    /* Do not echo location to the user moving the mouse */
+    if (user != location->user)
+        guac_protocol_send_move(user->socket, location->cursor->layer,
+                GUAC_DEFAULT_LAYER, location->x, location->y, 0);
+
+    return NULL;
+
+}
+
+void guac_common_cursor_flush(guac_common_cursor* cursor) {
+
+    guac_common_cursor_location location = { .cursor = cursor };
+
+    /* Snapshot most recent location, if changed */
+    pthread_mutex_lock(&(cursor->_lock));
+
+    if (!cursor->moved) {
+        pthread_mutex_unlock(&(cursor->_lock));
+        return;
+    }
+
+    location.user = cursor->user;
+    location.x = cursor->x - cursor->hotspot_x;
+    location.y = cursor->y - cursor->hotspot_y;
+    cursor->moved = 0;
+
+    pthread_mutex_unlock(&(cursor->_lock));
+
+    /* Send location to all other users */
+    guac_client_foreach_user(cursor->client,
+            guac_common_cursor_send_location, &location);
+
+}
+
 void guac_common_cursor_move(guac_common_cursor* cursor, guac_user* user,
         int x, int y) {
 
@@ -160,21 +320,23 @@ void guac_common_cursor_move(guac_common_cursor* cursor, guac_user* user,
 
         /* Hide cursor layer from new user */
         guac_protocol_send_shade(user->socket, cursor->layer, 0);
-        guac_socket_flush(user->socket);
 
     }
 
     /* Update cursor position */
+    pthread_mutex_lock(&(cursor->_lock));
     cursor->x = x;
     cursor->y = y;
-
-    guac_protocol_send_move(cursor->client->socket, cursor->layer,
-            GUAC_DEFAULT_LAYER,
-            x - cursor->hotspot_x,
-            y - cursor->hotspot_y,
-            0);
-
-    guac_socket_flush(cursor->client->socket);
+    cursor->moved = 1;
+    pthread_mutex_unlock(&(cursor->_lock));
+
+    /* Location will be sent with the next frame, unless frames are not
+     * currently being sent */
+    if (guac_timestamp_current() - cursor->client->last_sent_timestamp
+            > GUAC_COMMON_CURSOR_FRAME_INTERVAL) {
+        guac_common_cursor_flush(cursor);
+        guac_socket_flush(cursor->client->socket);
+    }
 
 }
 
@@ -217,14 +379,119 @@ static void guac_common_cursor_resize(guac_common_cursor* cursor,
 }
 
 /**
- * Callback for guac_client_foreach_user() which sends the current cursor image
- * as PNG data to each connected client.
+ * Returns a 32-bit FNV-1a hash of the dimensions and contents of the given
+ * cursor image. Any padding at the end of each row is ignored.
+ *
+ * @param data
+ *     The raw 32-bit ARGB image data to hash.
+ *
+ * @param width
+ *     The width of the given image data, in pixels.
+ *
+ * @param height
+ *     The height of the given image data, in pixels.
+ *
+ * @param stride
+ *     The number of bytes in a single row of image data.
+ *
+ * @return
+ *     A hash of the given image.
+ */
+static unsigned int __guac_common_cursor_hash(unsigned const char* data,
+        int width, int height, int stride) {
+
+    unsigned int hash = 2166136261U;
+    int x, y;
+
+    /* Hash dimensions */
+    hash = (hash ^ (unsigned int) width)  * 16777619U;
+    hash = (hash ^ (unsigned int) height) * 16777619U;
+
+    /* Hash contents, row by row */
+    for (y = 0; y < height; y++) {
+
+        unsigned const char* current = data;
+        for (x = 0; x < width * 4; x++) {
+            hash ^= *(current++);
+            hash *= 16777619U;
+        }
+
+        data += stride;
+
+    }
+
+    return hash;
+
+}
+
+/**
+ * Returns the cache entry containing a cursor image identical to the given
+ * image, or NULL if no such image is cached.
+ *
+ * @param cursor
+ *     The cursor whose cache should be searched.
+ *
+ * @param hash
+ *     The hash of the given image, as returned by
+ *     __guac_common_cursor_hash().
+ *
+ * @param data
+ *     The raw 32-bit ARGB image data to search for.
+ *
+ * @param width
+ *     The width of the given image data, in pixels.
+ *
+ * @param height
+ *     The height of the given image data, in pixels.
+ *
+ * @param stride
+ *     The number of bytes in a single row of image data.
+ *
+ * @return
+ *     The cache entry containing an identical image, or NULL if no such
+ *     entry exists.
+ */
+static guac_common_cursor_cache_entry* __guac_common_cursor_cache_find(
+        guac_common_cursor* cursor, unsigned int hash,
+        unsigned const char* data, int width, int height, int stride) {
+
+    int i, y;
+
+    for (i = 0; i < GUAC_COMMON_CURSOR_CACHE_SIZE; i++) {
+
+        guac_common_cursor_cache_entry* entry = &(cursor->cache[i]);
+
+        /* Skip unused entries and entries which obviously differ */
+        if (entry->buffer == NULL || entry->hash != hash
+                || entry->width != width || entry->height != height)
+            continue;
+
+        /* Verify contents, as hashes may collide */
+        for (y = 0; y < height; y++) {
+            if (memcmp(entry->image + y * width * 4, data + y * stride,
+                        width * 4) != 0)
+                break;
+        }
+
+        if (y == height)
+            return entry;
+
+    }
+
+    /* No such image */
+    return NULL;
+
+}
+
+/**
+ * Callback for guac_client_foreach_user() which sends a newly-cached cursor
+ * image as PNG data to each connected client.
  *
  * @param user
  *     The user to send the cursor image to.
  *
  * @param data
- *     A pointer to the guac_common_cursor structure containing the cursor
+ *     A pointer to the guac_common_cursor_cache_entry containing the cursor
  *     image that should be sent to the given user.
  *
  * @return
@@ -232,15 +499,83 @@ static void guac_common_cursor_resize(guac_common_cursor* cursor,
  */
 static void* __send_user_cursor_image(guac_user* user, void* data) {
 
-    guac_common_cursor* cursor = (guac_common_cursor*) data;
+    guac_common_cursor_cache_entry* entry =
+        (guac_common_cursor_cache_entry*) data;
 
-    guac_user_stream_png(user, user->socket, GUAC_COMP_SRC,
-            cursor->layer, 0, 0, cursor->surface);
+    guac_common_cursor_send_entry(entry, user, user->socket);
 
     return NULL;
 
 }
 
+/**
+ * Stores a copy of the given cursor image within the cache, replacing the
+ * least-recently used entry if the cache is full. The image is not sent to
+ * any user. The _lock of the given cursor MUST be held.
+ *
+ * @param cursor
+ *     The cursor whose cache should receive the given image.
+ *
+ * @param hash
+ *     The hash of the given image, as returned by
+ *     __guac_common_cursor_hash().
+ *
+ * @param data
+ *     The raw 32-bit ARGB image data to cache.
+ *
+ * @param width
+ *     The width of the given image data, in pixels.
+ *
+ * @param height
+ *     The height of the given image data, in pixels.
+ *
+ * @param stride
+ *     The number of bytes in a single row of image data.
+ *
+ * @return
+ *     The cache entry now containing the given image.
+ */
+static guac_common_cursor_cache_entry* __guac_common_cursor_cache_add(
+        guac_common_cursor* cursor, unsigned int hash,
+        unsigned const char* data, int width, int height, int stride) {
+
+    guac_common_cursor_cache_entry* entry = &(cursor->cache[0]);
+    int i, y;
+
+    /* Use first unused entry, or the least-recently used entry otherwise */
+    for (i = 0; i < GUAC_COMMON_CURSOR_CACHE_SIZE; i++) {
+
+        guac_common_cursor_cache_entry* candidate = &(cursor->cache[i]);
+
+        if (candidate->buffer == NULL) {
+            entry = candidate;
+            break;
+        }
+
+        if (candidate->last_used < entry->last_used)
+            entry = candidate;
+
+    }
+
+    /* Allocate buffer if entry is new, reusing the old buffer otherwise */
+    if (entry->buffer == NULL)
+        entry->buffer = guac_client_alloc_buffer(cursor->client);
+    else
+        free(entry->image);
+
+    /* Store tightly-packed copy of image */
+    entry->image = malloc(width * height * 4);
+    for (y = 0; y < height; y++)
+        memcpy(entry->image + y * width * 4, data + y * stride, width * 4);
+
+    entry->hash = hash;
+    entry->width = width;
+    entry->height = height;
+
+    return entry;
+
+}
+
 /**
  * Callback for guac_client_for_user() which updates the hardware cursor and
  * hotspot for the given user (if they exist). The hardware cursor image is
@@ -262,11 +597,12 @@ static void* guac_common_cursor_update(guac_user* user, void* data) {
 
     guac_common_cursor* cursor = (guac_common_cursor*) data;
 
-    /* Update hardware cursor of current user */
+    /* Update hardware cursor of current user from cached image */
     if (user != NULL) {
         guac_protocol_send_cursor(user->socket,
                 cursor->hotspot_x, cursor->hotspot_y,
-                cursor->layer, 0, 0, cursor->width, cursor->height);
+                cursor->current->buffer, 0, 0,
+                cursor->width, cursor->height);
 
         guac_socket_flush(user->socket);
     }
@@ -278,6 +614,33 @@ static void* guac_common_cursor_update(guac_user* user, void* data) {
 void guac_common_cursor_set_argb(guac_common_cursor* cursor, int hx, int hy,
     unsigned const char* data, int width, int height, int stride) {
 
+    int added = 0;
+    unsigned int hash = __guac_common_cursor_hash(data, width, height, stride);
+
+    /* Cached images and cursor state may be read by a joining user */
+    pthread_mutex_lock(&(cursor->_lock));
+
+    /* Reuse cached copy of image if possible, sending image only if new */
+    guac_common_cursor_cache_entry* entry = __guac_common_cursor_cache_find(
+            cursor, hash, data, width, height, stride);
+
+    if (entry == NULL) {
+        entry = __guac_common_cursor_cache_add(cursor, hash,
+                data, width, height, stride);
+        added = 1;
+    }
+
+    /* Nothing further to send if the cursor is not actually changing */
+    else if (entry == cursor->current
+            && hx == cursor->hotspot_x && hy == cursor->hotspot_y) {
+        entry->last_used = ++cursor->cache_clock;
+        pthread_mutex_unlock(&(cursor->_lock));
+        return;
+    }
+
+    entry->last_used = ++cursor->cache_clock;
+    cursor->current = entry;
+
     /* Copy image data */
     guac_common_cursor_resize(cursor, width, height, stride);
     memcpy(cursor->image_buffer, data, height * stride);
@@ -294,6 +657,14 @@ void guac_common_cursor_set_argb(guac_common_cursor* cursor, int hx, int hy,
     cursor->hotspot_x = hx;
     cursor->hotspot_y = hy;
 
+    pthread_mutex_unlock(&(cursor->_lock));
+
+    /* Send newly-cached image to all users. Entries are only ever replaced
+     * by this thread, so the entry remains valid without the lock. */
+    if (added)
+        guac_client_foreach_user(cursor->client,
+                __send_user_cursor_image, entry);
+
     /* Update location based on new hotspot */
     guac_protocol_send_move(cursor->client->socket, cursor->layer,
             GUAC_DEFAULT_LAYER,
@@ -301,11 +672,12 @@ void guac_common_cursor_set_argb(guac_common_cursor* cursor, int hx, int hy,
             cursor->y - hy,
             0);
 
-    /* Broadcast new cursor image to all users */
+    /* Update cursor layer of all users from cached image */
     guac_protocol_send_size(cursor->client->socket, cursor->layer,
             width, height);
 
-    guac_client_foreach_user(cursor->client, __send_user_cursor_image, cursor);
+    guac_protocol_send_copy(cursor->client->socket, entry->buffer,
+            0, 0, width, height, GUAC_COMP_SRC, cursor->layer, 0, 0);
 
     guac_socket_flush(cursor->client->socket);
 
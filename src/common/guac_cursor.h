@@ -28,11 +28,71 @@
 #include <guacamole/socket.h>
 #include <guacamole/user.h>
 
+#include <pthread.h>
+
 /**
  * The default size of the cursor image buffer.
  */
 #define GUAC_COMMON_CURSOR_DEFAULT_SIZE 64*64*4
 
+/**
+ * The maximum number of milliseconds which may have elapsed since the end of
+ * the most recent frame for cursor motion to be deferred until the end of the
+ * next frame. If frames are not being sent at least this frequently, cursor
+ * motion is sent to other users immediately.
+ */
+#define GUAC_COMMON_CURSOR_FRAME_INTERVAL 100
+
+/**
+ * The maximum number of distinct cursor images which may be cached within
+ * buffers on the client side. Setting a cursor image which is already cached
+ * requires only a copy from the corresponding buffer, rather than resending
+ * the image.
+ */
+#define GUAC_COMMON_CURSOR_CACHE_SIZE 16
+
+/**
+ * A single cursor image which has been sent to all connected users and which
+ * is retained within an off-screen buffer for reuse.
+ */
+typedef struct guac_common_cursor_cache_entry {
+
+    /**
+     * The buffer containing the cached cursor image, or NULL if this entry
+     * is unused.
+     */
+    guac_layer* buffer;
+
+    /**
+     * A hash of the dimensions and contents of the cached cursor image.
+     */
+    unsigned int hash;
+
+    /**
+     * The cached cursor image, in CAIRO_FORMAT_ARGB32, with rows packed
+     * tightly such that the stride is exactly four times the width.
+     */
+    unsigned char* image;
+
+    /**
+     * The width of the cached cursor image, in pixels.
+     */
+    int width;
+
+    /**
+     * The height of the cached cursor image, in pixels.
+     */
+    int height;
+
+    /**
+     * The value of the cache clock of the owning cursor when this entry was
+     * last used. The least-recently used entry is replaced when the cache is
+     * full.
+     */
+    int last_used;
+
+} guac_common_cursor_cache_entry;
+
 /**
  * Cursor object which maintains and synchronizes the current mouse cursor
  * state across all users of a specific client.
@@ -103,6 +163,37 @@ typedef struct guac_common_cursor {
      */
     int y;
 
+    /**
+     * Non-zero if the cursor has moved since its location was last sent to
+     * connected users, zero otherwise.
+     */
+    int moved;
+
+    /**
+     * Lock which guards the cursor location and the moved flag, such that
+     * mouse events from multiple users may safely be combined with the
+     * location updates sent at the end of each frame.
+     */
+    pthread_mutex_t _lock;
+
+    /**
+     * All cursor images which have been sent to connected users and are
+     * stored within client-side buffers.
+     */
+    guac_common_cursor_cache_entry cache[GUAC_COMMON_CURSOR_CACHE_SIZE];
+
+    /**
+     * Counter which is incremented each time a cached cursor image is used,
+     * providing the ordering for least-recently used replacement.
+     */
+    int cache_clock;
+
+    /**
+     * The cache entry containing the current cursor image, or NULL if the
+     * mouse cursor has not yet been set.
+     */
+    guac_common_cursor_cache_entry* current;
+
 } guac_common_cursor;
 
 /**
@@ -127,8 +218,8 @@ void guac_common_cursor_free(guac_common_cursor* cursor);
 
 /**
  * Sends the current state of this cursor across the given socket, including
- * the current cursor image. The resulting cursor on the remote display will
- * be visible.
+ * the current cursor image and all other cached cursor images. The resulting
+ * cursor on the remote display will be visible.
  *
  * @param cursor
  *     The cursor to send.
@@ -145,7 +236,11 @@ void guac_common_cursor_dup(guac_common_cursor* cursor, guac_user* user,
 /**
  * Moves the mouse cursor, marking the given user as the most recent user of
  * the mouse. The remote mouse cursor will be hidden for this user and shown
- * for all others.
+ * for all others. The new location is not sent to the given user, who
+ * renders the mouse cursor locally, and is sent to all other users only when
+ * guac_common_cursor_flush() is invoked at the end of the current frame
+ * (unless frames are not currently being sent, in which case the new
+ * location is sent immediately).
  *
  * @param cursor
  *     The cursor being moved.
@@ -162,11 +257,25 @@ void guac_common_cursor_dup(guac_common_cursor* cursor, guac_user* user,
 void guac_common_cursor_move(guac_common_cursor* cursor, guac_user* user,
         int x, int y);
 
+/**
+ * Sends the current location of the mouse cursor to all users other than the
+ * user currently moving the mouse, if the cursor has moved since its location
+ * was last sent. Only the most recent location is sent, regardless of the
+ * number of intervening mouse events. This function should be invoked once
+ * per frame, prior to guac_client_end_frame(). The sockets of the affected
+ * users are not flushed.
+ *
+ * @param cursor
+ *     The cursor whose location should be sent.
+ */
+void guac_common_cursor_flush(guac_common_cursor* cursor);
+
 /**
  * Sets the cursor image to the given raw image data. This raw image data must
  * be in 32-bit ARGB format, having 8 bits per color component, where the
  * alpha component is stored in the high-order 8 bits, and blue is stored
- * in the low-order 8 bits.
+ * in the low-order 8 bits. If an identical image has been set recently, the
+ * copy already cached by each user is reused and the image is not resent.
  *
  * @param cursor
  *     The cursor to set the image of.
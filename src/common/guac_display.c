@@ -156,6 +156,7 @@ void guac_common_display_dup(guac_common_display* display, guac_user* user,
 
 void guac_common_display_flush(guac_common_display* display) {
     guac_common_surface_flush(display->default_surface);
+    guac_common_cursor_flush(display->cursor);
 }
 
 /**
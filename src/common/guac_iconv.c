@@ -22,6 +22,37 @@
 
 #include <guacamole/unicode.h>
 #include <stdint.h>
+#include <string.h>
+
+/**
+ * Mask which, when ANDed with a 64-bit word of packed bytes, is non-zero if
+ * any of those bytes has its high bit set (is not ASCII).
+ */
+#define GUAC_ICONV_BYTE_HIGH_BITS 0x8080808080808080ULL
+
+/**
+ * The least-significant bit of each byte within a 64-bit word of packed
+ * bytes, used to detect null bytes within that word.
+ */
+#define GUAC_ICONV_BYTE_LOW_BITS 0x0101010101010101ULL
+
+/**
+ * Mask which, when ANDed with a 64-bit word of packed 16-bit units, is
+ * non-zero if any of those units is outside the ASCII range.
+ */
+#define GUAC_ICONV_UNIT_NON_ASCII_BITS 0xFF80FF80FF80FF80ULL
+
+/**
+ * The most-significant bit of each 16-bit unit within a 64-bit word of packed
+ * units, used to detect null units within that word.
+ */
+#define GUAC_ICONV_UNIT_HIGH_BITS 0x8000800080008000ULL
+
+/**
+ * The least-significant bit of each 16-bit unit within a 64-bit word of
+ * packed units, used to detect null units within that word.
+ */
+#define GUAC_ICONV_UNIT_LOW_BITS 0x0001000100010001ULL
 
 /**
  * Lookup table for Unicode code points, indexed by CP-1252 codepoint.
@@ -61,15 +92,252 @@ const static int __GUAC_RDP_CP1252_CODEPOINT[32] = {
     0x0178, /* 0x9F */
 };
 
+/**
+ * Returns whether the given reader decodes each ASCII character from a single
+ * byte having that same value.
+ *
+ * @param reader
+ *     The reader to test.
+ *
+ * @return
+ *     Non-zero if ASCII characters are read as single bytes, zero otherwise.
+ */
+static int guac_iconv_reads_ascii_bytes(guac_iconv_read* reader) {
+    return reader == GUAC_READ_UTF8
+        || reader == GUAC_READ_CP1252
+        || reader == GUAC_READ_ISO8859_1;
+}
+
+/**
+ * Returns whether the given writer encodes each ASCII character as a single
+ * byte having that same value.
+ *
+ * @param writer
+ *     The writer to test.
+ *
+ * @return
+ *     Non-zero if ASCII characters are written as single bytes, zero
+ *     otherwise.
+ */
+static int guac_iconv_writes_ascii_bytes(guac_iconv_write* writer) {
+    return writer == GUAC_WRITE_UTF8
+        || writer == GUAC_WRITE_CP1252
+        || writer == GUAC_WRITE_ISO8859_1;
+}
+
+/**
+ * Returns the number of leading bytes within the given buffer which are
+ * non-null ASCII characters. Bytes are tested eight at a time while possible.
+ *
+ * @param input
+ *     The buffer to scan.
+ *
+ * @param length
+ *     The maximum number of bytes to scan.
+ *
+ * @return
+ *     The number of leading non-null ASCII bytes.
+ */
+static int guac_iconv_ascii_bytes(const unsigned char* input, int length) {
+
+    int count = 0;
+
+    /* Skip whole words which contain neither null nor non-ASCII bytes */
+    while (length - count >= (int) sizeof(uint64_t)) {
+
+        uint64_t word;
+        memcpy(&word, input + count, sizeof(word));
+
+        if ((word & GUAC_ICONV_BYTE_HIGH_BITS)
+                || ((word - GUAC_ICONV_BYTE_LOW_BITS) & ~word
+                    & GUAC_ICONV_BYTE_HIGH_BITS))
+            break;
+
+        count += sizeof(word);
+
+    }
+
+    /* Test any remaining bytes individually */
+    while (count < length && input[count] != 0 && input[count] < 0x80)
+        count++;
+
+    return count;
+
+}
+
+/**
+ * Returns the number of leading 16-bit units within the given buffer which
+ * are non-null ASCII characters. Units are tested four at a time while
+ * possible.
+ *
+ * @param input
+ *     The buffer to scan, containing 16-bit units in host byte order.
+ *
+ * @param length
+ *     The maximum number of units to scan.
+ *
+ * @return
+ *     The number of leading non-null ASCII units.
+ */
+static int guac_iconv_ascii_units(const char* input, int length) {
+
+    int count = 0;
+
+    /* Skip whole words which contain neither null nor non-ASCII units */
+    while (length - count >= (int) (sizeof(uint64_t) / sizeof(uint16_t))) {
+
+        uint64_t word;
+        memcpy(&word, input + count * sizeof(uint16_t), sizeof(word));
+
+        if ((word & GUAC_ICONV_UNIT_NON_ASCII_BITS)
+                || ((word - GUAC_ICONV_UNIT_LOW_BITS) & ~word
+                    & GUAC_ICONV_UNIT_HIGH_BITS))
+            break;
+
+        count += sizeof(word) / sizeof(uint16_t);
+
+    }
+
+    /* Test any remaining units individually */
+    for (; count < length; count++) {
+
+        uint16_t unit;
+        memcpy(&unit, input + count * sizeof(uint16_t), sizeof(unit));
+
+        if (unit == 0 || unit >= 0x80)
+            break;
+
+    }
+
+    return count;
+
+}
+
+/**
+ * Copies the run of non-null ASCII characters at the beginning of the given
+ * input directly to the given output, bypassing the per-character reader and
+ * writer. Only combinations of readers and writers which represent ASCII
+ * identically to UTF-8 or UTF-16 are handled. All other combinations, and
+ * all non-ASCII characters, are left for the per-character conversion.
+ *
+ * @param reader
+ *     The reader which would otherwise be used to read the input.
+ *
+ * @param input
+ *     Pointer to the current position within the input buffer. This will be
+ *     advanced past any characters copied.
+ *
+ * @param in_remaining
+ *     The number of bytes remaining in the input buffer.
+ *
+ * @param writer
+ *     The writer which would otherwise be used to write the output.
+ *
+ * @param output
+ *     Pointer to the current position within the output buffer. This will be
+ *     advanced past any characters written.
+ *
+ * @param out_remaining
+ *     The number of bytes remaining in the output buffer.
+ *
+ * @return
+ *     The number of characters copied, which may be zero.
+ */
+static int guac_iconv_copy_ascii(guac_iconv_read* reader, const char** input,
+        int in_remaining, guac_iconv_write* writer, char** output,
+        int out_remaining) {
+
+    int i;
+    int length;
+
+    const char* in = *input;
+    char* out = *output;
+
+    /* Single-byte ASCII to single-byte ASCII is a plain copy */
+    if (guac_iconv_reads_ascii_bytes(reader)
+            && guac_iconv_writes_ascii_bytes(writer)) {
+
+        if (out_remaining < in_remaining)
+            in_remaining = out_remaining;
+
+        length = guac_iconv_ascii_bytes((const unsigned char*) in,
+                in_remaining);
+
+        memcpy(out, in, length);
+        *input += length;
+        *output += length;
+        return length;
+
+    }
+
+    /* Single-byte ASCII to UTF-16 widens each byte */
+    if (guac_iconv_reads_ascii_bytes(reader) && writer == GUAC_WRITE_UTF16) {
+
+        if (out_remaining / 2 < in_remaining)
+            in_remaining = out_remaining / 2;
+
+        length = guac_iconv_ascii_bytes((const unsigned char*) in,
+                in_remaining);
+
+        for (i = 0; i < length; i++) {
+            uint16_t unit = (unsigned char) in[i];
+            memcpy(out + i * sizeof(unit), &unit, sizeof(unit));
+        }
+
+        *input += length;
+        *output += length * 2;
+        return length;
+
+    }
+
+    /* UTF-16 to single-byte ASCII narrows each unit */
+    if (reader == GUAC_READ_UTF16 && guac_iconv_writes_ascii_bytes(writer)) {
+
+        in_remaining /= 2;
+        if (out_remaining < in_remaining)
+            in_remaining = out_remaining;
+
+        length = guac_iconv_ascii_units(in, in_remaining);
+
+        for (i = 0; i < length; i++) {
+            uint16_t unit;
+            memcpy(&unit, in + i * sizeof(unit), sizeof(unit));
+            out[i] = (char) unit;
+        }
+
+        *input += length * 2;
+        *output += length;
+        return length;
+
+    }
+
+    /* No fast path for this combination */
+    return 0;
+
+}
+
 int guac_iconv(guac_iconv_read* reader, const char** input, int in_remaining,
                guac_iconv_write* writer, char** output, int out_remaining) {
 
     while (in_remaining > 0 && out_remaining > 0) {
 
         int value;
+        int copied;
         const char* read_start;
         char* write_start;
 
+        /* Copy any run of ASCII characters in bulk */
+        read_start = *input;
+        write_start = *output;
+        copied = guac_iconv_copy_ascii(reader, input, in_remaining,
+                writer, output, out_remaining);
+
+        if (copied > 0) {
+            in_remaining -= *input - read_start;
+            out_remaining -= *output - write_start;
+            continue;
+        }
+
         /* Read character */
         read_start = *input;
         value = reader(input, in_remaining);
@@ -21,7 +21,7 @@
 
 #include "guac_json.h"
 
-#include <assert.h>
+#include <stdint.h>
 #include <stdlib.h>
 #include <string.h>
 
@@ -30,102 +30,294 @@
 #include <guacamole/stream.h>
 #include <guacamole/user.h>
 
-void guac_common_json_flush(guac_user* user, guac_stream* stream,
-        guac_common_json_state* json_state) {
+/**
+ * The least-significant bit of each byte within a 64-bit word of packed
+ * bytes. Multiplying a byte value by this constant repeats that value across
+ * all bytes of the word.
+ */
+#define GUAC_COMMON_JSON_BYTE_LOW_BITS 0x0101010101010101ULL
 
-    /* If JSON buffer is non-empty, write contents to blob and reset */
-    if (json_state->size > 0) {
-        guac_protocol_send_blob(user->socket, stream,
-                json_state->buffer, json_state->size);
+/**
+ * The most-significant bit of each byte within a 64-bit word of packed bytes.
+ */
+#define GUAC_COMMON_JSON_BYTE_HIGH_BITS 0x8080808080808080ULL
 
-        /* Reset JSON buffer size */
-        json_state->size = 0;
+/**
+ * Returns non-zero if any byte within the given 64-bit word of packed bytes
+ * is zero.
+ *
+ * @param word
+ *     The word to test.
+ *
+ * @return
+ *     Non-zero if any byte of the given word is zero, zero otherwise.
+ */
+static uint64_t guac_common_json_has_zero(uint64_t word) {
+    return (word - GUAC_COMMON_JSON_BYTE_LOW_BITS) & ~word
+        & GUAC_COMMON_JSON_BYTE_HIGH_BITS;
+}
+
+/**
+ * Returns non-zero if any byte within the given 64-bit word of packed bytes
+ * must be escaped within a JSON string: quotes, backslashes, and control
+ * characters.
+ *
+ * @param word
+ *     The word to test.
+ *
+ * @return
+ *     Non-zero if any byte of the given word requires escaping, zero
+ *     otherwise.
+ */
+static uint64_t guac_common_json_needs_escape(uint64_t word) {
+
+    uint64_t quotes = word ^ (GUAC_COMMON_JSON_BYTE_LOW_BITS * '"');
+    uint64_t backslashes = word ^ (GUAC_COMMON_JSON_BYTE_LOW_BITS * '\\');
+
+    /* Bytes less than 0x20 (control characters) */
+    uint64_t control = (word - GUAC_COMMON_JSON_BYTE_LOW_BITS * 0x20) & ~word
+        & GUAC_COMMON_JSON_BYTE_HIGH_BITS;
+
+    return control
+        | guac_common_json_has_zero(quotes)
+        | guac_common_json_has_zero(backslashes);
+
+}
+
+/**
+ * Writes the escaped form of the given byte to the given buffer. The buffer
+ * must have at least six bytes of space.
+ *
+ * @param dest
+ *     The buffer to write to.
+ *
+ * @param c
+ *     The byte to escape.
+ *
+ * @return
+ *     The number of bytes written.
+ */
+static int guac_common_json_escape_char(char* dest, unsigned char c) {
+
+    static const char hex[] = "0123456789abcdef";
+
+    switch (c) {
+
+        case '"':
+        case '\\':
+            dest[0] = '\\';
+            dest[1] = c;
+            return 2;
+
+        case '\b': dest[0] = '\\'; dest[1] = 'b'; return 2;
+        case '\f': dest[0] = '\\'; dest[1] = 'f'; return 2;
+        case '\n': dest[0] = '\\'; dest[1] = 'n'; return 2;
+        case '\r': dest[0] = '\\'; dest[1] = 'r'; return 2;
+        case '\t': dest[0] = '\\'; dest[1] = 't'; return 2;
 
     }
 
+    /* Other control characters must be written as code points */
+    if (c < 0x20) {
+        memcpy(dest, "\\u00", 4);
+        dest[4] = hex[c >> 4];
+        dest[5] = hex[c & 0xF];
+        return 6;
+    }
+
+    /* All other characters need no escaping */
+    dest[0] = c;
+    return 1;
+
 }
 
-int guac_common_json_write(guac_user* user, guac_stream* stream,
-        guac_common_json_state* json_state, const char* buffer, int length) {
+int guac_common_json_escape(char* dest, const char* str, int length) {
+
+    char* current = dest;
 
-    int blob_written = 0;
+    /* Copy eight bytes at a time while no escaping is required */
+    while (length >= sizeof(uint64_t)) {
 
-    /*
-     * Append to and flush the JSON buffer as necessary to write the given
-     * data
-     */
-    while (length > 0) {
+        uint64_t word;
+        memcpy(&word, str, sizeof(word));
 
-        /* Ensure provided data does not exceed size of buffer */
-        int blob_length = length;
-        if (blob_length > sizeof(json_state->buffer))
-            blob_length = sizeof(json_state->buffer);
+        /* Escape individual bytes only if needed */
+        if (guac_common_json_needs_escape(word)) {
+            int i;
+            for (i = 0; i < sizeof(word); i++)
+                current += guac_common_json_escape_char(current, str[i]);
+        }
 
-        /* Flush if more room is needed */
-        if (json_state->size + blob_length > sizeof(json_state->buffer)) {
-            guac_common_json_flush(user, stream, json_state);
-            blob_written = 1;
+        else {
+            memcpy(current, &word, sizeof(word));
+            current += sizeof(word);
         }
 
-        /* Append data to JSON buffer */
-        memcpy(json_state->buffer + json_state->size,
-                buffer, blob_length);
+        str += sizeof(uint64_t);
+        length -= sizeof(uint64_t);
+
+    }
+
+    /* Escape any remaining bytes individually */
+    while (length-- > 0)
+        current += guac_common_json_escape_char(current, *(str++));
+
+    return current - dest;
 
-        json_state->size += blob_length;
+}
 
-        /* Advance to next blob of data */
-        buffer += blob_length;
-        length -= blob_length;
+/**
+ * Ensures the JSON buffer of the given state has room for at least the given
+ * number of additional bytes, growing the buffer if necessary.
+ *
+ * @param json_state
+ *     The state object containing the JSON buffer.
+ *
+ * @param length
+ *     The number of bytes which will be appended to the JSON buffer.
+ *
+ * @return
+ *     A pointer to the first unused byte of the JSON buffer.
+ */
+static char* guac_common_json_reserve(guac_common_json_state* json_state,
+        int length) {
+
+    int required = json_state->size + length;
+
+    /* Grow buffer as necessary */
+    if (required > json_state->available) {
+
+        while (json_state->available < required)
+            json_state->available *= 2;
+
+        json_state->buffer = realloc(json_state->buffer,
+                json_state->available);
 
     }
 
-    return blob_written;
+    return json_state->buffer + json_state->size;
 
 }
 
-int guac_common_json_write_string(guac_user* user,
-        guac_stream* stream, guac_common_json_state* json_state,
+/**
+ * Appends the given data to the JSON buffer without sending any blobs.
+ *
+ * @param json_state
+ *     The state object containing the JSON buffer to append to.
+ *
+ * @param buffer
+ *     The data to append.
+ *
+ * @param length
+ *     The number of bytes of data to append.
+ */
+static void guac_common_json_append(guac_common_json_state* json_state,
+        const char* buffer, int length) {
+
+    memcpy(guac_common_json_reserve(json_state, length), buffer, length);
+    json_state->size += length;
+
+}
+
+/**
+ * Appends the given string to the JSON buffer as a proper JSON string,
+ * including quotes and any necessary escaping, without sending any blobs.
+ *
+ * @param json_state
+ *     The state object containing the JSON buffer to append to.
+ *
+ * @param str
+ *     The string to append.
+ */
+static void guac_common_json_append_string(guac_common_json_state* json_state,
         const char* str) {
 
-    int blob_written = 0;
+    int length = strlen(str);
 
-    /* Write starting quote */
-    blob_written |= guac_common_json_write(user, stream,
-            json_state, "\"", 1);
+    /* Reserve space for the worst case, where each byte is escaped as a
+     * six-byte code point */
+    char* current = guac_common_json_reserve(json_state, length * 6 + 2);
 
-    /* Write given string, escaping as necessary */
-    const char* current = str;
-    for (; *current != '\0'; current++) {
+    *(current++) = '"';
+    current += guac_common_json_escape(current, str, length);
+    *(current++) = '"';
 
-        /* Escape all quotes */
-        if (*current == '"') {
+    json_state->size = current - json_state->buffer;
 
-            /* Write any string content up to current character */
-            if (current != str)
-                blob_written |= guac_common_json_write(user, stream,
-                        json_state, str, current - str);
+}
 
-            /* Escape the quote that was just read */
-            blob_written |= guac_common_json_write(user, stream,
-                    json_state, "\\", 1);
+/**
+ * Sends as many complete blobs of GUAC_COMMON_JSON_BLOB_SIZE bytes as the
+ * JSON buffer currently contains, retaining any remaining data.
+ *
+ * @param user
+ *     The user to which the blobs will be sent.
+ *
+ * @param stream
+ *     The stream through which the blobs should be sent.
+ *
+ * @param json_state
+ *     The state object whose JSON buffer should be sent.
+ *
+ * @return
+ *     The number of blobs sent.
+ */
+static int guac_common_json_send_blobs(guac_user* user, guac_stream* stream,
+        guac_common_json_state* json_state) {
 
-            /* Reset string */
-            str = current;
+    int offset = 0;
 
-        }
+    /* Send all complete blobs */
+    while (json_state->size - offset >= GUAC_COMMON_JSON_BLOB_SIZE) {
+        guac_protocol_send_blob(user->socket, stream,
+                json_state->buffer + offset, GUAC_COMMON_JSON_BLOB_SIZE);
+        offset += GUAC_COMMON_JSON_BLOB_SIZE;
+    }
 
+    /* Retain remaining data */
+    if (offset != 0) {
+        json_state->size -= offset;
+        memmove(json_state->buffer, json_state->buffer + offset,
+                json_state->size);
     }
 
-    /* Write any remaining string content */
-    if (current != str)
-        blob_written |= guac_common_json_write(user, stream,
-                json_state, str, current - str);
+    return offset / GUAC_COMMON_JSON_BLOB_SIZE;
 
-    /* Write ending quote */
-    blob_written |= guac_common_json_write(user, stream,
-            json_state, "\"", 1);
+}
 
-    return blob_written;
+int guac_common_json_flush(guac_user* user, guac_stream* stream,
+        guac_common_json_state* json_state) {
+
+    /* Send all complete blobs, followed by any remaining data */
+    int blobs = guac_common_json_send_blobs(user, stream, json_state);
+    if (json_state->size > 0) {
+        guac_protocol_send_blob(user->socket, stream,
+                json_state->buffer, json_state->size);
+
+        /* Reset JSON buffer size */
+        json_state->size = 0;
+        blobs++;
+
+    }
+
+    return blobs;
+
+}
+
+int guac_common_json_write(guac_user* user, guac_stream* stream,
+        guac_common_json_state* json_state, const char* buffer, int length) {
+
+    guac_common_json_append(json_state, buffer, length);
+    return guac_common_json_send_blobs(user, stream, json_state);
+
+}
+
+int guac_common_json_write_string(guac_user* user,
+        guac_stream* stream, guac_common_json_state* json_state,
+        const char* str) {
+
+    guac_common_json_append_string(json_state, str);
+    return guac_common_json_send_blobs(user, stream, json_state);
 
 }
 
@@ -133,28 +325,18 @@ int guac_common_json_write_property(guac_user* user, guac_stream* stream,
         guac_common_json_state* json_state, const char* name,
         const char* value) {
 
-    int blob_written = 0;
-
     /* Write leading comma if not first property */
     if (json_state->properties_written != 0)
-        blob_written |= guac_common_json_write(user, stream,
-                json_state, ",", 1);
-
-    /* Write property name */
-    blob_written |= guac_common_json_write_string(user, stream,
-            json_state, name);
+        guac_common_json_append(json_state, ",", 1);
 
-    /* Separate name from value with colon */
-    blob_written |= guac_common_json_write(user, stream,
-            json_state, ":", 1);
-
-    /* Write property value */
-    blob_written |= guac_common_json_write_string(user, stream,
-            json_state, value);
+    /* Write name and value separated by colon */
+    guac_common_json_append_string(json_state, name);
+    guac_common_json_append(json_state, ":", 1);
+    guac_common_json_append_string(json_state, value);
 
     json_state->properties_written++;
 
-    return blob_written;
+    return guac_common_json_send_blobs(user, stream, json_state);
 
 }
 
@@ -162,11 +344,13 @@ void guac_common_json_begin_object(guac_user* user, guac_stream* stream,
         guac_common_json_state* json_state) {
 
     /* Init JSON state */
+    json_state->available = GUAC_COMMON_JSON_INITIAL_SIZE;
+    json_state->buffer = malloc(json_state->available);
     json_state->size = 0;
     json_state->properties_written = 0;
 
     /* Write leading brace - no blob can possibly be written by this */
-    assert(!guac_common_json_write(user, stream, json_state, "{", 1));
+    guac_common_json_append(json_state, "{", 1);
 
 }
 
@@ -178,3 +362,8 @@ int guac_common_json_end_object(guac_user* user, guac_stream* stream,
 
 }
 
+void guac_common_json_free(guac_common_json_state* json_state) {
+    free(json_state->buffer);
+    json_state->buffer = NULL;
+}
+
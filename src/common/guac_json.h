@@ -25,6 +25,19 @@
 #include <guacamole/stream.h>
 #include <guacamole/user.h>
 
+/**
+ * The number of bytes of JSON data to send within each blob. Blobs of
+ * exactly this size are sent as soon as enough data has been written, with
+ * only the final blob of the JSON object being shorter.
+ */
+#define GUAC_COMMON_JSON_BLOB_SIZE 6048
+
+/**
+ * The number of bytes initially allocated for the JSON buffer. The buffer
+ * grows as necessary to contain any single write.
+ */
+#define GUAC_COMMON_JSON_INITIAL_SIZE 16384
+
 /**
  * The current streaming state of an arbitrary JSON object, consisting of
  * any number of property name/value pairs.
@@ -34,15 +47,21 @@ typedef struct guac_common_json_state {
     /**
      * Buffer of partial JSON data. The individual blobs which make up the JSON
      * body of the object being sent over the Guacamole protocol will be
-     * built here.
+     * built here. This buffer is allocated by guac_common_json_begin_object()
+     * and must be freed with guac_common_json_free().
      */
-    char buffer[4096];
+    char* buffer;
 
     /**
      * The number of bytes currently used within the JSON buffer.
      */
     int size;
 
+    /**
+     * The number of bytes allocated for the JSON buffer.
+     */
+    int available;
+
     /**
      * The number of property name/value pairs written to the JSON object thus
      * far.
@@ -51,11 +70,33 @@ typedef struct guac_common_json_state {
 
 } guac_common_json_state;
 
+/**
+ * Writes the given string to the given buffer, escaped such that it may be
+ * included within a JSON string. Quotes, backslashes, and all control
+ * characters are escaped. All other characters, including any UTF-8
+ * multibyte sequences, are copied verbatim. The surrounding quotes are not
+ * written, and the result is not null-terminated.
+ *
+ * @param dest
+ *     The buffer to write the escaped string to. This buffer must have at
+ *     least six bytes of space for each byte of the given string.
+ *
+ * @param str
+ *     The string to escape.
+ *
+ * @param length
+ *     The number of bytes in the given string.
+ *
+ * @return
+ *     The number of bytes written to the given buffer.
+ */
+int guac_common_json_escape(char* dest, const char* str, int length);
+
 /**
  * Given a stream, the user to which it belongs, and the current stream state
- * of a JSON object, flushes the contents of the JSON buffer to a blob
- * instruction. Note that this will flush the JSON buffer only, and will not
- * necessarily flush the underlying guac_socket of the user.
+ * of a JSON object, flushes the contents of the JSON buffer to one or more
+ * blob instructions. Note that this will flush the JSON buffer only, and will
+ * not necessarily flush the underlying guac_socket of the user.
  *
  * @param user
  *     The user to which the data will be flushed.
@@ -65,14 +106,17 @@ typedef struct guac_common_json_state {
  *
  * @param json_state
  *     The state object whose buffer should be flushed.
+ *
+ * @return
+ *     The number of blobs sent, which may be zero if the buffer was empty.
  */
-void guac_common_json_flush(guac_user* user, guac_stream* stream,
+int guac_common_json_flush(guac_user* user, guac_stream* stream,
         guac_common_json_state* json_state);
 
 /**
  * Given a stream, the user to which it belongs, and the current stream state
  * of a JSON object, writes the contents of the given buffer to the JSON buffer
- * of the stream state, flushing as necessary.
+ * of the stream state, sending any complete blobs.
  *
  * @param user
  *     The user to which the data will be flushed as necessary.
@@ -92,7 +136,7 @@ void guac_common_json_flush(guac_user* user, guac_stream* stream,
  *     The number of bytes in the buffer.
  *
  * @return
- *     Non-zero if at least one blob was written, zero otherwise.
+ *     The number of blobs sent, which may be zero.
  */
 int guac_common_json_write(guac_user* user, guac_stream* stream,
         guac_common_json_state* json_state, const char* buffer, int length);
@@ -118,7 +162,7 @@ int guac_common_json_write(guac_user* user, guac_stream* stream,
  *     The string to write.
  *
  * @return
- *     Non-zero if at least one blob was written, zero otherwise.
+ *     The number of blobs sent, which may be zero.
  */
 int guac_common_json_write_string(guac_user* user,
         guac_stream* stream, guac_common_json_state* json_state,
@@ -147,7 +191,7 @@ int guac_common_json_write_string(guac_user* user,
  *     The value of the property to write.
  *
  * @return
- *     Non-zero if at least one blob was written, zero otherwise.
+ *     The number of blobs sent, which may be zero.
  */
 int guac_common_json_write_property(guac_user* user, guac_stream* stream,
         guac_common_json_state* json_state, const char* name,
@@ -157,7 +201,8 @@ int guac_common_json_write_property(guac_user* user, guac_stream* stream,
  * Given a stream, the user to which it belongs, and the current stream state
  * of a JSON object, initializes the state for writing a new JSON object. Note
  * that although the user and stream must be provided, no instruction or
- * blobs will be written due to any call to this function.
+ * blobs will be written due to any call to this function. The state must
+ * later be freed with guac_common_json_free().
  *
  * @param user
  *     The user associated with the given stream.
@@ -187,10 +232,20 @@ void guac_common_json_begin_object(guac_user* user, guac_stream* stream,
  *     The state object whose in-progress JSON object should be terminated.
  *
  * @return
- *     Non-zero if at least one blob was written, zero otherwise.
+ *     The number of blobs sent, which may be zero.
  */
 int guac_common_json_end_object(guac_user* user, guac_stream* stream,
         guac_common_json_state* json_state);
 
+/**
+ * Frees the JSON buffer of the given state, which must have been initialized
+ * with guac_common_json_begin_object(). Any data not yet flushed is
+ * discarded.
+ *
+ * @param json_state
+ *     The state object whose resources should be freed.
+ */
+void guac_common_json_free(guac_common_json_state* json_state);
+
 #endif
 
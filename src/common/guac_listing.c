@@ -0,0 +1,304 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "config.h"
+
+#include "guac_json.h"
+#include "guac_listing.h"
+
+#include <guacamole/protocol.h>
+#include <guacamole/socket.h>
+#include <guacamole/stream.h>
+#include <guacamole/timestamp.h>
+#include <guacamole/user.h>
+
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+
+guac_common_listing* guac_common_listing_alloc(const char* path) {
+
+    guac_common_listing* listing = malloc(sizeof(guac_common_listing));
+
+    listing->path = strdup(path);
+    listing->count = 0;
+    listing->size = GUAC_COMMON_LISTING_INITIAL_SIZE;
+    listing->entries = malloc(sizeof(guac_common_listing_entry)
+            * listing->size);
+    listing->created = guac_timestamp_current();
+    listing->refcount = 1;
+
+    return listing;
+
+}
+
+void guac_common_listing_add(guac_common_listing* listing, const char* path,
+        const char* mimetype) {
+
+    /* Grow entry array as needed */
+    if (listing->count == listing->size) {
+        listing->size *= 2;
+        listing->entries = realloc(listing->entries,
+                sizeof(guac_common_listing_entry) * listing->size);
+    }
+
+    guac_common_listing_entry* entry = &(listing->entries[listing->count++]);
+    entry->path = strdup(path);
+    entry->mimetype = mimetype;
+
+}
+
+/**
+ * Frees the given listing and all of its entries, regardless of the number of
+ * references remaining.
+ *
+ * @param listing
+ *     The listing to free.
+ */
+static void guac_common_listing_free(guac_common_listing* listing) {
+
+    int i;
+
+    for (i = 0; i < listing->count; i++)
+        free(listing->entries[i].path);
+
+    free(listing->entries);
+    free(listing->path);
+    free(listing);
+
+}
+
+/**
+ * Releases a reference to the given listing, freeing the listing if no
+ * references remain. The lock of the associated cache must be held.
+ *
+ * @param listing
+ *     The listing to release.
+ */
+static void __guac_common_listing_release(guac_common_listing* listing) {
+    if (--listing->refcount == 0)
+        guac_common_listing_free(listing);
+}
+
+guac_common_listing_cache* guac_common_listing_cache_alloc() {
+
+    guac_common_listing_cache* cache =
+        malloc(sizeof(guac_common_listing_cache));
+
+    memset(cache->listings, 0, sizeof(cache->listings));
+    pthread_mutex_init(&(cache->lock), NULL);
+
+    return cache;
+
+}
+
+void guac_common_listing_cache_free(guac_common_listing_cache* cache) {
+
+    guac_common_listing_cache_invalidate(cache);
+
+    pthread_mutex_destroy(&(cache->lock));
+    free(cache);
+
+}
+
+guac_common_listing* guac_common_listing_cache_get(
+        guac_common_listing_cache* cache, const char* path) {
+
+    guac_common_listing* found = NULL;
+    guac_timestamp now = guac_timestamp_current();
+    int i;
+
+    pthread_mutex_lock(&(cache->lock));
+
+    for (i = 0; i < GUAC_COMMON_LISTING_CACHE_SIZE; i++) {
+
+        guac_common_listing* listing = cache->listings[i];
+        if (listing == NULL)
+            continue;
+
+        /* Discard any expired listings */
+        if (now - listing->created > GUAC_COMMON_LISTING_TTL) {
+            cache->listings[i] = NULL;
+            __guac_common_listing_release(listing);
+            continue;
+        }
+
+        /* Acquire reference to matching listing */
+        if (found == NULL && strcmp(listing->path, path) == 0) {
+            listing->refcount++;
+            found = listing;
+        }
+
+    }
+
+    pthread_mutex_unlock(&(cache->lock));
+    return found;
+
+}
+
+void guac_common_listing_cache_put(guac_common_listing_cache* cache,
+        guac_common_listing* listing) {
+
+    int i;
+    int slot = 0;
+
+    pthread_mutex_lock(&(cache->lock));
+
+    /* Replace listing of same directory, otherwise the first free or oldest
+     * listing */
+    for (i = 0; i < GUAC_COMMON_LISTING_CACHE_SIZE; i++) {
+
+        guac_common_listing* current = cache->listings[i];
+
+        if (current == NULL || strcmp(current->path, listing->path) == 0) {
+            slot = i;
+            break;
+        }
+
+        if (current->created < cache->listings[slot]->created)
+            slot = i;
+
+    }
+
+    if (cache->listings[slot] != NULL)
+        __guac_common_listing_release(cache->listings[slot]);
+
+    listing->refcount++;
+    cache->listings[slot] = listing;
+
+    pthread_mutex_unlock(&(cache->lock));
+
+}
+
+void guac_common_listing_cache_invalidate(guac_common_listing_cache* cache) {
+
+    int i;
+
+    pthread_mutex_lock(&(cache->lock));
+
+    for (i = 0; i < GUAC_COMMON_LISTING_CACHE_SIZE; i++) {
+        if (cache->listings[i] != NULL) {
+            __guac_common_listing_release(cache->listings[i]);
+            cache->listings[i] = NULL;
+        }
+    }
+
+    pthread_mutex_unlock(&(cache->lock));
+
+}
+
+void guac_common_listing_release(guac_common_listing_cache* cache,
+        guac_common_listing* listing) {
+
+    pthread_mutex_lock(&(cache->lock));
+    __guac_common_listing_release(listing);
+    pthread_mutex_unlock(&(cache->lock));
+
+}
+
+void guac_common_listing_stream_init(guac_common_listing_stream* state,
+        guac_user* user, guac_stream* stream,
+        guac_common_listing_cache* cache, guac_common_listing* listing) {
+
+    state->listing = listing;
+    state->cache = cache;
+    state->index = 0;
+    state->complete = 0;
+
+    /* The "body" instruction is itself awaiting acknowledgement */
+    state->outstanding = 1;
+
+    guac_common_json_begin_object(user, stream, &state->json_state);
+
+}
+
+/**
+ * Ends the given listing stream, freeing the stream and releasing the
+ * reference to the listing.
+ *
+ * @param state
+ *     The state of the listing stream.
+ *
+ * @param user
+ *     The user that was receiving the listing.
+ *
+ * @param stream
+ *     The stream over which the listing was being sent.
+ */
+static void guac_common_listing_stream_end(guac_common_listing_stream* state,
+        guac_user* user, guac_stream* stream) {
+
+    guac_common_listing_release(state->cache, state->listing);
+    state->listing = NULL;
+
+    guac_common_json_free(&state->json_state);
+
+    guac_user_free_stream(user, stream);
+
+}
+
+int guac_common_listing_stream_ack(guac_common_listing_stream* state,
+        guac_user* user, guac_stream* stream) {
+
+    guac_common_listing* listing = state->listing;
+
+    if (state->outstanding > 0)
+        state->outstanding--;
+
+    /* Fill window with further entries */
+    while (!state->complete
+            && state->outstanding < GUAC_COMMON_LISTING_WINDOW) {
+
+        /* Complete JSON object once all entries are written */
+        if (state->index == listing->count) {
+            state->outstanding += guac_common_json_end_object(user, stream,
+                    &state->json_state);
+            state->outstanding += guac_common_json_flush(user, stream,
+                    &state->json_state);
+            state->complete = 1;
+            break;
+        }
+
+        /* Each blob sent, however many a single entry requires, must be
+         * acknowledged before the stream can end */
+        guac_common_listing_entry* entry = &(listing->entries[state->index++]);
+        state->outstanding += guac_common_json_write_property(user, stream,
+                &state->json_state, entry->path, entry->mimetype);
+
+    }
+
+    /* End stream only after all blobs are acknowledged, such that no ack
+     * can be misdirected to a later stream reusing the same index */
+    if (state->complete && state->outstanding == 0) {
+        guac_protocol_send_end(user->socket, stream);
+        guac_common_listing_stream_end(state, user, stream);
+        guac_socket_flush(user->socket);
+        return 1;
+    }
+
+    guac_socket_flush(user->socket);
+    return 0;
+
+}
+
+void guac_common_listing_stream_abort(guac_common_listing_stream* state,
+        guac_user* user, guac_stream* stream) {
+    guac_common_listing_stream_end(state, user, stream);
+}
+
@@ -0,0 +1,341 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef GUAC_COMMON_LISTING_H
+#define GUAC_COMMON_LISTING_H
+
+#include "config.h"
+
+#include "guac_json.h"
+
+#include <guacamole/stream.h>
+#include <guacamole/timestamp.h>
+#include <guacamole/user.h>
+
+#include <pthread.h>
+
+/**
+ * The number of entries initially allocated for each directory listing.
+ */
+#define GUAC_COMMON_LISTING_INITIAL_SIZE 64
+
+/**
+ * The maximum number of directory listings which may be cached at any one
+ * time.
+ */
+#define GUAC_COMMON_LISTING_CACHE_SIZE 8
+
+/**
+ * The number of milliseconds that a cached directory listing remains valid.
+ * Changes made through the same connection invalidate the cache immediately;
+ * this limit only bounds how long changes made by other means may go unseen.
+ */
+#define GUAC_COMMON_LISTING_TTL 2000
+
+/**
+ * The maximum number of blobs of a directory listing which may be sent
+ * without having been acknowledged by the receiving user.
+ */
+#define GUAC_COMMON_LISTING_WINDOW 16
+
+/**
+ * A single entry within a directory listing.
+ */
+typedef struct guac_common_listing_entry {
+
+    /**
+     * The absolute path of the file or directory.
+     */
+    char* path;
+
+    /**
+     * The mimetype of the entry, as sent within the JSON body of the
+     * listing. This will be GUAC_USER_STREAM_INDEX_MIMETYPE for directories.
+     */
+    const char* mimetype;
+
+} guac_common_listing_entry;
+
+/**
+ * The complete contents of a single directory, read in advance such that it
+ * may be streamed to any number of users without rereading the directory.
+ * Listings are reference counted, as a listing may be in the process of
+ * being sent while the cache replaces or discards it.
+ */
+typedef struct guac_common_listing {
+
+    /**
+     * The absolute path of the directory.
+     */
+    char* path;
+
+    /**
+     * All entries within the directory.
+     */
+    guac_common_listing_entry* entries;
+
+    /**
+     * The number of entries within the directory.
+     */
+    int count;
+
+    /**
+     * The number of entries for which space has been allocated.
+     */
+    int size;
+
+    /**
+     * The time at which the directory was read.
+     */
+    guac_timestamp created;
+
+    /**
+     * The number of references to this listing. The listing is freed once
+     * this reaches zero.
+     */
+    int refcount;
+
+} guac_common_listing;
+
+/**
+ * A small, thread-safe cache of recently-read directory listings.
+ */
+typedef struct guac_common_listing_cache {
+
+    /**
+     * All cached listings. Unused slots are NULL.
+     */
+    guac_common_listing* listings[GUAC_COMMON_LISTING_CACHE_SIZE];
+
+    /**
+     * Lock which guards access to the cached listings and to the reference
+     * counts of all listings.
+     */
+    pthread_mutex_t lock;
+
+} guac_common_listing_cache;
+
+/**
+ * The state of a directory listing which is being streamed to a user as a
+ * JSON object.
+ */
+typedef struct guac_common_listing_stream {
+
+    /**
+     * The listing being sent.
+     */
+    guac_common_listing* listing;
+
+    /**
+     * The cache from which the listing was retrieved, and through which the
+     * reference held by this stream must be released.
+     */
+    guac_common_listing_cache* cache;
+
+    /**
+     * The index of the next entry to send.
+     */
+    int index;
+
+    /**
+     * The number of instructions sent along the stream which have not yet
+     * been acknowledged.
+     */
+    int outstanding;
+
+    /**
+     * Non-zero if the entire JSON object has been sent, and the stream need
+     * only be ended once all outstanding blobs have been acknowledged.
+     */
+    int complete;
+
+    /**
+     * The current state of the JSON directory object being written.
+     */
+    guac_common_json_state json_state;
+
+} guac_common_listing_stream;
+
+/**
+ * Allocates a new, empty directory listing having a single reference, which
+ * is owned by the caller.
+ *
+ * @param path
+ *     The absolute path of the directory.
+ *
+ * @return
+ *     A newly-allocated, empty directory listing.
+ */
+guac_common_listing* guac_common_listing_alloc(const char* path);
+
+/**
+ * Adds a new entry to the given directory listing.
+ *
+ * @param listing
+ *     The listing to add an entry to.
+ *
+ * @param path
+ *     The absolute path of the file or directory. This string is copied.
+ *
+ * @param mimetype
+ *     The mimetype to send for the entry. This string is NOT copied and must
+ *     remain valid for the lifetime of the listing.
+ */
+void guac_common_listing_add(guac_common_listing* listing, const char* path,
+        const char* mimetype);
+
+/**
+ * Allocates a new, empty cache of directory listings.
+ *
+ * @return
+ *     A newly-allocated directory listing cache.
+ */
+guac_common_listing_cache* guac_common_listing_cache_alloc();
+
+/**
+ * Frees the given directory listing cache. Listings which are still being
+ * sent are freed once their last reference is released.
+ *
+ * @param cache
+ *     The cache to free.
+ */
+void guac_common_listing_cache_free(guac_common_listing_cache* cache);
+
+/**
+ * Returns a new reference to the cached listing of the given directory, if
+ * that listing was read no more than GUAC_COMMON_LISTING_TTL milliseconds
+ * ago. The reference must be released with guac_common_listing_release().
+ *
+ * @param cache
+ *     The cache to search.
+ *
+ * @param path
+ *     The absolute path of the directory.
+ *
+ * @return
+ *     A new reference to the cached listing, or NULL if no valid listing of
+ *     the given directory is cached.
+ */
+guac_common_listing* guac_common_listing_cache_get(
+        guac_common_listing_cache* cache, const char* path);
+
+/**
+ * Stores the given listing within the cache, replacing any existing listing
+ * of the same directory or, if the cache is full, the oldest listing. The
+ * cache acquires its own reference; the caller's reference is unaffected.
+ *
+ * @param cache
+ *     The cache to store the listing within.
+ *
+ * @param listing
+ *     The listing to store.
+ */
+void guac_common_listing_cache_put(guac_common_listing_cache* cache,
+        guac_common_listing* listing);
+
+/**
+ * Removes all listings from the given cache. This function must be invoked
+ * whenever a change is made to the filesystem whose listings are cached.
+ *
+ * @param cache
+ *     The cache to invalidate.
+ */
+void guac_common_listing_cache_invalidate(guac_common_listing_cache* cache);
+
+/**
+ * Releases a reference to the given listing which was obtained through
+ * guac_common_listing_alloc() or guac_common_listing_cache_get(), freeing
+ * the listing if no references remain.
+ *
+ * @param cache
+ *     The cache with which the listing may be associated.
+ *
+ * @param listing
+ *     The listing to release.
+ */
+void guac_common_listing_release(guac_common_listing_cache* cache,
+        guac_common_listing* listing);
+
+/**
+ * Initializes the given stream state for sending the given listing as a JSON
+ * object. The stream state takes ownership of the caller's reference to the
+ * listing. Nothing is sent until the "body" instruction associated with the
+ * stream is acknowledged and guac_common_listing_stream_ack() is invoked.
+ *
+ * @param state
+ *     The stream state to initialize.
+ *
+ * @param user
+ *     The user that will receive the listing.
+ *
+ * @param stream
+ *     The stream over which the listing will be sent.
+ *
+ * @param cache
+ *     The cache through which the reference to the listing must be released.
+ *
+ * @param listing
+ *     The listing to send.
+ */
+void guac_common_listing_stream_init(guac_common_listing_stream* state,
+        guac_user* user, guac_stream* stream,
+        guac_common_listing_cache* cache, guac_common_listing* listing);
+
+/**
+ * Handles receipt of an "ack" for the given listing stream, sending further
+ * blobs of the listing until up to GUAC_COMMON_LISTING_WINDOW blobs are
+ * unacknowledged, or until the listing is complete. Once the listing is
+ * complete, the stream is ended and freed, and the reference to the listing
+ * is released. The stream state itself is not freed.
+ *
+ * @param state
+ *     The state of the listing stream.
+ *
+ * @param user
+ *     The user receiving the listing.
+ *
+ * @param stream
+ *     The stream over which the listing is being sent.
+ *
+ * @return
+ *     Non-zero if the listing is complete and the stream has been freed,
+ *     zero otherwise.
+ */
+int guac_common_listing_stream_ack(guac_common_listing_stream* state,
+        guac_user* user, guac_stream* stream);
+
+/**
+ * Abandons the given listing stream, freeing the stream and releasing the
+ * reference to the listing. Nothing further is sent. The stream state itself
+ * is not freed.
+ *
+ * @param state
+ *     The state of the listing stream.
+ *
+ * @param user
+ *     The user that was receiving the listing.
+ *
+ * @param stream
+ *     The stream over which the listing was being sent.
+ */
+void guac_common_listing_stream_abort(guac_common_listing_stream* state,
+        guac_user* user, guac_stream* stream);
+
+#endif
+
@@ -116,6 +116,26 @@
  */
 #define GUAC_SURFACE_WEBP_BLOCK_SIZE 8
 
+/**
+ * The framerate which, if exceeded within a sufficiently large region,
+ * indicates that the region should be streamed as video, if supported.
+ */
+#define GUAC_COMMON_SURFACE_VIDEO_FRAMERATE 15
+
+/**
+ * Minimum video region size (area). Regions smaller than this will continue
+ * to be sent as images, as the overhead of a dedicated video stream is not
+ * justified.
+ */
+#define GUAC_SURFACE_VIDEO_MIN_BITMAP_SIZE 76800
+
+/**
+ * The number of milliseconds which may elapse without any change to a region
+ * being streamed as video before that video stream is ended, and the region
+ * is once again updated using images.
+ */
+#define GUAC_SURFACE_VIDEO_IDLE_TIMEOUT 2000
+
 /**
  * Updates the coordinates of the given rectangle to be within the bounds of
  * the given surface.
@@ -473,6 +493,292 @@ static int __guac_common_surface_should_use_webp(guac_common_surface* surface,
 
 }
 
+/**
+ * Flushes the bitmap update currently described by the dirty rectangle within the
+ * given surface to that surface's bitmap queue. There MUST be space within the
+ * queue.
+ *
+ * @param surface The surface to flush.
+ */
+static void __guac_common_surface_flush_to_queue(guac_common_surface* surface) {
+
+    guac_common_surface_bitmap_rect* rect;
+
+    /* Do not flush if not dirty */
+    if (!surface->dirty)
+        return;
+
+    /* Add new rect to queue */
+    rect = &(surface->bitmap_queue[surface->bitmap_queue_length++]);
+    rect->rect = surface->dirty_rect;
+    rect->flushed = 0;
+
+    /* Surface now flushed */
+    surface->dirty = 0;
+
+}
+
+#ifdef ENABLE_VIDEO_STREAMING
+/**
+ * Returns whether the given rectangle, which is about to be flushed, is part
+ * of a sustained high-motion region which should be streamed as video rather
+ * than as a series of images.
+ *
+ * @param surface
+ *     The surface to be queried.
+ *
+ * @param rect
+ *     The rectangle to check.
+ *
+ * @return
+ *     Non-zero if the rectangle should be streamed as video, zero otherwise.
+ */
+static int __guac_common_surface_should_use_video(
+        guac_common_surface* surface, const guac_common_rect* rect) {
+
+    /* Only visible layers may be streamed as video */
+    if (surface->layer->index < 0 || !surface->realized)
+        return 0;
+
+    /* Calculate the average framerate for the given rect */
+    int framerate = __guac_common_surface_calculate_framerate(surface, rect);
+
+    int rect_size = rect->width * rect->height;
+
+    /* Video is preferred if:
+     * - frame rate is high enough
+     * - image size is large enough
+     * - PNG is not more optimal based on image contents */
+    return framerate >= GUAC_COMMON_SURFACE_VIDEO_FRAMERATE
+        && rect_size >= GUAC_SURFACE_VIDEO_MIN_BITMAP_SIZE
+        && __guac_common_surface_png_optimality(surface, rect) < 0;
+
+}
+
+/**
+ * Ends the active video stream of the given surface, if any. The region
+ * previously covered by the video is marked dirty, such that its current
+ * contents will be sent as an image upon the next flush.
+ *
+ * @param surface
+ *     The surface whose video stream should be ended.
+ */
+static void __guac_common_surface_end_video(guac_common_surface* surface) {
+
+    if (surface->video == NULL)
+        return;
+
+    guac_common_video_free(surface->video);
+    surface->video = NULL;
+
+    /* Underlying layer has not been updated while video was playing */
+    __guac_common_bound_rect(surface, &surface->video_rect, NULL, NULL);
+    __guac_common_mark_dirty(surface, &surface->video_rect);
+
+}
+
+/**
+ * Notes that the given rectangle of the given surface has been modified by
+ * an operation which does not pass through the bitmap queue, such that the
+ * next frame of any active video stream covering that rectangle must be sent.
+ *
+ * @param surface
+ *     The surface which was modified.
+ *
+ * @param rect
+ *     The rectangle which was modified.
+ */
+static void __guac_common_surface_touch_video(guac_common_surface* surface,
+        const guac_common_rect* rect) {
+
+    if (surface->video != NULL
+            && guac_common_rect_intersects(rect, &surface->video_rect))
+        surface->video_dirty = 1;
+
+}
+
+/**
+ * Ends the active video stream of the given surface if it covers any part of
+ * the given rectangle, which is about to be read by the client through a
+ * "copy" or "transfer" instruction. The contents of the layer beneath a
+ * video stream are out of date, and cannot be used as a source.
+ *
+ * @param surface
+ *     The surface which is about to be read.
+ *
+ * @param rect
+ *     The rectangle which is about to be read.
+ */
+static void __guac_common_surface_prepare_video_read(
+        guac_common_surface* surface, const guac_common_rect* rect) {
+
+    if (surface->video != NULL
+            && guac_common_rect_intersects(rect, &surface->video_rect))
+        __guac_common_surface_end_video(surface);
+
+}
+
+/**
+ * Ends the active video stream of the given surface if it has been idle for
+ * longer than GUAC_SURFACE_VIDEO_IDLE_TIMEOUT, or if a reset of the video
+ * stream has been requested.
+ *
+ * @param surface
+ *     The surface whose video stream should be checked.
+ */
+static void __guac_common_surface_check_video(guac_common_surface* surface) {
+
+    if (surface->video == NULL)
+        return;
+
+    guac_timestamp now = guac_timestamp_current();
+
+    /* End video if no longer needed or no longer valid for all users */
+    if (surface->video_reset || (!surface->video_dirty && now
+                - surface->video_last_frame > GUAC_SURFACE_VIDEO_IDLE_TIMEOUT))
+        __guac_common_surface_end_video(surface);
+
+}
+
+/**
+ * Sends the current contents of the video region of the given surface as a
+ * new frame of video, if any part of that region has changed since the last
+ * frame or if a user has joined who must receive the video stream.
+ *
+ * @param surface
+ *     The surface whose video stream should be updated.
+ */
+static void __guac_common_surface_flush_video(guac_common_surface* surface) {
+
+    if (surface->video == NULL)
+        return;
+
+    if (!surface->video_dirty)
+        return;
+
+    unsigned char* buffer = surface->buffer
+                          + surface->video_rect.y * surface->stride
+                          + surface->video_rect.x * 4;
+
+    /* Fall back to images if encoding fails */
+    if (guac_common_video_write_frame(surface->video, buffer, surface->stride)) {
+        __guac_common_surface_end_video(surface);
+        return;
+    }
+
+    surface->video_dirty = 0;
+    surface->video_last_frame = guac_timestamp_current();
+
+}
+
+/**
+ * Claims the bitmap update currently described by the dirty rectangle within
+ * the given surface for the surface's video stream, starting a new video
+ * stream if the update is part of a sustained high-motion region. If the
+ * update lies entirely within the video region, the surface is no longer
+ * dirty. If the update only partly overlaps the video region, the parts of
+ * the update outside the video region are queued to be flushed as images.
+ *
+ * @param surface
+ *     The surface to flush.
+ *
+ * @return
+ *     Non-zero if the update has been claimed by the video stream, zero if
+ *     the update must be flushed as an image.
+ */
+static int __guac_common_surface_flush_to_video(guac_common_surface* surface) {
+
+    const guac_common_rect* rect = &surface->dirty_rect;
+
+    /* Attempt to start a new video stream if needed */
+    if (surface->video == NULL) {
+
+        if (!__guac_common_surface_should_use_video(surface, rect))
+            return 0;
+
+        /* Video is only possible if all users support a common format */
+        const guac_common_video_format* format =
+            guac_common_video_select_format(surface->client);
+        if (format == NULL)
+            return 0;
+
+        /* YUV 4:2:0 requires even dimensions */
+        guac_common_rect region = *rect;
+        region.width &= ~1;
+        region.height &= ~1;
+
+        surface->video = guac_common_video_alloc(surface->client,
+                surface->socket, surface->layer, format,
+                region.x, region.y, region.width, region.height);
+
+        /* Fall back to images if video could not be started */
+        if (surface->video == NULL)
+            return 0;
+
+        surface->video_rect = region;
+        surface->video_last_frame = guac_timestamp_current();
+        surface->video_reset = 0;
+
+    }
+
+    const guac_common_rect* video_rect = &surface->video_rect;
+
+    /* Ignore updates which merely touch the video region */
+    if (rect->x >= video_rect->x + video_rect->width
+            || video_rect->x >= rect->x + rect->width
+            || rect->y >= video_rect->y + video_rect->height
+            || video_rect->y >= rect->y + rect->height)
+        return 0;
+
+    /* Video region must be updated with the next frame */
+    surface->video_dirty = 1;
+
+    /* Update is covered entirely by video */
+    if (guac_common_rect_intersects(rect, video_rect) == 2) {
+        surface->dirty = 0;
+        return 1;
+    }
+
+    /* Split off the parts of the update outside the video region */
+    guac_common_rect remaining = *rect;
+    guac_common_rect splits[4];
+    int i, count = 0;
+
+    while (count < 4 && guac_common_rect_clip_and_split(&remaining,
+                video_rect, &splits[count]))
+        count++;
+
+    /* Flush entire update as an image if the parts cannot be queued */
+    if (surface->bitmap_queue_length + count > GUAC_COMMON_SURFACE_QUEUE_SIZE)
+        return 0;
+
+    /* Queue the parts outside the video region, which will be flushed as
+     * images later within the same flush, skipping the part beneath the
+     * video which would never be seen */
+    for (i = 0; i < count; i++) {
+        surface->dirty_rect = splits[i];
+        surface->dirty = 1;
+        __guac_common_surface_flush_to_queue(surface);
+    }
+
+    surface->dirty = 0;
+    return 1;
+
+}
+#else
+/* Video streaming is not available. These are no-ops. */
+static void __guac_common_surface_end_video(guac_common_surface* surface) {}
+static void __guac_common_surface_touch_video(guac_common_surface* surface,
+        const guac_common_rect* rect) {}
+static void __guac_common_surface_prepare_video_read(
+        guac_common_surface* surface, const guac_common_rect* rect) {}
+static void __guac_common_surface_check_video(guac_common_surface* surface) {}
+static void __guac_common_surface_flush_video(guac_common_surface* surface) {}
+static int __guac_common_surface_flush_to_video(guac_common_surface* surface) {
+    return 0;
+}
+#endif
+
 /**
  * Updates the heat map cells which intersect the given rectangle using the
  * given timestamp. This timestamp, along with timestamps from past updates,
@@ -538,31 +844,6 @@ static void __guac_common_surface_touch_rect(guac_common_surface* surface,
 
 }
 
-/**
- * Flushes the bitmap update currently described by the dirty rectangle within the
- * given surface to that surface's bitmap queue. There MUST be space within the
- * queue.
- *
- * @param surface The surface to flush.
- */
-static void __guac_common_surface_flush_to_queue(guac_common_surface* surface) {
-
-    guac_common_surface_bitmap_rect* rect;
-
-    /* Do not flush if not dirty */
-    if (!surface->dirty)
-        return;
-
-    /* Add new rect to queue */
-    rect = &(surface->bitmap_queue[surface->bitmap_queue_length++]);
-    rect->rect = surface->dirty_rect;
-    rect->flushed = 0;
-
-    /* Surface now flushed */
-    surface->dirty = 0;
-
-}
-
 void guac_common_surface_flush_deferred(guac_common_surface* surface) {
 
     /* Do not flush if not dirty */
@@ -1019,6 +1300,9 @@ guac_common_surface* guac_common_surface_alloc(guac_client* client,
 
 void guac_common_surface_free(guac_common_surface* surface) {
 
+    /* Dispose of any video layer */
+    __guac_common_surface_end_video(surface);
+
     /* Only dispose of surface if it exists */
     if (surface->realized)
         guac_protocol_send_dispose(surface->socket, surface->layer);
@@ -1045,6 +1329,9 @@ void guac_common_surface_resize(guac_common_surface* surface, int w, int h) {
     int heat_width = GUAC_COMMON_SURFACE_HEAT_DIMENSION(w);
     int heat_height = GUAC_COMMON_SURFACE_HEAT_DIMENSION(h);
 
+    /* Video region may no longer be valid */
+    __guac_common_surface_end_video(surface);
+
     /* Copy old surface data */
     old_buffer = surface->buffer;
     old_stride = surface->stride;
@@ -1119,6 +1406,30 @@ void guac_common_surface_draw(guac_common_surface* surface, int x, int y, cairo_
 
 }
 
+void guac_common_surface_invalidate(guac_common_surface* surface,
+        int x, int y, int w, int h) {
+
+    guac_common_rect rect;
+    guac_common_rect_init(&rect, x, y, w, h);
+
+    /* Clip operation */
+    __guac_common_clip_rect(surface, &rect, NULL, NULL);
+    if (rect.width <= 0 || rect.height <= 0)
+        return;
+
+    /* Update the heat map for the update rectangle. */
+    guac_timestamp time = guac_timestamp_current();
+    __guac_common_surface_touch_rect(surface, &rect, time);
+
+    /* Flush if not combining */
+    if (!__guac_common_should_combine(surface, &rect, 0))
+        guac_common_surface_flush_deferred(surface);
+
+    /* Always defer draws */
+    __guac_common_mark_dirty(surface, &rect);
+
+}
+
 void guac_common_surface_paint(guac_common_surface* surface, int x, int y, cairo_surface_t* src,
                                int red, int green, int blue) {
 
@@ -1178,11 +1489,19 @@ void guac_common_surface_copy(guac_common_surface* src, int sx, int sy, int w, i
 
     /* Otherwise, flush and draw immediately */
     else {
+
+        /* Source must be current on the client */
+        guac_common_rect src_rect;
+        guac_common_rect_init(&src_rect, sx, sy, rect.width, rect.height);
+        __guac_common_surface_prepare_video_read(src, &src_rect);
+
         guac_common_surface_flush(dst);
         guac_common_surface_flush(src);
         guac_protocol_send_copy(socket, src_layer, sx, sy, rect.width, rect.height,
                                 GUAC_COMP_OVER, dst_layer, rect.x, rect.y);
+        __guac_common_surface_touch_video(dst, &rect);
         dst->realized = 1;
+
     }
 
     /* Update backing surface last if destination rect can intersect source rect */
@@ -1219,10 +1538,18 @@ void guac_common_surface_transfer(guac_common_surface* src, int sx, int sy, int
 
     /* Otherwise, flush and draw immediately */
     else {
+
+        /* Source must be current on the client */
+        guac_common_rect src_rect;
+        guac_common_rect_init(&src_rect, sx, sy, rect.width, rect.height);
+        __guac_common_surface_prepare_video_read(src, &src_rect);
+
         guac_common_surface_flush(dst);
         guac_common_surface_flush(src);
         guac_protocol_send_transfer(socket, src_layer, sx, sy, rect.width, rect.height, op, dst_layer, rect.x, rect.y);
+        __guac_common_surface_touch_video(dst, &rect);
         dst->realized = 1;
+
     }
 
     /* Update backing surface last if destination rect can intersect source rect */
@@ -1260,6 +1587,7 @@ void guac_common_surface_rect(guac_common_surface* surface,
         guac_common_surface_flush(surface);
         guac_protocol_send_rect(socket, layer, rect.x, rect.y, rect.width, rect.height);
         guac_protocol_send_cfill(socket, GUAC_COMP_OVER, layer, red, green, blue, 0xFF);
+        __guac_common_surface_touch_video(surface, &rect);
         surface->realized = 1;
     }
 
@@ -1300,20 +1628,18 @@ static void __guac_common_surface_flush_to_png(guac_common_surface* surface) {
         guac_socket* socket = surface->socket;
         const guac_layer* layer = surface->layer;
 
-        /* Get Cairo surface for specified rect */
+        /* Get image data for specified rect */
         unsigned char* buffer = surface->buffer
                               + surface->dirty_rect.y * surface->stride
                               + surface->dirty_rect.x * 4;
 
-        cairo_surface_t* rect = cairo_image_surface_create_for_data(buffer,
-                CAIRO_FORMAT_RGB24, surface->dirty_rect.width,
-                surface->dirty_rect.height, surface->stride);
+        /* Send PNG for rect directly from the surface's buffer, without
+         * wrapping the rect in a new Cairo surface */
+        guac_client_stream_png_buffer(surface->client, socket, GUAC_COMP_OVER,
+                layer, surface->dirty_rect.x, surface->dirty_rect.y, buffer,
+                surface->dirty_rect.width, surface->dirty_rect.height,
+                surface->stride);
 
-        /* Send PNG for rect */
-        guac_client_stream_png(surface->client, socket, GUAC_COMP_OVER,
-                layer, surface->dirty_rect.x, surface->dirty_rect.y, rect);
-
-        cairo_surface_destroy(rect);
         surface->realized = 1;
 
         /* Surface is no longer dirty */
@@ -1445,6 +1771,9 @@ static int __guac_common_surface_bitmap_rect_compare(const void* a, const void*
 
 void guac_common_surface_flush(guac_common_surface* surface) {
 
+    /* End video stream if no longer needed, repainting its region */
+    __guac_common_surface_check_video(surface);
+
     /* Flush final dirty rectangle to queue. */
     __guac_common_surface_flush_to_queue(surface);
 
@@ -1501,19 +1830,24 @@ void guac_common_surface_flush(guac_common_surface* surface) {
 
                 flushed++;
 
-                /* Prefer WebP when reasonable */
-                if (__guac_common_surface_should_use_webp(surface,
-                            &surface->dirty_rect))
-                    __guac_common_surface_flush_to_webp(surface);
+                /* Stream high-motion regions as video where possible */
+                if (!__guac_common_surface_flush_to_video(surface)) {
 
-                /* If not WebP, JPEG is the next best (lossy) choice */
-                else if (__guac_common_surface_should_use_jpeg(surface,
-                            &surface->dirty_rect))
-                    __guac_common_surface_flush_to_jpeg(surface);
+                    /* Prefer WebP when reasonable */
+                    if (__guac_common_surface_should_use_webp(surface,
+                                &surface->dirty_rect))
+                        __guac_common_surface_flush_to_webp(surface);
 
-                /* Use PNG if no lossy formats are appropriate */
-                else
-                    __guac_common_surface_flush_to_png(surface);
+                    /* If not WebP, JPEG is the next best (lossy) choice */
+                    else if (__guac_common_surface_should_use_jpeg(surface,
+                                &surface->dirty_rect))
+                        __guac_common_surface_flush_to_jpeg(surface);
+
+                    /* Use PNG if no lossy formats are appropriate */
+                    else
+                        __guac_common_surface_flush_to_png(surface);
+
+                }
 
             }
 
@@ -1523,6 +1857,9 @@ void guac_common_surface_flush(guac_common_surface* surface) {
 
     }
 
+    /* Send any pending frame of video */
+    __guac_common_surface_flush_video(surface);
+
     /* Flush complete */
     surface->bitmap_queue_length = 0;
 
@@ -1543,10 +1880,23 @@ void guac_common_surface_dup(guac_common_surface* surface, guac_user* user,
             surface->buffer, CAIRO_FORMAT_RGB24,
             surface->width, surface->height, surface->stride);
 
-    /* Send PNG for rect */
+    /* Send PNG for rect, including the current contents of any region being
+     * streamed as video */
     guac_user_stream_png(user, socket, GUAC_COMP_OVER, surface->layer,
             0, 0, rect);
     cairo_surface_destroy(rect);
 
+#ifdef ENABLE_VIDEO_STREAMING
+    /* The joining user receives the video stream beginning with the next
+     * frame, which must be sent even if unchanged. If the user cannot
+     * receive that stream, fall back to images for all users. */
+    if (surface->video != NULL) {
+        if (guac_common_video_dup(surface->video, user, socket))
+            surface->video_reset = 1;
+        else
+            surface->video_dirty = 1;
+    }
+#endif
+
 }
 
@@ -23,6 +23,10 @@
 #include "config.h"
 #include "guac_rect.h"
 
+#ifdef ENABLE_VIDEO_STREAMING
+#include "guac_video.h"
+#endif
+
 #include <cairo/cairo.h>
 #include <guacamole/client.h>
 #include <guacamole/layer.h>
@@ -180,6 +184,39 @@ typedef struct guac_common_surface {
      */
     guac_common_surface_heat_cell* heat_map;
 
+#ifdef ENABLE_VIDEO_STREAMING
+    /**
+     * The video stream currently covering the region of this surface
+     * described by video_rect, or NULL if no such stream is active. While a
+     * video stream is active, updates within that region are sent as frames
+     * of video rather than as images.
+     */
+    guac_common_video* video;
+
+    /**
+     * The region of this surface covered by the active video stream, if any.
+     */
+    guac_common_rect video_rect;
+
+    /**
+     * Non-zero if the contents of video_rect have changed since the last
+     * frame of video was sent, zero otherwise.
+     */
+    int video_dirty;
+
+    /**
+     * The time at which the most recent frame of video was sent.
+     */
+    guac_timestamp video_last_frame;
+
+    /**
+     * Non-zero if the active video stream must be ended upon the next flush,
+     * such as when a user joins who does not support the format of that
+     * stream.
+     */
+    int video_reset;
+#endif
+
 } guac_common_surface;
 
 /**
@@ -233,6 +270,21 @@ void guac_common_surface_resize(guac_common_surface* surface, int w, int h);
  */
 void guac_common_surface_draw(guac_common_surface* surface, int x, int y, cairo_surface_t* src);
 
+/**
+ * Marks the given rectangle of the given guac_common_surface as modified,
+ * exactly as if it had been drawn with guac_common_surface_draw(). This is
+ * only needed when the contents of the surface's buffer have been written
+ * directly, bypassing the drawing functions.
+ *
+ * @param surface The surface whose buffer was modified.
+ * @param x The X coordinate of the modified rectangle.
+ * @param y The Y coordinate of the modified rectangle.
+ * @param w The width of the modified rectangle.
+ * @param h The height of the modified rectangle.
+ */
+void guac_common_surface_invalidate(guac_common_surface* surface,
+        int x, int y, int w, int h);
+
 /**
  * Paints to the given guac_common_surface using the given data as a stencil,
  * filling opaque regions with the specified color, and leaving transparent
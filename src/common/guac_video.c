@@ -0,0 +1,854 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "config.h"
+#include "guac_video.h"
+
+#include <libavcodec/avcodec.h>
+#include <libavformat/avformat.h>
+#include <libavutil/dict.h>
+#include <libavutil/frame.h>
+#include <libswscale/swscale.h>
+#include <guacamole/client.h>
+#include <guacamole/layer.h>
+#include <guacamole/protocol.h>
+#include <guacamole/socket.h>
+#include <guacamole/stream.h>
+#include <guacamole/timestamp.h>
+#include <guacamole/user.h>
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* For libavformat >= 61: AVIOContext write callbacks receive const data */
+#if LIBAVFORMAT_VERSION_MAJOR >= 61
+#define GUAC_AVIO_WRITE_DATA const uint8_t
+#else
+#define GUAC_AVIO_WRITE_DATA uint8_t
+#endif
+
+/**
+ * All supported video formats, in order of preference. VP8 within WebM is
+ * preferred, as it is royalty-free and widely supported by browsers.
+ */
+static const guac_common_video_format guac_common_video_formats[] = {
+
+    /* VP8 within WebM */
+    {
+        "video/webm",
+        "libvpx",
+        "deadline=realtime:cpu-used=8:lag-in-frames=0",
+        "webm",
+        "live=1"
+    },
+
+    /* H.264 within fragmented MP4 */
+    {
+        "video/mp4",
+        "libx264",
+        "preset=ultrafast:tune=zerolatency",
+        "mp4",
+        "movflags=frag_keyframe+empty_moov+default_base_moof"
+    },
+
+    { NULL }
+
+};
+
+/**
+ * A user who joined the connection while a video stream was in progress, and
+ * who will begin receiving that stream at its next keyframe.
+ */
+typedef struct guac_common_video_joiner {
+
+    /**
+     * The joining user. This user is not dereferenced until verified with
+     * guac_client_for_user(), as the user may leave before the next keyframe.
+     */
+    guac_user* user;
+
+    /**
+     * The next user waiting to receive the video stream, or NULL if there are
+     * no further such users.
+     */
+    struct guac_common_video_joiner* next;
+
+} guac_common_video_joiner;
+
+struct guac_common_video {
+
+    /**
+     * The client associated with this video stream.
+     */
+    guac_client* client;
+
+    /**
+     * The socket over which all video data is sent.
+     */
+    guac_socket* socket;
+
+    /**
+     * The Guacamole stream over which encoded video is sent.
+     */
+    guac_stream* stream;
+
+    /**
+     * The format of the video.
+     */
+    const guac_common_video_format* format;
+
+    /**
+     * The layer on which the video is played back.
+     */
+    guac_layer* layer;
+
+    /**
+     * The layer containing the layer on which the video is played back.
+     */
+    const guac_layer* parent;
+
+    /**
+     * The X coordinate of the upper-left corner of the video, relative to
+     * the parent layer.
+     */
+    int x;
+
+    /**
+     * The Y coordinate of the upper-left corner of the video, relative to
+     * the parent layer.
+     */
+    int y;
+
+    /**
+     * The width of the video, in pixels.
+     */
+    int width;
+
+    /**
+     * The height of the video, in pixels.
+     */
+    int height;
+
+    /**
+     * The encoder context.
+     */
+    AVCodecContext* context;
+
+    /**
+     * The container which receives packets from the encoder.
+     */
+    AVFormatContext* container;
+
+    /**
+     * The stream within the container which contains the encoded video.
+     */
+    AVStream* container_stream;
+
+    /**
+     * The frame which receives converted image data prior to encoding. This
+     * frame is reused for every frame of the video.
+     */
+    AVFrame* frame;
+
+    /**
+     * The packet which receives encoded data from the encoder. This packet is
+     * reused for every frame of the video.
+     */
+    AVPacket* packet;
+
+    /**
+     * The context used to convert RGB image data to the YUV format required
+     * by the encoder.
+     */
+    struct SwsContext* sws;
+
+    /**
+     * Non-zero if the container header has been written, and thus the
+     * container trailer must be written when the video ends.
+     */
+    int header_written;
+
+    /**
+     * The time at which the video stream began.
+     */
+    guac_timestamp start;
+
+    /**
+     * Copy of the container header, as sent when the video stream began.
+     * Users who join while the video is in progress receive this header
+     * before the stream data following the next keyframe. If the header
+     * could not be copied, this will be NULL.
+     */
+    unsigned char* header;
+
+    /**
+     * The number of bytes within header.
+     */
+    int header_length;
+
+    /**
+     * The number of bytes allocated for header.
+     */
+    int header_size;
+
+    /**
+     * Non-zero if the container header is currently being written, and thus
+     * data written to the container must be copied into header.
+     */
+    int header_capturing;
+
+    /**
+     * All users who are waiting to receive the video stream from its next
+     * keyframe.
+     */
+    guac_common_video_joiner* joiners;
+
+    /**
+     * Non-zero if the next frame must be encoded as a keyframe, such that
+     * newly-joined users need not wait for the next periodic keyframe.
+     */
+    int keyframe_pending;
+
+    /**
+     * The presentation timestamp of the most recent frame, in milliseconds
+     * relative to the start of the video, or -1 if no frames have been
+     * written.
+     */
+    int64_t last_pts;
+
+};
+
+/**
+ * Returns whether the given user supports the given video format.
+ *
+ * @param user
+ *     The user to test.
+ *
+ * @param format
+ *     The video format to test.
+ *
+ * @return
+ *     Non-zero if the user supports the given video format, zero otherwise.
+ */
+static int guac_common_video_user_supports(guac_user* user,
+        const guac_common_video_format* format) {
+
+    const char** mimetype = user->info.video_mimetypes;
+    size_t length = strlen(format->mimetype);
+
+    /* Users lacking video support will have no video mimetypes */
+    if (mimetype == NULL)
+        return 0;
+
+    /* Mimetypes may be qualified with codecs, etc. */
+    while (*mimetype != NULL) {
+
+        if (strncmp(*mimetype, format->mimetype, length) == 0)
+            return 1;
+
+        mimetype++;
+
+    }
+
+    return 0;
+
+}
+
+/**
+ * Callback which is invoked by guac_common_video_select_format() for each
+ * connected user, narrowing down the set of acceptable video formats to those
+ * supported by every user.
+ *
+ * @param user
+ *     The user being tested.
+ *
+ * @param data
+ *     An array of flags, one for each entry in guac_common_video_formats,
+ *     which are non-zero if the corresponding format is still acceptable.
+ *
+ * @return
+ *     Always NULL.
+ */
+static void* guac_common_video_format_callback(guac_user* user, void* data) {
+
+    int* supported = (int*) data;
+    int i;
+
+    for (i = 0; guac_common_video_formats[i].mimetype != NULL; i++) {
+        if (supported[i])
+            supported[i] = guac_common_video_user_supports(user,
+                    &guac_common_video_formats[i]);
+    }
+
+    return NULL;
+
+}
+
+const guac_common_video_format* guac_common_video_select_format(
+        guac_client* client) {
+
+    int supported[sizeof(guac_common_video_formats)
+        / sizeof(guac_common_video_formats[0])];
+
+    int i;
+
+    /* Initially consider only those formats which can actually be encoded */
+    for (i = 0; guac_common_video_formats[i].mimetype != NULL; i++)
+        supported[i] = avcodec_find_encoder_by_name(
+                guac_common_video_formats[i].codec) != NULL;
+
+    /* Narrow down formats to those supported by all users */
+    guac_client_foreach_user(client, guac_common_video_format_callback,
+            supported);
+
+    /* Choose first remaining format */
+    for (i = 0; guac_common_video_formats[i].mimetype != NULL; i++) {
+        if (supported[i])
+            return &guac_common_video_formats[i];
+    }
+
+    /* No common format */
+    return NULL;
+
+}
+
+/**
+ * Sends the given data as blobs over the given Guacamole stream, splitting
+ * that data into chunks no larger than GUAC_COMMON_VIDEO_BLOB_SIZE.
+ *
+ * @param socket
+ *     The socket over which the blobs should be sent.
+ *
+ * @param stream
+ *     The stream which should receive the data.
+ *
+ * @param buf
+ *     The data to send.
+ *
+ * @param length
+ *     The number of bytes of data to send.
+ */
+static void guac_common_video_send_blobs(guac_socket* socket,
+        guac_stream* stream, const uint8_t* buf, int length) {
+
+    while (length > 0) {
+
+        int block_size = length;
+        if (block_size > GUAC_COMMON_VIDEO_BLOB_SIZE)
+            block_size = GUAC_COMMON_VIDEO_BLOB_SIZE;
+
+        guac_protocol_send_blob(socket, stream, buf, block_size);
+
+        buf += block_size;
+        length -= block_size;
+
+    }
+
+}
+
+/**
+ * Appends the given container data to the copy of the container header
+ * within the given video, growing that copy as necessary. If memory cannot
+ * be allocated, the copy is freed and set to NULL.
+ *
+ * @param video
+ *     The video whose container header is being written.
+ *
+ * @param buf
+ *     The container data to append.
+ *
+ * @param length
+ *     The number of bytes of container data to append.
+ */
+static void guac_common_video_capture_header(guac_common_video* video,
+        const uint8_t* buf, int length) {
+
+    /* Ignore remaining data if the copy has already failed */
+    if (video->header == NULL)
+        return;
+
+    /* Grow copy if necessary */
+    if (video->header_length + length > video->header_size) {
+
+        int size = video->header_size * 2;
+        while (size < video->header_length + length)
+            size *= 2;
+
+        unsigned char* header = realloc(video->header, size);
+        if (header == NULL) {
+            free(video->header);
+            video->header = NULL;
+            return;
+        }
+
+        video->header = header;
+        video->header_size = size;
+
+    }
+
+    memcpy(video->header + video->header_length, buf, length);
+    video->header_length += length;
+
+}
+
+/**
+ * Write callback for libavformat which sends the given container data as
+ * blobs over the Guacamole stream of the video.
+ *
+ * @param opaque
+ *     The guac_common_video associated with the container being written.
+ *
+ * @param buf
+ *     The container data to send.
+ *
+ * @param buf_size
+ *     The number of bytes of container data to send.
+ *
+ * @return
+ *     The number of bytes written, which will always be buf_size.
+ */
+static int guac_common_video_write_packet(void* opaque,
+        GUAC_AVIO_WRITE_DATA* buf, int buf_size) {
+
+    guac_common_video* video = (guac_common_video*) opaque;
+
+    /* Retain header for users that join later */
+    if (video->header_capturing)
+        guac_common_video_capture_header(video, buf, buf_size);
+
+    guac_common_video_send_blobs(video->socket, video->stream, buf, buf_size);
+    return buf_size;
+
+}
+
+/**
+ * Initializes the encoder and container of the given video, beginning a new
+ * Guacamole stream on the video's layer and sending the container header.
+ * All users currently connected receive the new stream from its start. The
+ * layer of the video must already have been allocated.
+ *
+ * @param video
+ *     The video whose encoder, container and stream should be initialized.
+ *
+ * @return
+ *     Zero if the video was initialized successfully, non-zero otherwise. If
+ *     initialization fails, guac_common_video_close() must still be invoked
+ *     to free any partially-initialized state.
+ */
+static int guac_common_video_open(guac_common_video* video) {
+
+    guac_client* client = video->client;
+    const guac_common_video_format* format = video->format;
+
+    AVDictionary* options = NULL;
+    unsigned char* avio_buffer;
+
+    /* Pull codec based on name */
+    const AVCodec* codec = avcodec_find_encoder_by_name(format->codec);
+    if (codec == NULL) {
+        guac_client_log(client, GUAC_LOG_DEBUG, "Video encoder \"%s\" is not "
+                "available.", format->codec);
+        return 1;
+    }
+
+    video->last_pts = -1;
+
+    /* Allocate container */
+    if (avformat_alloc_output_context2(&video->container, NULL,
+                format->container, NULL) < 0) {
+        guac_client_log(client, GUAC_LOG_DEBUG, "Video container \"%s\" is "
+                "not available.", format->container);
+        return 1;
+    }
+
+    /* Init encoder for low latency */
+    video->context = avcodec_alloc_context3(codec);
+    if (video->context == NULL)
+        return 1;
+
+    video->context->width = video->width;
+    video->context->height = video->height;
+    video->context->pix_fmt = AV_PIX_FMT_YUV420P;
+    video->context->time_base = (AVRational) { 1, 1000 };
+    video->context->bit_rate = (int64_t) video->width * video->height
+                             * GUAC_COMMON_VIDEO_BITS_PER_PIXEL;
+    video->context->gop_size = GUAC_COMMON_VIDEO_KEYFRAME_INTERVAL;
+    video->context->max_b_frames = 0;
+    video->context->thread_count = 1;
+
+    if (video->container->oformat->flags & AVFMT_GLOBALHEADER)
+        video->context->flags |= AV_CODEC_FLAG_GLOBAL_HEADER;
+
+    /* Open codec with encoder-specific tuning */
+    av_dict_parse_string(&options, format->codec_options, "=", ":", 0);
+    if (avcodec_open2(video->context, codec, &options) < 0) {
+        guac_client_log(client, GUAC_LOG_WARNING, "Unable to open video "
+                "encoder \"%s\".", format->codec);
+        av_dict_free(&options);
+        return 1;
+    }
+
+    av_dict_free(&options);
+
+    /* Add video to container */
+    video->container_stream = avformat_new_stream(video->container, NULL);
+    if (video->container_stream == NULL)
+        return 1;
+
+    video->container_stream->time_base = video->context->time_base;
+    if (avcodec_parameters_from_context(video->container_stream->codecpar,
+                video->context) < 0)
+        return 1;
+
+    /* Route all container output through the Guacamole stream */
+    avio_buffer = av_malloc(GUAC_COMMON_VIDEO_BLOB_SIZE);
+    if (avio_buffer == NULL)
+        return 1;
+
+    video->container->pb = avio_alloc_context(avio_buffer,
+            GUAC_COMMON_VIDEO_BLOB_SIZE, 1, video, NULL,
+            guac_common_video_write_packet, NULL);
+
+    if (video->container->pb == NULL) {
+        av_free(avio_buffer);
+        return 1;
+    }
+
+    /* Allocate reusable frame and packet */
+    video->frame = av_frame_alloc();
+    video->packet = av_packet_alloc();
+    if (video->frame == NULL || video->packet == NULL)
+        return 1;
+
+    video->frame->format = video->context->pix_fmt;
+    video->frame->width = video->width;
+    video->frame->height = video->height;
+    if (av_frame_get_buffer(video->frame, 32) < 0)
+        return 1;
+
+    /* Cairo RGB24 is native-endian 32-bit xRGB */
+    video->sws = sws_getContext(video->width, video->height, AV_PIX_FMT_RGB32,
+            video->width, video->height, AV_PIX_FMT_YUV420P, SWS_FAST_BILINEAR,
+            NULL, NULL, NULL);
+    if (video->sws == NULL)
+        return 1;
+
+    /* Begin stream */
+    video->stream = guac_client_alloc_stream(client);
+    guac_protocol_send_video(video->socket, video->stream, video->layer,
+            format->mimetype);
+
+    /* Send container header, retaining a copy for users that join later */
+    video->header = malloc(GUAC_COMMON_VIDEO_BLOB_SIZE);
+    video->header_size = GUAC_COMMON_VIDEO_BLOB_SIZE;
+    video->header_capturing = 1;
+
+    av_dict_parse_string(&options, format->container_options, "=", ":", 0);
+    if (avformat_write_header(video->container, &options) < 0) {
+        guac_client_log(client, GUAC_LOG_WARNING, "Unable to write header of "
+                "video container \"%s\".", format->container);
+        av_dict_free(&options);
+        return 1;
+    }
+
+    av_dict_free(&options);
+    avio_flush(video->container->pb);
+    video->header_capturing = 0;
+
+    video->header_written = 1;
+    video->start = guac_timestamp_current();
+
+    return 0;
+
+}
+
+/**
+ * Ends the Guacamole stream of the given video, finishing its container and
+ * freeing its encoder and container. The layer of the video is left intact.
+ * This function may safely be invoked on a partially-initialized video.
+ *
+ * @param video
+ *     The video whose stream, encoder and container should be freed.
+ */
+static void guac_common_video_close(guac_common_video* video) {
+
+    /* Finish container only if actually started */
+    if (video->header_written) {
+        av_write_trailer(video->container);
+        avio_flush(video->container->pb);
+        video->header_written = 0;
+    }
+
+    /* End stream */
+    if (video->stream != NULL) {
+        guac_protocol_send_end(video->socket, video->stream);
+        guac_client_free_stream(video->client, video->stream);
+        video->stream = NULL;
+    }
+
+    /* Free container and associated I/O context */
+    if (video->container != NULL) {
+        if (video->container->pb != NULL) {
+            av_freep(&video->container->pb->buffer);
+            avio_context_free(&video->container->pb);
+        }
+        avformat_free_context(video->container);
+        video->container = NULL;
+    }
+
+    sws_freeContext(video->sws);
+    video->sws = NULL;
+
+    av_packet_free(&video->packet);
+    av_frame_free(&video->frame);
+    avcodec_free_context(&video->context);
+
+}
+
+guac_common_video* guac_common_video_alloc(guac_client* client,
+        guac_socket* socket, const guac_layer* parent,
+        const guac_common_video_format* format,
+        int x, int y, int width, int height) {
+
+    guac_common_video* video = calloc(1, sizeof(guac_common_video));
+    video->client = client;
+    video->socket = socket;
+    video->format = format;
+    video->parent = parent;
+    video->x = x;
+    video->y = y;
+    video->width = width;
+    video->height = height;
+
+    /* Allocate layer, positioned over the region being streamed */
+    video->layer = guac_client_alloc_layer(client);
+    guac_protocol_send_move(socket, video->layer, parent, x, y, 0);
+    guac_protocol_send_size(socket, video->layer, width, height);
+
+    if (guac_common_video_open(video)) {
+        guac_common_video_free(video);
+        return NULL;
+    }
+
+    guac_client_log(client, GUAC_LOG_DEBUG, "Streaming %ix%i region at "
+            "(%i, %i) as \"%s\" video.", width, height, x, y,
+            format->mimetype);
+
+    return video;
+
+}
+
+int guac_common_video_dup(guac_common_video* video, guac_user* user,
+        guac_socket* socket) {
+
+    guac_common_video_joiner* joiner;
+
+    /* The user cannot join a stream in a format they do not support, nor
+     * without the container header */
+    if (!guac_common_video_user_supports(user, video->format)
+            || video->header == NULL)
+        return 1;
+
+    /* Sync layer only. The user will receive the video itself beginning with
+     * the next keyframe. */
+    guac_protocol_send_move(socket, video->layer, video->parent,
+            video->x, video->y, 0);
+    guac_protocol_send_size(socket, video->layer,
+            video->width, video->height);
+
+    /* Ignore users which are already waiting for the next keyframe */
+    for (joiner = video->joiners; joiner != NULL; joiner = joiner->next) {
+        if (joiner->user == user)
+            return 0;
+    }
+
+    joiner = malloc(sizeof(guac_common_video_joiner));
+    if (joiner == NULL)
+        return 1;
+
+    joiner->user = user;
+    joiner->next = video->joiners;
+    video->joiners = joiner;
+
+    /* Avoid making the user wait for the next periodic keyframe */
+    video->keyframe_pending = 1;
+
+    return 0;
+
+}
+
+/**
+ * Callback for guac_client_for_user() which begins the video stream for a
+ * user that joined while that stream was in progress, sending the "video"
+ * instruction for the existing stream followed by the container header. All
+ * further stream data is received by the user over the broadcast socket,
+ * like all other users.
+ *
+ * @param user
+ *     The joining user, or NULL if that user is not currently connected.
+ *
+ * @param data
+ *     The guac_common_video that the user should receive.
+ *
+ * @return
+ *     The given user if the video stream was begun for that user, NULL if the
+ *     user is not currently connected.
+ */
+static void* guac_common_video_join_callback(guac_user* user, void* data) {
+
+    guac_common_video* video = (guac_common_video*) data;
+
+    if (user == NULL)
+        return NULL;
+
+    guac_protocol_send_video(user->socket, video->stream, video->layer,
+            video->format->mimetype);
+    guac_common_video_send_blobs(user->socket, video->stream,
+            video->header, video->header_length);
+
+    return user;
+
+}
+
+/**
+ * Begins the video stream for all users that are waiting for the next
+ * keyframe. This function must be invoked immediately before the packet
+ * containing that keyframe is written to the container. Any data still
+ * buffered by the container is first written out, such that the data
+ * following the header sent to waiting users begins with the keyframe.
+ * Users that are not yet connected (they may still be joining) continue
+ * waiting for a later keyframe.
+ *
+ * @param video
+ *     The video stream whose waiting users should begin receiving it.
+ */
+static void guac_common_video_join(guac_common_video* video) {
+
+    guac_common_video_joiner** current = &video->joiners;
+
+    /* End the current cluster or fragment (both formats allow flushing) */
+    av_write_frame(video->container, NULL);
+    avio_flush(video->container->pb);
+
+    /* Older stream data must not reach users after they begin the stream */
+    guac_socket_flush(video->socket);
+
+    while (*current != NULL) {
+
+        guac_common_video_joiner* joiner = *current;
+
+        /* Remove users only once they have received the header */
+        if (guac_client_for_user(video->client, joiner->user,
+                    guac_common_video_join_callback, video) != NULL) {
+            *current = joiner->next;
+            free(joiner);
+        }
+
+        else
+            current = &joiner->next;
+
+    }
+
+}
+
+int guac_common_video_write_frame(guac_common_video* video,
+        const unsigned char* buffer, int stride) {
+
+    const uint8_t* src[] = { buffer };
+    const int src_stride[] = { stride };
+
+    /* The encoder may still hold a reference to the previous frame */
+    if (av_frame_make_writable(video->frame) < 0)
+        return 1;
+
+    /* Convert to YUV */
+    sws_scale(video->sws, src, src_stride, 0, video->height,
+            video->frame->data, video->frame->linesize);
+
+    /* Timestamps are in milliseconds and must strictly increase */
+    int64_t pts = guac_timestamp_current() - video->start;
+    if (pts <= video->last_pts)
+        pts = video->last_pts + 1;
+
+    video->frame->pts = video->last_pts = pts;
+
+    /* Force a keyframe if users are waiting to join */
+    if (video->keyframe_pending) {
+        video->frame->pict_type = AV_PICTURE_TYPE_I;
+        video->keyframe_pending = 0;
+    }
+    else
+        video->frame->pict_type = AV_PICTURE_TYPE_NONE;
+
+    /* Encode frame */
+    if (avcodec_send_frame(video->context, video->frame) < 0) {
+        guac_client_log(video->client, GUAC_LOG_DEBUG, "Unable to encode "
+                "frame of video.");
+        return 1;
+    }
+
+    /* Write any resulting packets to the container */
+    while (avcodec_receive_packet(video->context, video->packet) == 0) {
+
+        av_packet_rescale_ts(video->packet, video->context->time_base,
+                video->container_stream->time_base);
+        video->packet->stream_index = video->container_stream->index;
+
+        /* Waiting users can begin decoding at any keyframe */
+        if (video->joiners != NULL
+                && (video->packet->flags & AV_PKT_FLAG_KEY))
+            guac_common_video_join(video);
+
+        av_write_frame(video->container, video->packet);
+        av_packet_unref(video->packet);
+
+    }
+
+    /* Send all data for the frame immediately */
+    avio_flush(video->container->pb);
+    return 0;
+
+}
+
+void guac_common_video_free(guac_common_video* video) {
+
+    guac_common_video_joiner* joiner = video->joiners;
+
+    /* End stream and free encoder and container */
+    guac_common_video_close(video);
+
+    /* Users still waiting for a keyframe need not receive the video */
+    while (joiner != NULL) {
+        guac_common_video_joiner* next = joiner->next;
+        free(joiner);
+        joiner = next;
+    }
+
+    free(video->header);
+
+    /* Dispose of layer */
+    if (video->layer != NULL) {
+        guac_protocol_send_dispose(video->socket, video->layer);
+        guac_client_free_layer(video->client, video->layer);
+    }
+
+    free(video);
+
+}
@@ -0,0 +1,217 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef __GUAC_COMMON_VIDEO_H
+#define __GUAC_COMMON_VIDEO_H
+
+#include "config.h"
+
+#include <guacamole/client.h>
+#include <guacamole/layer.h>
+#include <guacamole/socket.h>
+#include <guacamole/user.h>
+
+/**
+ * The approximate number of bits per second to allocate to each pixel of
+ * streamed video. The bitrate of each video stream is derived from its
+ * dimensions using this value.
+ */
+#define GUAC_COMMON_VIDEO_BITS_PER_PIXEL 4
+
+/**
+ * The maximum number of frames between keyframes. Keyframes allow the client
+ * to recover from decoding errors, but are substantially larger than other
+ * frames.
+ */
+#define GUAC_COMMON_VIDEO_KEYFRAME_INTERVAL 120
+
+/**
+ * The maximum number of bytes of encoded video data to send within a single
+ * "blob" instruction.
+ */
+#define GUAC_COMMON_VIDEO_BLOB_SIZE 6048
+
+/**
+ * A combination of container format and codec which may be used to stream
+ * video, along with the mimetype which the client must support to play that
+ * video.
+ */
+typedef struct guac_common_video_format {
+
+    /**
+     * The mimetype of the video, as sent within the "video" instruction. Users
+     * are considered to support this format if any of their supported video
+     * mimetypes begins with this value.
+     */
+    const char* mimetype;
+
+    /**
+     * The name of the libavcodec encoder which should be used to encode the
+     * video.
+     */
+    const char* codec;
+
+    /**
+     * Encoder-specific options, in "key=value:key=value" format, which tune
+     * the encoder for low latency, CPU-only encoding.
+     */
+    const char* codec_options;
+
+    /**
+     * The short name of the libavformat container format which should contain
+     * the encoded video.
+     */
+    const char* container;
+
+    /**
+     * Container-specific options, in "key=value:key=value" format, which allow
+     * the container to be written as a stream, or NULL if no options are
+     * required.
+     */
+    const char* container_options;
+
+} guac_common_video_format;
+
+/**
+ * A single video stream, encoding a rectangular region of image data and
+ * playing it back on a dedicated layer. The internal structure of this stream
+ * is defined by guac_video.c, as it depends on libavcodec and libavformat.
+ */
+typedef struct guac_common_video guac_common_video;
+
+/**
+ * Returns the first video format which can be encoded by guacd and which is
+ * supported by all users currently connected to the given client. If no
+ * such format exists, NULL is returned, and updates must continue to be sent
+ * as images.
+ *
+ * @param client
+ *     The client whose users must support the returned format.
+ *
+ * @return
+ *     A video format supported by all users of the given client, or NULL if
+ *     no such format exists.
+ */
+const guac_common_video_format* guac_common_video_select_format(
+        guac_client* client);
+
+/**
+ * Allocates a new video stream which will play back on a newly-allocated
+ * layer, positioned at the given coordinates relative to the given parent
+ * layer. The "video" instruction and the header of the video container are
+ * sent immediately.
+ *
+ * @param client
+ *     The client associated with the parent layer.
+ *
+ * @param socket
+ *     The socket over which all video data should be sent.
+ *
+ * @param parent
+ *     The layer which should contain the layer playing the video.
+ *
+ * @param format
+ *     The format of the video, as returned by
+ *     guac_common_video_select_format().
+ *
+ * @param x
+ *     The X coordinate of the upper-left corner of the video, relative to
+ *     the parent layer.
+ *
+ * @param y
+ *     The Y coordinate of the upper-left corner of the video, relative to
+ *     the parent layer.
+ *
+ * @param width
+ *     The width of the video, in pixels. This must be a multiple of two.
+ *
+ * @param height
+ *     The height of the video, in pixels. This must be a multiple of two.
+ *
+ * @return
+ *     A newly-allocated video stream, or NULL if the encoder or container
+ *     could not be initialized.
+ */
+guac_common_video* guac_common_video_alloc(guac_client* client,
+        guac_socket* socket, const guac_layer* parent,
+        const guac_common_video_format* format,
+        int x, int y, int width, int height);
+
+/**
+ * Prepares the given user, who has just joined the connection, to receive
+ * the given video stream. The layer playing the video is sent to the user
+ * immediately. As the user cannot begin decoding a stream which is already
+ * in progress, the next frame written is encoded as a keyframe, and the user
+ * receives the stream from that keyframe onward, preceded by the header of
+ * the video container. The stream is not restarted, and other users are
+ * unaffected beyond receiving that keyframe.
+ *
+ * @param video
+ *     The video stream that the user should receive.
+ *
+ * @param user
+ *     The user joining the connection.
+ *
+ * @param socket
+ *     The socket over which the layer should be sent to the user.
+ *
+ * @return
+ *     Zero if the user has been sent the layer of the given video and will
+ *     receive its stream from the next keyframe, non-zero if the user cannot
+ *     receive the video stream, such as when the user does not support its
+ *     format. If the user cannot receive the video stream, that stream must
+ *     be ended.
+ */
+int guac_common_video_dup(guac_common_video* video, guac_user* user,
+        guac_socket* socket);
+
+/**
+ * Encodes a new frame of video from the given image data, sending any
+ * resulting encoded data as blobs over the video stream.
+ *
+ * @param video
+ *     The video stream to write to.
+ *
+ * @param buffer
+ *     The image data of the frame, in Cairo's CAIRO_FORMAT_RGB24 format,
+ *     beginning at the upper-left corner of the video region. The dimensions
+ *     of this data must match the dimensions of the video.
+ *
+ * @param stride
+ *     The number of bytes in each row of image data.
+ *
+ * @return
+ *     Zero if the frame was encoded successfully, non-zero otherwise.
+ */
+int guac_common_video_write_frame(guac_common_video* video,
+        const unsigned char* buffer, int stride);
+
+/**
+ * Ends the given video stream, disposing of the layer playing the video and
+ * freeing all associated resources. The area of the parent layer previously
+ * covered by the video will be visible once again, and must be updated
+ * separately if its contents are out of date.
+ *
+ * @param video
+ *     The video stream to free.
+ */
+void guac_common_video_free(guac_common_video* video);
+
+#endif
+
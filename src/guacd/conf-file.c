@@ -25,6 +25,7 @@
 #include <guacamole/client.h>
 
 #include <errno.h>
+#include <limits.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -34,6 +35,37 @@
 #include <sys/stat.h>
 #include <fcntl.h>
 
+/**
+ * Parses the given string as a strictly positive integer, storing the result
+ * in the given int.
+ *
+ * @param value
+ *     The string to parse.
+ *
+ * @param result
+ *     A pointer to the int which should receive the parsed value. This int is
+ *     only modified if parsing succeeds.
+ *
+ * @return
+ *     Zero if the value was parsed successfully, non-zero if the value is not
+ *     a positive integer.
+ */
+static int guacd_conf_parse_positive_int(const char* value, int* result) {
+
+    char* end;
+
+    errno = 0;
+    long parsed = strtol(value, &end, 10);
+
+    /* Reject trailing garbage, overflow, and non-positive values */
+    if (errno != 0 || *end != '\0' || parsed <= 0 || parsed > INT_MAX)
+        return 1;
+
+    *result = (int) parsed;
+    return 0;
+
+}
+
 /**
  * Updates the configuration with the given parameter/value pair, flagging
  * errors as necessary.
@@ -59,6 +91,30 @@ static int guacd_conf_callback(const char* section, const char* param, const cha
             return 0;
         }
 
+        /* Listen backlog */
+        else if (strcmp(param, "listen_backlog") == 0) {
+
+            if (guacd_conf_parse_positive_int(value, &config->listen_backlog)) {
+                guacd_conf_parse_error = "The listen backlog must be a positive integer.";
+                return 1;
+            }
+
+            return 0;
+
+        }
+
+        /* Number of acceptor threads */
+        else if (strcmp(param, "acceptor_threads") == 0) {
+
+            if (guacd_conf_parse_positive_int(value, &config->acceptor_threads)) {
+                guacd_conf_parse_error = "The number of acceptor threads must be a positive integer.";
+                return 1;
+            }
+
+            return 0;
+
+        }
+
     }
 
     /* Options related to daemon startup */
@@ -88,6 +144,23 @@ static int guacd_conf_callback(const char* section, const char* param, const cha
 
         }
 
+        /* Log format */
+        else if (strcmp(param, "log_format") == 0) {
+
+            int format = guacd_parse_log_format(value);
+
+            /* Invalid log format */
+            if (format < 0) {
+                guacd_conf_parse_error = "Invalid log format. Valid formats are: \"text\" and \"json\".";
+                return 1;
+            }
+
+            /* Valid log format */
+            config->log_format = format;
+            return 0;
+
+        }
+
     }
 
     /* SSL-specific options */
@@ -177,9 +250,12 @@ guacd_config* guacd_conf_load() {
     /* Load defaults */
     conf->bind_host = NULL;
     conf->bind_port = strdup("4822");
+    conf->listen_backlog = GUACD_DEFAULT_LISTEN_BACKLOG;
+    conf->acceptor_threads = 1;
     conf->pidfile = NULL;
     conf->foreground = 0;
     conf->max_log_level = GUAC_LOG_INFO;
+    conf->log_format = GUACD_LOG_FORMAT_TEXT;
 
 #ifdef ENABLE_SSL
     conf->cert_file = NULL;
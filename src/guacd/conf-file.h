@@ -21,9 +21,17 @@
 #define _GUACD_CONF_FILE_H
 
 #include "config.h"
+#include "log.h"
 
 #include <guacamole/client.h>
 
+/**
+ * The default maximum number of pending connections which may be queued on
+ * each listening socket, if not overridden by guacd.conf. Logon storms can
+ * easily exceed a shallow backlog, resulting in refused connections.
+ */
+#define GUACD_DEFAULT_LISTEN_BACKLOG 1024
+
 /**
  * The contents of a guacd configuration file.
  */
@@ -39,6 +47,20 @@ typedef struct guacd_config {
      */
     char* bind_port;
 
+    /**
+     * The maximum number of pending connections which may be queued by the
+     * kernel on each listening socket before further connections are refused.
+     */
+    int listen_backlog;
+
+    /**
+     * The number of threads which should accept new connections. If
+     * SO_REUSEPORT is supported, each thread will accept connections on its
+     * own listening socket, allowing the kernel to distribute inbound
+     * connections between them.
+     */
+    int acceptor_threads;
+
     /**
      * The file to write the PID in, if any.
      */
@@ -66,6 +88,11 @@ typedef struct guacd_config {
      */
     guac_client_log_level max_log_level;
 
+    /**
+     * The format in which guacd should write log messages.
+     */
+    guacd_log_format log_format;
+
 } guacd_config;
 
 /**
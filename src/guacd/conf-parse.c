@@ -20,6 +20,7 @@
 #include "config.h"
 
 #include "conf-parse.h"
+#include "log.h"
 
 #include <guacamole/client.h>
 
@@ -533,3 +534,14 @@ int guacd_parse_log_level(const char* name) {
 
 }
 
+int guacd_parse_log_format(const char* name) {
+
+    /* Translate log format name */
+    if (strcmp(name, "text") == 0) return GUACD_LOG_FORMAT_TEXT;
+    if (strcmp(name, "json") == 0) return GUACD_LOG_FORMAT_JSON;
+
+    /* No such log format */
+    return -1;
+
+}
+
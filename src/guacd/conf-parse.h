@@ -53,6 +53,12 @@ int guacd_parse_conf(guacd_param_callback* callback, char* buffer, int length, v
  */
 int guacd_parse_log_level(const char* name);
 
+/**
+ * Parses the given log format name, returning the corresponding
+ * guacd_log_format, or -1 if no such log format exists.
+ */
+int guacd_parse_log_format(const char* name);
+
 /**
  * Human-readable description of the current error, if any.
  */
@@ -44,7 +44,9 @@
 #include <string.h>
 #include <sys/types.h>
 #include <sys/socket.h>
+#include <sys/time.h>
 #include <sys/wait.h>
+#include <unistd.h>
 
 /**
  * Behaves exactly as write(), but writes as much as possible, returning
@@ -359,6 +361,34 @@ static int guacd_route_connection(guacd_proc_map* map, guac_socket* socket) {
 
 }
 
+#ifdef ENABLE_SSL
+/**
+ * Sets the receive and send timeouts of the given file descriptor, such that
+ * blocking reads and writes performed outside of guac_socket_select() (such
+ * as those made by SSL_accept()) will fail rather than block indefinitely.
+ *
+ * @param fd
+ *     The file descriptor whose timeouts should be set.
+ *
+ * @param msecs
+ *     The timeout to apply to both reads and writes, in milliseconds, or zero
+ *     to restore the default behavior of blocking indefinitely.
+ */
+static void guacd_set_io_timeout(int fd, int msecs) {
+
+    struct timeval timeout = {
+        .tv_sec  = msecs / 1000,
+        .tv_usec = (msecs % 1000) * 1000
+    };
+
+    if (setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout))
+            || setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout)))
+        guacd_log(GUAC_LOG_DEBUG, "Unable to set socket timeout: %s",
+                strerror(errno));
+
+}
+#endif
+
 void* guacd_connection_thread(void* data) {
 
     guacd_connection_thread_params* params = (guacd_connection_thread_params*) data;
@@ -374,12 +404,21 @@ void* guacd_connection_thread(void* data) {
 
     /* If SSL chosen, use it */
     if (ssl_context != NULL) {
+
+        /* Do not allow a stalled client to hold its TLS handshake open */
+        guacd_set_io_timeout(connected_socket_fd, GUACD_TIMEOUT);
+
         socket = guac_socket_open_secure(ssl_context, connected_socket_fd);
         if (socket == NULL) {
             guacd_log_guac_error(GUAC_LOG_ERROR, "Unable to set up SSL/TLS");
+            close(connected_socket_fd);
             free(params);
             return NULL;
         }
+
+        /* Remaining handshake phases are bounded by GUACD_USEC_TIMEOUT */
+        guacd_set_io_timeout(connected_socket_fd, 0);
+
     }
     else
         socket = guac_socket_open(connected_socket_fd);
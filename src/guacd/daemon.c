@@ -19,6 +19,11 @@
 
 #include "config.h"
 
+/* accept4() is only declared if GNU extensions are enabled */
+#ifdef HAVE_ACCEPT4
+#define _GNU_SOURCE
+#endif
+
 #include "connection.h"
 #include "conf-args.h"
 #include "conf-file.h"
@@ -35,6 +40,7 @@
 #include <libgen.h>
 #include <netdb.h>
 #include <netinet/in.h>
+#include <pthread.h>
 #include <signal.h>
 #include <stdio.h>
 #include <stdlib.h>
@@ -152,65 +158,83 @@ static int daemonize() {
 
 }
 
-int main(int argc, char* argv[]) {
+/**
+ * Parameters required by each acceptor thread.
+ */
+typedef struct guacd_acceptor_params {
 
-    /* Server */
+    /**
+     * The listening socket from which connections should be accepted. This
+     * socket may be shared with other acceptor threads if SO_REUSEPORT is not
+     * in use.
+     */
     int socket_fd;
-    struct addrinfo* addresses;
-    struct addrinfo* current_address;
-    char bound_address[1024];
-    char bound_port[64];
-    int opt_on = 1;
-
-    struct addrinfo hints = {
-        .ai_family   = AF_UNSPEC,
-        .ai_socktype = SOCK_STREAM,
-        .ai_protocol = IPPROTO_TCP
-    };
 
-    /* Client */
-    struct sockaddr_in client_addr;
-    socklen_t client_addr_len;
-    int connected_socket_fd;
+    /**
+     * The shared map of all connected clients.
+     */
+    guacd_proc_map* map;
 
 #ifdef ENABLE_SSL
-    SSL_CTX* ssl_context = NULL;
+    /**
+     * SSL context for encrypted connections to guacd. If SSL is not active,
+     * this will be NULL.
+     */
+    SSL_CTX* ssl_context;
 #endif
 
-    guacd_proc_map* map = guacd_proc_map_alloc();
-
-    /* General */
-    int retval;
-
-    /* Load configuration */
-    guacd_config* config = guacd_conf_load();
-    if (config == NULL || guacd_conf_parse_args(config, argc, argv))
-       exit(EXIT_FAILURE);
-
-    /* Init logging as early as possible */
-    guacd_log_level = config->max_log_level;
-    openlog(GUACD_LOG_NAME, LOG_PID, LOG_DAEMON);
-
-    /* Log start */
-    guacd_log(GUAC_LOG_INFO, "Guacamole proxy daemon (guacd) version " VERSION " started");
-
-    /* Get addresses for binding */
-    if ((retval = getaddrinfo(config->bind_host, config->bind_port,
-                    &hints, &addresses))) {
+} guacd_acceptor_params;
 
-        guacd_log(GUAC_LOG_ERROR, "Error parsing given address or port: %s",
-                gai_strerror(retval));
-        exit(EXIT_FAILURE);
+/**
+ * Creates a new socket and binds it to the first of the given addresses which
+ * succeeds. The address and port that the socket was ultimately bound to are
+ * stored within the provided buffers.
+ *
+ * @param addresses
+ *     The list of addresses to attempt binding to, in order, as returned by
+ *     getaddrinfo().
+ *
+ * @param reuse_port
+ *     Non-zero if SO_REUSEPORT should be set on the socket prior to binding,
+ *     such that multiple sockets may be bound to the same address and port,
+ *     zero otherwise.
+ *
+ * @param bound_address
+ *     The buffer which should receive the numeric host of the address that
+ *     the socket was bound to.
+ *
+ * @param bound_address_length
+ *     The size of the bound_address buffer, in bytes.
+ *
+ * @param bound_port
+ *     The buffer which should receive the numeric port that the socket was
+ *     bound to.
+ *
+ * @param bound_port_length
+ *     The size of the bound_port buffer, in bytes.
+ *
+ * @return
+ *     The file descriptor of the newly-bound socket, or -1 if the socket
+ *     could not be created or bound to any of the given addresses.
+ */
+static int guacd_bind_socket(struct addrinfo* addresses, int reuse_port,
+        char* bound_address, int bound_address_length,
+        char* bound_port, int bound_port_length) {
 
-    }
+    struct addrinfo* current_address;
+    int opt_on = 1;
 
     /* Get socket */
-    socket_fd = socket(AF_INET, SOCK_STREAM, 0);
+    int socket_fd = socket(AF_INET, SOCK_STREAM, 0);
     if (socket_fd < 0) {
         guacd_log(GUAC_LOG_ERROR, "Error opening socket: %s", strerror(errno));
-        exit(EXIT_FAILURE);
+        return -1;
     }
 
+    /* The listening socket must not be inherited by executed programs
+     * (forked client processes close it explicitly) */
+    fcntl(socket_fd, F_SETFD, FD_CLOEXEC);
+
     /* Allow socket reuse */
     if (setsockopt(socket_fd, SOL_SOCKET, SO_REUSEADDR,
                 (void*) &opt_on, sizeof(opt_on))) {
@@ -218,6 +242,17 @@ int main(int argc, char* argv[]) {
                 strerror(errno));
     }
 
+#ifdef SO_REUSEPORT
+    /* Allow other acceptors to bind to the same address and port */
+    if (reuse_port && setsockopt(socket_fd, SOL_SOCKET, SO_REUSEPORT,
+                (void*) &opt_on, sizeof(opt_on))) {
+        guacd_log(GUAC_LOG_ERROR, "Unable to set socket options for port "
+                "reuse: %s", strerror(errno));
+        close(socket_fd);
+        return -1;
+    }
+#endif
+
     /* Attempt binding of each address until success */
     current_address = addresses;
     while (current_address != NULL) {
@@ -227,8 +262,8 @@ int main(int argc, char* argv[]) {
         /* Resolve hostname */
         if ((retval = getnameinfo(current_address->ai_addr,
                 current_address->ai_addrlen,
-                bound_address, sizeof(bound_address),
-                bound_port, sizeof(bound_port),
+                bound_address, bound_address_length,
+                bound_port, bound_port_length,
                 NI_NUMERICHOST | NI_NUMERICSERV)))
             guacd_log(GUAC_LOG_ERROR, "Unable to resolve host: %s",
                     gai_strerror(retval));
@@ -242,7 +277,7 @@ int main(int argc, char* argv[]) {
                     "host %s, port %s", bound_address, bound_port);
 
             /* Done if successful bind */
-            break;
+            return socket_fd;
 
         }
 
@@ -256,10 +291,190 @@ int main(int argc, char* argv[]) {
 
     }
 
-    /* If unable to bind to anything, fail */
-    if (current_address == NULL) {
-        guacd_log(GUAC_LOG_ERROR, "Unable to bind socket to any addresses.");
+    /* Unable to bind to anything */
+    close(socket_fd);
+    return -1;
+
+}
+
+/**
+ * Accepts a single pending connection on the given listening socket. The
+ * returned file descriptor will be marked close-on-exec, such that it is not
+ * leaked into any program executed by guacd or its client plugins. This does
+ * not affect processes which are merely forked; such processes must close
+ * inherited descriptors themselves (see guacd_create_proc()). The file
+ * descriptor will be in blocking mode, as is expected by guac_socket_open().
+ *
+ * @param socket_fd
+ *     The listening socket to accept a connection from.
+ *
+ * @return
+ *     The file descriptor of the newly-accepted connection, or a negative
+ *     value if an error occurs.
+ */
+static int guacd_accept(int socket_fd) {
+
+    struct sockaddr_in client_addr;
+    socklen_t client_addr_len = sizeof(client_addr);
+
+#ifdef HAVE_ACCEPT4
+    /* Atomically mark the new descriptor as close-on-exec */
+    return accept4(socket_fd, (struct sockaddr*) &client_addr,
+            &client_addr_len, SOCK_CLOEXEC);
+#else
+    int connected_socket_fd = accept(socket_fd,
+            (struct sockaddr*) &client_addr, &client_addr_len);
+
+    if (connected_socket_fd >= 0)
+        fcntl(connected_socket_fd, F_SETFD, FD_CLOEXEC);
+
+    return connected_socket_fd;
+#endif
+
+}
+
+/**
+ * Repeatedly accepts connections on the listening socket within the given
+ * guacd_acceptor_params, spawning a new connection thread for each. This
+ * function never returns. Any handshake performed for an accepted connection
+ * takes place within that connection's thread, and thus cannot delay the
+ * acceptance of further connections.
+ *
+ * @param data
+ *     A pointer to a guacd_acceptor_params structure describing the listening
+ *     socket, the shared map of connected clients, and the SSL context to use
+ *     for accepted connections (if any).
+ *
+ * @return
+ *     This function never returns.
+ */
+static void* guacd_acceptor_thread(void* data) {
+
+    guacd_acceptor_params* acceptor = (guacd_acceptor_params*) data;
+
+    for (;;) {
+
+        pthread_t child_thread;
+
+        /* Accept connection */
+        int connected_socket_fd = guacd_accept(acceptor->socket_fd);
+        if (connected_socket_fd < 0) {
+            guacd_log(GUAC_LOG_ERROR, "Could not accept client connection: %s", strerror(errno));
+            continue;
+        }
+
+        /* Create parameters for connection thread */
+        guacd_connection_thread_params* params = malloc(sizeof(guacd_connection_thread_params));
+        if (params == NULL) {
+            guacd_log(GUAC_LOG_ERROR, "Could not create connection thread: %s", strerror(errno));
+            close(connected_socket_fd);
+            continue;
+        }
+
+        params->map = acceptor->map;
+        params->connected_socket_fd = connected_socket_fd;
+
+#ifdef ENABLE_SSL
+        params->ssl_context = acceptor->ssl_context;
+#endif
+
+        /* Spawn thread to handle connection */
+        if (pthread_create(&child_thread, NULL, guacd_connection_thread, params)) {
+            guacd_log(GUAC_LOG_ERROR, "Could not create connection thread.");
+            close(connected_socket_fd);
+            free(params);
+            continue;
+        }
+
+        pthread_detach(child_thread);
+
+    }
+
+    return NULL;
+
+}
+
+int main(int argc, char* argv[]) {
+
+    /* Server */
+    int* socket_fds;
+    int socket_count;
+    struct addrinfo* addresses;
+    char bound_address[1024];
+    char bound_port[64];
+
+    struct addrinfo hints = {
+        .ai_family   = AF_UNSPEC,
+        .ai_socktype = SOCK_STREAM,
+        .ai_protocol = IPPROTO_TCP
+    };
+
+    /* Acceptors */
+    guacd_acceptor_params* acceptors;
+    int i;
+
+#ifdef ENABLE_SSL
+    SSL_CTX* ssl_context = NULL;
+#endif
+
+    guacd_proc_map* map = guacd_proc_map_alloc();
+
+    /* General */
+    int retval;
+
+    /* Load configuration */
+    guacd_config* config = guacd_conf_load();
+    if (config == NULL || guacd_conf_parse_args(config, argc, argv))
+       exit(EXIT_FAILURE);
+
+    /* Init logging as early as possible */
+    guacd_log_level = config->max_log_level;
+    guacd_log_output_format = config->log_format;
+    openlog(GUACD_LOG_NAME, LOG_PID, LOG_DAEMON);
+
+    /* Log start */
+    guacd_log(GUAC_LOG_INFO, "Guacamole proxy daemon (guacd) version " VERSION " started");
+
+    /* Get addresses for binding */
+    if ((retval = getaddrinfo(config->bind_host, config->bind_port,
+                    &hints, &addresses))) {
+
+        guacd_log(GUAC_LOG_ERROR, "Error parsing given address or port: %s",
+                gai_strerror(retval));
         exit(EXIT_FAILURE);
+
+    }
+
+    /* With SO_REUSEPORT, each acceptor gets its own listening socket */
+#ifdef SO_REUSEPORT
+    socket_count = config->acceptor_threads;
+#else
+    socket_count = 1;
+    if (config->acceptor_threads > 1)
+        guacd_log(GUAC_LOG_INFO, "SO_REUSEPORT is not supported on this "
+                "platform. All acceptor threads will share a single "
+                "listening socket.");
+#endif
+
+    socket_fds = malloc(sizeof(int) * socket_count);
+    if (socket_fds == NULL) {
+        guacd_log(GUAC_LOG_ERROR, "Unable to allocate listening sockets.");
+        exit(EXIT_FAILURE);
+    }
+
+    /* Bind each listening socket */
+    for (i = 0; i < socket_count; i++) {
+
+        socket_fds[i] = guacd_bind_socket(addresses, socket_count > 1,
+                bound_address, sizeof(bound_address),
+                bound_port, sizeof(bound_port));
+
+        /* If unable to bind to anything, fail */
+        if (socket_fds[i] < 0) {
+            guacd_log(GUAC_LOG_ERROR, "Unable to bind socket to any addresses.");
+            exit(EXIT_FAILURE);
+        }
+
     }
 
 #ifdef ENABLE_SSL
@@ -345,53 +560,63 @@ int main(int argc, char* argv[]) {
     freeaddrinfo(addresses);
 
     /* Listen for connections */
-    if (listen(socket_fd, 5) < 0) {
-        guacd_log(GUAC_LOG_ERROR, "Could not listen on socket: %s", strerror(errno));
+    for (i = 0; i < socket_count; i++) {
+        if (listen(socket_fds[i], config->listen_backlog) < 0) {
+            guacd_log(GUAC_LOG_ERROR, "Could not listen on socket: %s", strerror(errno));
+            return 3;
+        }
+    }
+
+    guacd_log(GUAC_LOG_DEBUG, "Accepting connections using %i thread(s) "
+            "and %i listening socket(s) with a backlog of %i.",
+            config->acceptor_threads, socket_count, config->listen_backlog);
+
+    acceptors = malloc(sizeof(guacd_acceptor_params) * config->acceptor_threads);
+    if (acceptors == NULL) {
+        guacd_log(GUAC_LOG_ERROR, "Unable to allocate acceptor threads.");
         return 3;
     }
 
-    /* Daemon loop */
-    for (;;) {
+    /* Start acceptor threads, distributing them across listening sockets */
+    for (i = 0; i < config->acceptor_threads; i++) {
 
-        pthread_t child_thread;
+        guacd_acceptor_params* acceptor = &(acceptors[i]);
+        acceptor->socket_fd = socket_fds[i % socket_count];
+        acceptor->map = map;
 
-        /* Accept connection */
-        client_addr_len = sizeof(client_addr);
-        connected_socket_fd = accept(socket_fd,
-                (struct sockaddr*) &client_addr, &client_addr_len);
+#ifdef ENABLE_SSL
+        acceptor->ssl_context = ssl_context;
+#endif
 
-        if (connected_socket_fd < 0) {
-            guacd_log(GUAC_LOG_ERROR, "Could not accept client connection: %s", strerror(errno));
-            continue;
-        }
+        /* The final acceptor runs within the main thread */
+        if (i == config->acceptor_threads - 1)
+            break;
 
-        /* Create parameters for connection thread */
-        guacd_connection_thread_params* params = malloc(sizeof(guacd_connection_thread_params));
-        if (params == NULL) {
-            guacd_log(GUAC_LOG_ERROR, "Could not create connection thread: %s", strerror(errno));
-            continue;
+        pthread_t acceptor_thread;
+        if (pthread_create(&acceptor_thread, NULL, guacd_acceptor_thread,
+                    acceptor)) {
+            guacd_log(GUAC_LOG_ERROR, "Could not create acceptor thread.");
+            return 3;
         }
 
-        params->map = map;
-        params->connected_socket_fd = connected_socket_fd;
+        pthread_detach(acceptor_thread);
 
-#ifdef ENABLE_SSL
-        params->ssl_context = ssl_context;
-#endif
+    }
 
-        /* Spawn thread to handle connection */
-        pthread_create(&child_thread, NULL, guacd_connection_thread, params);
-        pthread_detach(child_thread);
+    /* Daemon loop */
+    guacd_acceptor_thread(&(acceptors[config->acceptor_threads - 1]));
 
+    /* Close sockets */
+    for (i = 0; i < socket_count; i++) {
+        if (close(socket_fds[i]) < 0) {
+            guacd_log(GUAC_LOG_ERROR, "Could not close socket: %s", strerror(errno));
+            return 3;
+        }
     }
 
-    /* Close socket */
-    if (close(socket_fd) < 0) {
-        guacd_log(GUAC_LOG_ERROR, "Could not close socket: %s", strerror(errno));
-        return 3;
-    }
+    free(socket_fds);
+    free(acceptors);
 
     return 0;
 
 }
-
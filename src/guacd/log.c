@@ -22,70 +22,639 @@
 
 #include <guacamole/client.h>
 #include <guacamole/error.h>
+#include <guacamole/timestamp.h>
 
+#include <pthread.h>
+#include <semaphore.h>
 #include <stdarg.h>
+#include <stdint.h>
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 #include <syslog.h>
 #include <unistd.h>
 
 int guacd_log_level = GUAC_LOG_INFO;
 
-void vguacd_log(guac_client_log_level level, const char* format,
-        va_list args) {
+guacd_log_format guacd_log_output_format = GUACD_LOG_FORMAT_TEXT;
 
-    const char* priority_name;
-    int priority;
+/**
+ * A single queued log message.
+ */
+typedef struct guacd_log_entry {
+
+    /**
+     * The position within the queue at which this entry may next be written
+     * (if equal to that position) or read (if equal to that position plus
+     * one). This is the sequence number of a bounded multi-producer queue.
+     */
+    unsigned int sequence;
+
+    /**
+     * The level at which the message was logged.
+     */
+    guac_client_log_level level;
+
+    /**
+     * The ID of the connection that logged the message, or an empty string
+     * if the message is not associated with a connection.
+     */
+    char connection_id[GUACD_LOG_CONNECTION_ID_LENGTH];
+
+    /**
+     * The fully-formatted message.
+     */
+    char message[GUACD_LOG_MESSAGE_LENGTH];
+
+} guacd_log_entry;
+
+/**
+ * The rate limiting state of a single message site.
+ */
+typedef struct guacd_log_rate {
+
+    /**
+     * The format string identifying the message site.
+     */
+    const char* format;
+
+    /**
+     * The rate limiting window during which count was last reset, as a
+     * number of GUACD_LOG_RATE_INTERVAL intervals.
+     */
+    guac_timestamp window;
+
+    /**
+     * The number of messages logged from this site within the current
+     * window.
+     */
+    int count;
+
+    /**
+     * The number of messages suppressed since a message from this site was
+     * last logged.
+     */
+    int suppressed;
+
+} guacd_log_rate;
+
+/**
+ * The states of the background log thread.
+ */
+typedef enum guacd_log_state {
 
-    char message[2048];
+    /**
+     * The log thread has not yet been started within this process.
+     */
+    GUACD_LOG_STOPPED,
 
-    /* Don't bother if the log level is too high */
-    if (level > guacd_log_level)
-        return;
+    /**
+     * The log thread is currently being started by another thread.
+     */
+    GUACD_LOG_STARTING,
+
+    /**
+     * The log thread is running, and messages should be queued.
+     */
+    GUACD_LOG_RUNNING,
+
+    /**
+     * The log thread could not be started, and messages must be written
+     * synchronously.
+     */
+    GUACD_LOG_SYNCHRONOUS
+
+} guacd_log_state;
 
-    /* Copy log message into buffer */
-    vsnprintf(message, sizeof(message), format, args);
+/**
+ * Queue of messages awaiting output by the log thread.
+ */
+static guacd_log_entry guacd_log_queue[GUACD_LOG_QUEUE_SIZE];
+
+/**
+ * The position within guacd_log_queue at which the next message will be
+ * queued. Producers claim positions atomically.
+ */
+static unsigned int guacd_log_enqueue_position;
+
+/**
+ * The position within guacd_log_queue of the next message to be written.
+ * Guarded by guacd_log_output_lock.
+ */
+static unsigned int guacd_log_dequeue_position;
+
+/**
+ * The number of messages dropped because the queue was full.
+ */
+static int guacd_log_dropped;
+
+/**
+ * The current state of the log thread, as a guacd_log_state.
+ */
+static int guacd_log_thread_state = GUACD_LOG_STOPPED;
+
+/**
+ * Lock which serializes the consumers of the queue: the log thread, and any
+ * thread flushing the queue prior to fork() or exit().
+ */
+static pthread_mutex_t guacd_log_output_lock = PTHREAD_MUTEX_INITIALIZER;
+
+/**
+ * Semaphore signalled whenever a message is queued.
+ */
+static sem_t guacd_log_pending;
+
+/**
+ * Whether the fork() and exit() handlers have been registered. As these are
+ * inherited by child processes, they are registered only once.
+ */
+static int guacd_log_handlers_registered = 0;
+
+/**
+ * Rate limiting state for each message site.
+ */
+static guacd_log_rate guacd_log_rates[GUACD_LOG_RATE_SITES];
+
+/**
+ * Converts the given log level to the corresponding syslog priority and
+ * human-readable name.
+ *
+ * @param level
+ *     The log level to convert.
+ *
+ * @param priority_name
+ *     Pointer to the string which should receive the name of the level.
+ *
+ * @return
+ *     The syslog priority corresponding to the given level.
+ */
+static int guacd_log_priority(guac_client_log_level level,
+        const char** priority_name) {
 
     /* Convert log level to syslog priority */
     switch (level) {
 
         /* Error log level */
         case GUAC_LOG_ERROR:
-            priority = LOG_ERR;
-            priority_name = "ERROR";
-            break;
+            *priority_name = "ERROR";
+            return LOG_ERR;
 
         /* Warning log level */
         case GUAC_LOG_WARNING:
-            priority = LOG_WARNING;
-            priority_name = "WARNING";
-            break;
+            *priority_name = "WARNING";
+            return LOG_WARNING;
 
         /* Informational log level */
         case GUAC_LOG_INFO:
-            priority = LOG_INFO;
-            priority_name = "INFO";
-            break;
+            *priority_name = "INFO";
+            return LOG_INFO;
 
         /* Debug log level */
         case GUAC_LOG_DEBUG:
-            priority = LOG_DEBUG;
-            priority_name = "DEBUG";
-            break;
+            *priority_name = "DEBUG";
+            return LOG_DEBUG;
 
         /* Any unknown/undefined log level */
         default:
-            priority = LOG_INFO;
-            priority_name = "UNKNOWN";
+            *priority_name = "UNKNOWN";
+            return LOG_INFO;
+    }
+
+}
+
+/**
+ * Writes the given string to the given buffer as the contents of a JSON
+ * string (without surrounding quotes), escaping characters as required. The
+ * output is truncated if the buffer is too small, but always null-terminated.
+ *
+ * @param buffer
+ *     The buffer to write to.
+ *
+ * @param size
+ *     The size of the buffer, in bytes.
+ *
+ * @param str
+ *     The string to escape.
+ *
+ * @return
+ *     The number of bytes written, not including null terminator.
+ */
+static int guacd_log_json_escape(char* buffer, int size, const char* str) {
+
+    int length = 0;
+    for (; *str != '\0' && length < size - 7; str++) {
+
+        unsigned char c = (unsigned char) *str;
+
+        /* Escape quotes and backslashes */
+        if (c == '"' || c == '\\') {
+            buffer[length++] = '\\';
+            buffer[length++] = c;
+        }
+
+        /* Escape control characters numerically */
+        else if (c < 0x20)
+            length += sprintf(buffer + length, "\\u%04x", c);
+
+        else
+            buffer[length++] = c;
+
+    }
+
+    buffer[length] = '\0';
+    return length;
+
+}
+
+/**
+ * Writes the given message to syslog and STDERR in the configured format.
+ *
+ * @param level
+ *     The level at which the message was logged.
+ *
+ * @param connection_id
+ *     The ID of the connection that logged the message, or an empty string
+ *     if the message is not associated with a connection.
+ *
+ * @param message
+ *     The message to write.
+ */
+static void guacd_log_write(guac_client_log_level level,
+        const char* connection_id, const char* message) {
+
+    const char* priority_name;
+    int priority = guacd_log_priority(level, &priority_name);
+
+    /* Log human-readable text */
+    if (guacd_log_output_format == GUACD_LOG_FORMAT_TEXT) {
+
+        /* Log to syslog */
+        syslog(priority, "%s", message);
+
+        /* Log to STDERR */
+        fprintf(stderr, GUACD_LOG_NAME "[%i]: %s:\t%s\n",
+                getpid(), priority_name, message);
+
+        return;
+
+    }
+
+    /* Otherwise, log as JSON */
+    char escaped[GUACD_LOG_MESSAGE_LENGTH * 2];
+    guacd_log_json_escape(escaped, sizeof(escaped), message);
+
+    char json[sizeof(escaped) + GUACD_LOG_CONNECTION_ID_LENGTH + 128];
+    if (connection_id[0] != '\0')
+        snprintf(json, sizeof(json), "{\"level\":\"%s\",\"pid\":%i,"
+                "\"connection\":\"%s\",\"message\":\"%s\"}",
+                priority_name, getpid(), connection_id, escaped);
+    else
+        snprintf(json, sizeof(json), "{\"level\":\"%s\",\"pid\":%i,"
+                "\"message\":\"%s\"}",
+                priority_name, getpid(), escaped);
+
+    syslog(priority, "%s", json);
+    fprintf(stderr, "%s\n", json);
+
+}
+
+/**
+ * Writes all messages currently queued. The caller must hold
+ * guacd_log_output_lock.
+ */
+static void guacd_log_drain() {
+
+    for (;;) {
+
+        unsigned int position = guacd_log_dequeue_position;
+        guacd_log_entry* entry =
+            &guacd_log_queue[position & (GUACD_LOG_QUEUE_SIZE - 1)];
+
+        /* Stop if the next entry has not yet been completely queued */
+        if (__atomic_load_n(&(entry->sequence), __ATOMIC_ACQUIRE)
+                != position + 1)
             break;
+
+        guacd_log_write(entry->level, entry->connection_id, entry->message);
+
+        /* Release entry for reuse on the next pass through the queue */
+        __atomic_store_n(&(entry->sequence), position + GUACD_LOG_QUEUE_SIZE,
+                __ATOMIC_RELEASE);
+        guacd_log_dequeue_position = position + 1;
+
     }
 
-    /* Log to syslog */
-    syslog(priority, "%s", message);
+    /* Report any messages dropped due to a full queue */
+    int dropped = __atomic_exchange_n(&guacd_log_dropped, 0,
+            __ATOMIC_SEQ_CST);
+    if (dropped > 0) {
+        char message[128];
+        snprintf(message, sizeof(message), "%i log messages dropped "
+                "(logging could not keep up)", dropped);
+        guacd_log_write(GUAC_LOG_WARNING, "", message);
+    }
 
-    /* Log to STDERR */
-    fprintf(stderr, GUACD_LOG_NAME "[%i]: %s:\t%s\n",
-            getpid(), priority_name, message);
+}
 
+/**
+ * Writes all queued messages, waiting for any concurrent writes to finish.
+ * This function is invoked prior to exit() and fork(), such that queued
+ * messages are neither lost nor duplicated.
+ */
+static void guacd_log_flush() {
+    pthread_mutex_lock(&guacd_log_output_lock);
+    guacd_log_drain();
+    pthread_mutex_unlock(&guacd_log_output_lock);
+}
+
+/**
+ * Handler invoked in the parent process prior to fork(). Queued messages are
+ * written, and the queue is locked such that the child inherits it in a
+ * consistent, empty state.
+ */
+static void guacd_log_prepare_fork() {
+    pthread_mutex_lock(&guacd_log_output_lock);
+    guacd_log_drain();
+}
+
+/**
+ * Handler invoked in the parent process after fork().
+ */
+static void guacd_log_parent_fork() {
+    pthread_mutex_unlock(&guacd_log_output_lock);
+}
+
+/**
+ * Handler invoked in the child process after fork(). As the log thread does
+ * not exist within the child, it is restarted upon the next message.
+ */
+static void guacd_log_child_fork() {
+    pthread_mutex_unlock(&guacd_log_output_lock);
+    guacd_log_thread_state = GUACD_LOG_STOPPED;
+}
+
+/**
+ * The background log thread, writing queued messages as they arrive.
+ *
+ * @param data
+ *     Unused.
+ *
+ * @return
+ *     Always NULL.
+ */
+static void* guacd_log_thread(void* data) {
+
+    for (;;) {
+
+        /* Wait for messages */
+        if (sem_wait(&guacd_log_pending))
+            continue;
+
+        guacd_log_flush();
+
+    }
+
+    return NULL;
+
+}
+
+/**
+ * Starts the background log thread within the current process if not
+ * already running.
+ *
+ * @return
+ *     Non-zero if messages should be queued for the log thread, zero if they
+ *     must instead be written synchronously.
+ */
+static int guacd_log_start() {
+
+    int state = __atomic_load_n(&guacd_log_thread_state, __ATOMIC_ACQUIRE);
+    if (state == GUACD_LOG_RUNNING)
+        return 1;
+
+    /* Only one thread may start the log thread */
+    int expected = GUACD_LOG_STOPPED;
+    if (!__atomic_compare_exchange_n(&guacd_log_thread_state, &expected,
+                GUACD_LOG_STARTING, 0, __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST))
+        return 0;
+
+    /* Reset queue (any queued messages were flushed prior to fork()) */
+    int i;
+    for (i = 0; i < GUACD_LOG_QUEUE_SIZE; i++)
+        guacd_log_queue[i].sequence = i;
+
+    guacd_log_enqueue_position = 0;
+    guacd_log_dequeue_position = 0;
+
+    /* Ensure queued messages are not lost when the process changes */
+    if (!guacd_log_handlers_registered) {
+        pthread_atfork(guacd_log_prepare_fork, guacd_log_parent_fork,
+                guacd_log_child_fork);
+        atexit(guacd_log_flush);
+        guacd_log_handlers_registered = 1;
+    }
+
+    /* Start log thread, falling back to synchronous logging on failure */
+    pthread_t thread;
+    if (sem_init(&guacd_log_pending, 0, 0)
+            || pthread_create(&thread, NULL, guacd_log_thread, NULL)) {
+        __atomic_store_n(&guacd_log_thread_state, GUACD_LOG_SYNCHRONOUS,
+                __ATOMIC_RELEASE);
+        return 0;
+    }
+
+    pthread_detach(thread);
+    __atomic_store_n(&guacd_log_thread_state, GUACD_LOG_RUNNING,
+            __ATOMIC_RELEASE);
+    return 1;
+
+}
+
+/**
+ * Claims the next free entry within the queue, without waiting.
+ *
+ * @param position
+ *     Pointer to the unsigned int which should receive the queue position of
+ *     the claimed entry.
+ *
+ * @return
+ *     The claimed entry, or NULL if the queue is full.
+ */
+static guacd_log_entry* guacd_log_claim(unsigned int* position) {
+
+    unsigned int current = __atomic_load_n(&guacd_log_enqueue_position,
+            __ATOMIC_RELAXED);
+
+    for (;;) {
+
+        guacd_log_entry* entry =
+            &guacd_log_queue[current & (GUACD_LOG_QUEUE_SIZE - 1)];
+
+        int difference = (int) (__atomic_load_n(&(entry->sequence),
+                    __ATOMIC_ACQUIRE) - current);
+
+        /* Entry is free; attempt to claim it */
+        if (difference == 0) {
+            if (__atomic_compare_exchange_n(&guacd_log_enqueue_position,
+                        &current, current + 1, 1, __ATOMIC_RELAXED,
+                        __ATOMIC_RELAXED)) {
+                *position = current;
+                return entry;
+            }
+        }
+
+        /* Entry has not yet been written by the log thread; queue is full */
+        else if (difference < 0)
+            return NULL;
+
+        /* Entry claimed by another thread; retry with the latest position */
+        else
+            current = __atomic_load_n(&guacd_log_enqueue_position,
+                    __ATOMIC_RELAXED);
+
+    }
+
+}
+
+/**
+ * Applies the rate limit for the message site identified by the given format
+ * string.
+ *
+ * @param format
+ *     The format string of the message being logged.
+ *
+ * @param suppressed
+ *     Pointer to an int which should receive the number of messages from the
+ *     same site that were suppressed since the last message was logged.
+ *
+ * @return
+ *     Non-zero if the message should be logged, zero if it should be
+ *     suppressed.
+ */
+static int guacd_log_rate_check(const char* format, int* suppressed) {
+
+    /* Hash site address into bucket (format strings are typically literals
+     * unique to each site) */
+    uintptr_t hash = (uintptr_t) format;
+    hash ^= hash >> 12;
+    guacd_log_rate* rate = &guacd_log_rates[(hash >> 3)
+        % GUACD_LOG_RATE_SITES];
+
+    guac_timestamp window = guac_timestamp_current() / GUACD_LOG_RATE_INTERVAL;
+
+    /* Take over bucket for new sites, and reset counts for new windows.
+     * Races here only affect the precision of the limit. */
+    if (__atomic_load_n(&(rate->format), __ATOMIC_RELAXED) != format
+            || __atomic_load_n(&(rate->window), __ATOMIC_RELAXED) != window) {
+        __atomic_store_n(&(rate->format), format, __ATOMIC_RELAXED);
+        __atomic_store_n(&(rate->window), window, __ATOMIC_RELAXED);
+        __atomic_store_n(&(rate->count), 0, __ATOMIC_RELAXED);
+    }
+
+    /* Suppress messages beyond the limit for this window */
+    if (__atomic_add_fetch(&(rate->count), 1, __ATOMIC_RELAXED)
+            > GUACD_LOG_RATE_LIMIT) {
+        __atomic_add_fetch(&(rate->suppressed), 1, __ATOMIC_RELAXED);
+        return 0;
+    }
+
+    *suppressed = __atomic_exchange_n(&(rate->suppressed), 0,
+            __ATOMIC_RELAXED);
+    return 1;
+
+}
+
+/**
+ * Formats the given message, appending a count of suppressed messages if
+ * non-zero.
+ *
+ * @param buffer
+ *     The buffer which should receive the formatted message.
+ *
+ * @param format
+ *     The printf-style format of the message.
+ *
+ * @param args
+ *     The arguments to the format.
+ *
+ * @param suppressed
+ *     The number of similar messages which were suppressed.
+ */
+static void guacd_log_format_message(char* buffer, const char* format,
+        va_list args, int suppressed) {
+
+    int length = vsnprintf(buffer, GUACD_LOG_MESSAGE_LENGTH, format, args);
+
+    if (suppressed > 0 && length >= 0 && length < GUACD_LOG_MESSAGE_LENGTH)
+        snprintf(buffer + length, GUACD_LOG_MESSAGE_LENGTH - length,
+                " (%i similar messages suppressed)", suppressed);
+
+}
+
+/**
+ * Logs the given message, associating it with the given connection.
+ *
+ * @param connection_id
+ *     The ID of the connection logging the message, or NULL if the message
+ *     is not associated with a connection.
+ *
+ * @param level
+ *     The level at which the message should be logged.
+ *
+ * @param format
+ *     The printf-style format of the message.
+ *
+ * @param args
+ *     The arguments to the format.
+ */
+static void guacd_log_queue_message(const char* connection_id,
+        guac_client_log_level level, const char* format, va_list args) {
+
+    int suppressed = 0;
+
+    /* Don't bother if the log level is too high */
+    if (level > guacd_log_level)
+        return;
+
+    /* Drop messages in excess of the rate limit for their site */
+    if (!guacd_log_rate_check(format, &suppressed))
+        return;
+
+    if (connection_id == NULL)
+        connection_id = "";
+
+    /* Write synchronously if the log thread cannot be used */
+    if (!guacd_log_start()) {
+        char message[GUACD_LOG_MESSAGE_LENGTH];
+        guacd_log_format_message(message, format, args, suppressed);
+        guacd_log_write(level, connection_id, message);
+        return;
+    }
+
+    /* Claim entry within queue, dropping the message if full */
+    unsigned int position;
+    guacd_log_entry* entry = guacd_log_claim(&position);
+    if (entry == NULL) {
+        __atomic_add_fetch(&guacd_log_dropped, 1, __ATOMIC_RELAXED);
+        return;
+    }
+
+    /* Format message directly into queue */
+    entry->level = level;
+    strncpy(entry->connection_id, connection_id,
+            GUACD_LOG_CONNECTION_ID_LENGTH - 1);
+    entry->connection_id[GUACD_LOG_CONNECTION_ID_LENGTH - 1] = '\0';
+    guacd_log_format_message(entry->message, format, args, suppressed);
+
+    /* Publish entry and wake log thread */
+    __atomic_store_n(&(entry->sequence), position + 1, __ATOMIC_RELEASE);
+    sem_post(&guacd_log_pending);
+
+}
+
+void vguacd_log(guac_client_log_level level, const char* format,
+        va_list args) {
+    guacd_log_queue_message(NULL, level, format, args);
 }
 
 void guacd_log(guac_client_log_level level, const char* format, ...) {
@@ -97,7 +666,7 @@ void guacd_log(guac_client_log_level level, const char* format, ...) {
 
 void guacd_client_log(guac_client* client, guac_client_log_level level,
         const char* format, va_list args) {
-    vguacd_log(level, format, args);
+    guacd_log_queue_message(client->connection_id, level, format, args);
 }
 
 void guacd_log_guac_error(guac_client_log_level level, const char* message) {
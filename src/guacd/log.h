@@ -36,9 +36,72 @@ extern int guacd_log_level;
  */
 #define GUACD_LOG_NAME "guacd"
 
+/**
+ * The maximum length of a single log message, in bytes, including null
+ * terminator. Longer messages are truncated.
+ */
+#define GUACD_LOG_MESSAGE_LENGTH 2048
+
+/**
+ * The maximum length of the connection ID attached to a log message, in
+ * bytes, including null terminator.
+ */
+#define GUACD_LOG_CONNECTION_ID_LENGTH 64
+
+/**
+ * The number of messages which may be queued for logging by the background
+ * log thread. This MUST be a power of two. Messages logged while the queue is
+ * full are dropped (and counted) rather than waiting for space.
+ */
+#define GUACD_LOG_QUEUE_SIZE 256
+
+/**
+ * The number of distinct message sites (format strings) for which log rate
+ * limits are tracked. Sites are hashed into this many buckets.
+ */
+#define GUACD_LOG_RATE_SITES 256
+
+/**
+ * The duration of each log rate limiting window, in milliseconds.
+ */
+#define GUACD_LOG_RATE_INTERVAL 1000
+
+/**
+ * The maximum number of messages which may be logged from any one message
+ * site (format string) within a single rate limiting window. Further messages
+ * from that site are suppressed until the next window, at which point the
+ * number of suppressed messages is logged.
+ */
+#define GUACD_LOG_RATE_LIMIT 100
+
+/**
+ * All supported formats for guacd's log output.
+ */
+typedef enum guacd_log_format {
+
+    /**
+     * Human-readable text, one message per line.
+     */
+    GUACD_LOG_FORMAT_TEXT,
+
+    /**
+     * One JSON object per message, including the log level, process ID and,
+     * if applicable, the ID of the connection that logged the message.
+     */
+    GUACD_LOG_FORMAT_JSON
+
+} guacd_log_format;
+
+/**
+ * The format in which messages should be logged.
+ */
+extern guacd_log_format guacd_log_output_format;
+
 /**
  * Writes a message to guacd's logs. This function takes a format and va_list,
- * similar to vprintf.
+ * similar to vprintf. The message is formatted and queued by the calling
+ * thread, but written to syslog and STDERR by a background thread, such that
+ * logging never blocks the caller on log output.
  */
 void vguacd_log(guac_client_log_level level, const char* format, va_list args);
 
@@ -33,9 +33,11 @@
 #include <guacamole/socket.h>
 #include <guacamole/user.h>
 
+#include <dirent.h>
 #include <errno.h>
 #include <stdlib.h>
 #include <string.h>
+#include <syslog.h>
 #include <unistd.h>
 #include <sys/types.h>
 #include <sys/socket.h>
@@ -407,6 +409,55 @@ static void guacd_exec_proc(guacd_proc* proc, const char* protocol) {
 
 }
 
+/**
+ * Closes all file descriptors inherited from the parent guacd process except
+ * for standard input, output, and error, and the given file descriptor. This
+ * includes the listening sockets, the network connections of users of other
+ * connections, and the sockets used to communicate with other processes,
+ * none of which may remain open within a newly-forked process. Marking these
+ * descriptors close-on-exec is not sufficient, as the new process is not the
+ * result of exec().
+ *
+ * @param keep_fd
+ *     The file descriptor which must remain open.
+ */
+static void guacd_proc_close_inherited_fds(int keep_fd) {
+
+    int fd;
+    long max_fd;
+
+    /* Close syslog's socket (if any) such that it is not closed behind
+     * syslog's back below; it is reopened upon the next message */
+    closelog();
+    openlog(GUACD_LOG_NAME, LOG_PID, LOG_DAEMON);
+
+    /* Close only those descriptors which are actually open, if possible */
+    DIR* fds = opendir("/proc/self/fd");
+    if (fds != NULL) {
+
+        struct dirent* entry;
+        while ((entry = readdir(fds)) != NULL) {
+
+            fd = atoi(entry->d_name);
+            if (fd > STDERR_FILENO && fd != keep_fd && fd != dirfd(fds))
+                close(fd);
+
+        }
+
+        closedir(fds);
+        return;
+
+    }
+
+    /* Otherwise, close every possible descriptor */
+    max_fd = sysconf(_SC_OPEN_MAX);
+    for (fd = STDERR_FILENO + 1; fd < max_fd; fd++) {
+        if (fd != keep_fd)
+            close(fd);
+    }
+
+}
+
 guacd_proc* guacd_create_proc(const char* protocol) {
 
     int sockets[2];
@@ -459,6 +510,10 @@ guacd_proc* guacd_create_proc(const char* protocol) {
         proc->fd_socket = parent_socket;
         close(child_socket);
 
+        /* Do not hold open any descriptors of the parent or its other
+         * connections */
+        guacd_proc_close_inherited_fds(parent_socket);
+
         /* Start protocol-specific handling */
         guacd_exec_proc(proc, protocol);
 
@@ -0,0 +1,427 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "config.h"
+
+#include "arena.h"
+
+#include <pthread.h>
+#include <stdlib.h>
+
+/**
+ * A single block of heap memory backing an arena.
+ */
+typedef struct guac_arena_block {
+
+    /**
+     * The memory of this block.
+     */
+    unsigned char* data;
+
+    /**
+     * The total number of bytes within this block.
+     */
+    size_t size;
+
+    /**
+     * The number of bytes of this block which are currently allocated.
+     */
+    size_t used;
+
+    /**
+     * The largest number of bytes of this block which have been allocated
+     * at once since the block was last considered for trimming.
+     */
+    size_t high_water;
+
+} guac_arena_block;
+
+/**
+ * The arena of a single thread.
+ */
+typedef struct guac_arena {
+
+    /**
+     * All blocks allocated for this arena, in order of use.
+     */
+    guac_arena_block* blocks;
+
+    /**
+     * The number of blocks within the blocks array.
+     */
+    int block_count;
+
+    /**
+     * The index of the block from which memory is currently being allocated.
+     */
+    int current;
+
+    /**
+     * The number of blocks allocated by this arena since the arena was last
+     * reset.
+     */
+    int heap_allocations;
+
+    /**
+     * The number of times this arena has been reset since its blocks were
+     * last considered for trimming.
+     */
+    int resets;
+
+} guac_arena;
+
+#ifdef ENABLE_ARENA_STATS
+
+/* Allocator functions exported by glibc, used by the counting wrappers */
+void* __libc_malloc(size_t size);
+void* __libc_calloc(size_t nmemb, size_t size);
+void* __libc_realloc(void* ptr, size_t size);
+void __libc_free(void* ptr);
+
+/**
+ * The number of calls to malloc(), calloc() and realloc() made by the
+ * calling thread since its arena was last reset. Initial-exec TLS is used
+ * so that reading this value can never itself allocate.
+ */
+static __thread int __guac_arena_mallocs
+    __attribute__((tls_model("initial-exec"))) = 0;
+
+/**
+ * The number of calls to free() and realloc() on non-NULL pointers made by
+ * the calling thread since its arena was last reset.
+ */
+static __thread int __guac_arena_frees
+    __attribute__((tls_model("initial-exec"))) = 0;
+
+/*
+ * With ENABLE_ARENA_STATS, libguac replaces the allocator entry points of
+ * the process with wrappers which count each call within the calling thread
+ * before invoking the glibc implementation. Allocations made anywhere during
+ * a frame, including by libraries such as cairo, are thus counted.
+ */
+
+void* malloc(size_t size) {
+    __guac_arena_mallocs++;
+    return __libc_malloc(size);
+}
+
+void* calloc(size_t nmemb, size_t size) {
+    __guac_arena_mallocs++;
+    return __libc_calloc(nmemb, size);
+}
+
+void* realloc(void* ptr, size_t size) {
+    __guac_arena_mallocs++;
+    if (ptr != NULL)
+        __guac_arena_frees++;
+    return __libc_realloc(ptr, size);
+}
+
+void free(void* ptr) {
+    if (ptr != NULL)
+        __guac_arena_frees++;
+    __libc_free(ptr);
+}
+
+#endif
+
+static pthread_key_t  __guac_arena_key;
+static pthread_once_t __guac_arena_key_init = PTHREAD_ONCE_INIT;
+
+/**
+ * Frees the arena of a thread which is exiting, including all blocks.
+ *
+ * @param pointer
+ *     The guac_arena associated with the exiting thread.
+ */
+static void __guac_arena_free(void* pointer) {
+
+    guac_arena* arena = (guac_arena*) pointer;
+    int i;
+
+    for (i = 0; i < arena->block_count; i++)
+        free(arena->blocks[i].data);
+
+    free(arena->blocks);
+    free(arena);
+
+}
+
+static void __guac_alloc_arena_key() {
+
+    /* Create key, free arena on thread exit */
+    pthread_key_create(&__guac_arena_key, __guac_arena_free);
+
+}
+
+/**
+ * Returns the arena of the calling thread, allocating a new, empty arena if
+ * necessary.
+ *
+ * @return
+ *     The arena of the calling thread, or NULL if no arena could be
+ *     allocated.
+ */
+static guac_arena* __guac_arena_get() {
+
+    guac_arena* arena;
+
+    /* Init arena key, if not already initialized */
+    pthread_once(&__guac_arena_key_init, __guac_alloc_arena_key);
+
+    /* Retrieve thread-local arena */
+    arena = (guac_arena*) pthread_getspecific(__guac_arena_key);
+
+    /* Allocate thread-local arena if not already allocated */
+    if (arena == NULL) {
+        arena = calloc(1, sizeof(guac_arena));
+        if (arena == NULL)
+            return NULL;
+        pthread_setspecific(__guac_arena_key, arena);
+    }
+
+    return arena;
+
+}
+
+/**
+ * Appends a new block of at least the given size to the given arena.
+ *
+ * @param arena
+ *     The arena to grow.
+ *
+ * @param size
+ *     The minimum number of bytes the new block must contain.
+ *
+ * @return
+ *     Zero if the block was added successfully, non-zero otherwise.
+ */
+static int __guac_arena_grow(guac_arena* arena, size_t size) {
+
+    guac_arena_block* blocks;
+    guac_arena_block* block;
+
+    if (size < GUAC_ARENA_BLOCK_SIZE)
+        size = GUAC_ARENA_BLOCK_SIZE;
+
+    /* Make room for new block */
+    blocks = realloc(arena->blocks,
+            sizeof(guac_arena_block) * (arena->block_count + 1));
+    if (blocks == NULL)
+        return 1;
+
+    arena->blocks = blocks;
+
+    /* Allocate block memory */
+    block = &(arena->blocks[arena->block_count]);
+    block->data = malloc(size);
+    if (block->data == NULL)
+        return 1;
+
+    block->size = size;
+    block->used = 0;
+    block->high_water = 0;
+    arena->block_count++;
+    arena->heap_allocations++;
+
+    return 0;
+
+}
+
+void* guac_arena_alloc(size_t size) {
+
+    guac_arena* arena = __guac_arena_get();
+    if (arena == NULL)
+        return NULL;
+
+    /* Keep all allocations aligned */
+    size = (size + GUAC_ARENA_ALIGNMENT - 1)
+        & ~((size_t) GUAC_ARENA_ALIGNMENT - 1);
+
+    /* Advance through existing blocks until one has room */
+    while (arena->current < arena->block_count) {
+
+        guac_arena_block* block = &(arena->blocks[arena->current]);
+
+        if (block->size - block->used >= size) {
+            void* allocated = block->data + block->used;
+            block->used += size;
+            return allocated;
+        }
+
+        /* Blocks beyond the current block are always unused */
+        if (arena->current + 1 >= arena->block_count)
+            break;
+
+        arena->current++;
+
+    }
+
+    /* No block has room - add a new block */
+    if (__guac_arena_grow(arena, size))
+        return NULL;
+
+    arena->current = arena->block_count - 1;
+    arena->blocks[arena->current].used = size;
+
+    return arena->blocks[arena->current].data;
+
+}
+
+guac_arena_mark guac_arena_get_mark() {
+
+    guac_arena_mark mark = { 0, 0 };
+
+    guac_arena* arena = __guac_arena_get();
+    if (arena != NULL && arena->current < arena->block_count) {
+        mark.block = arena->current;
+        mark.used = arena->blocks[arena->current].used;
+    }
+
+    return mark;
+
+}
+
+/**
+ * Sets the number of bytes allocated from the given block, recording the
+ * number of bytes previously allocated within the high-water mark of the
+ * block.
+ *
+ * @param block
+ *     The block whose allocated size is changing.
+ *
+ * @param used
+ *     The new number of bytes allocated from the block.
+ */
+static void __guac_arena_block_set_used(guac_arena_block* block,
+        size_t used) {
+
+    if (block->used > block->high_water)
+        block->high_water = block->used;
+
+    block->used = used;
+
+}
+
+/**
+ * Frees each block of the given arena which was not used at all since the
+ * blocks were last considered for trimming, as well as each block larger
+ * than GUAC_ARENA_BLOCK_SIZE of which no more than half was needed at once
+ * during that time. A needed block that is freed is replaced on demand with
+ * a block of the size actually required. The arena MUST have just been
+ * reset, such that no block is in use.
+ *
+ * @param arena
+ *     The arena to trim.
+ */
+static void __guac_arena_trim(guac_arena* arena) {
+
+    int i;
+    int kept = 0;
+
+    for (i = 0; i < arena->block_count; i++) {
+
+        guac_arena_block* block = &(arena->blocks[i]);
+
+        /* Free blocks which are unused or needlessly large */
+        if (block->high_water == 0 || (block->size > GUAC_ARENA_BLOCK_SIZE
+                    && block->high_water <= block->size / 2)) {
+            free(block->data);
+            continue;
+        }
+
+        /* Keep remaining blocks in order of use */
+        block->high_water = 0;
+        arena->blocks[kept++] = *block;
+
+    }
+
+    arena->block_count = kept;
+
+}
+
+void guac_arena_release(guac_arena_mark mark) {
+
+    int i;
+
+    guac_arena* arena = __guac_arena_get();
+    if (arena == NULL || mark.block >= arena->block_count)
+        return;
+
+    /* Restore marked block to marked position */
+    arena->current = mark.block;
+    __guac_arena_block_set_used(&(arena->blocks[mark.block]), mark.used);
+
+    /* All later blocks become entirely unused */
+    for (i = mark.block + 1; i < arena->block_count; i++)
+        __guac_arena_block_set_used(&(arena->blocks[i]), 0);
+
+}
+
+void guac_arena_reset() {
+
+    guac_arena_mark mark = { 0, 0 };
+
+    guac_arena* arena = __guac_arena_get();
+    if (arena == NULL)
+        return;
+
+    guac_arena_release(mark);
+    arena->heap_allocations = 0;
+
+    /* Release memory not needed within the last interval */
+    if (++arena->resets >= GUAC_ARENA_TRIM_INTERVAL) {
+        __guac_arena_trim(arena);
+        arena->resets = 0;
+    }
+
+    /* Begin counting anew, excluding any frees performed by the trim */
+#ifdef ENABLE_ARENA_STATS
+    __guac_arena_mallocs = 0;
+    __guac_arena_frees = 0;
+#endif
+
+}
+
+int guac_arena_heap_allocations() {
+
+    guac_arena* arena = __guac_arena_get();
+    if (arena == NULL)
+        return 0;
+
+    return arena->heap_allocations;
+
+}
+
+int guac_arena_malloc_count() {
+#ifdef ENABLE_ARENA_STATS
+    return __guac_arena_mallocs;
+#else
+    return 0;
+#endif
+}
+
+int guac_arena_free_count() {
+#ifdef ENABLE_ARENA_STATS
+    return __guac_arena_frees;
+#else
+    return 0;
+#endif
+}
+
@@ -27,9 +27,54 @@
 #include <guacamole/stream.h>
 #include <guacamole/user.h>
 
+#include <stdint.h>
 #include <stdlib.h>
 #include <string.h>
 
+/**
+ * Returns whether the given buffer of PCM data consists entirely of silence
+ * (zero bytes). The buffer is tested a 64-byte block at a time, stopping at
+ * the first block containing any non-zero data.
+ *
+ * @param data
+ *     The PCM data to test.
+ *
+ * @param length
+ *     The number of bytes of PCM data within the buffer.
+ *
+ * @return
+ *     Non-zero if the given PCM data is entirely silent, zero otherwise.
+ */
+static int guac_audio_is_silence(const unsigned char* data, int length) {
+
+    int i;
+    uint64_t combined = 0;
+
+    /* Test each whole block, combining its words to avoid branching */
+    while (length >= 8 * (int) sizeof(uint64_t)) {
+
+        for (i = 0; i < 8; i++) {
+            uint64_t word;
+            memcpy(&word, data, sizeof(word));
+            combined |= word;
+            data += sizeof(word);
+        }
+
+        if (combined)
+            return 0;
+
+        length -= 8 * sizeof(uint64_t);
+
+    }
+
+    /* Test any remaining bytes individually */
+    for (i = 0; i < length; i++)
+        combined |= data[i];
+
+    return combined == 0;
+
+}
+
 /**
  * Assigns a new audio encoder to the given guac_audio_stream based on the
  * audio mimetypes declared as supported by the given user. If no audio encoder
@@ -126,6 +171,9 @@ void guac_audio_stream_reset(guac_audio_stream* audio,
         return;
     }
 
+    /* Send any audio buffered in the old format */
+    guac_audio_stream_flush(audio);
+
     /* Free old encoder data */
     if (audio->encoder->end_handler)
         audio->encoder->end_handler(audio);
@@ -172,10 +220,24 @@ void guac_audio_stream_free(guac_audio_stream* audio) {
 void guac_audio_stream_write_pcm(guac_audio_stream* audio, 
         const unsigned char* data, int length) {
 
+    /* Discard silence, sending any audio which preceded it */
+    if (audio->suppress_silence && guac_audio_is_silence(data, length)) {
+        guac_audio_stream_flush(audio);
+        return;
+    }
+
     /* Write data */
     if (audio->encoder->write_handler)
         audio->encoder->write_handler(audio, data, length);
 
+    audio->__pending += length;
+
+    /* Flush automatically once a full packet has accumulated */
+    if (audio->packet_interval > 0 && audio->__pending >=
+            audio->packet_interval * audio->rate * audio->channels
+            * audio->bps / 8 / 1000)
+        guac_audio_stream_flush(audio);
+
 }
 
 void guac_audio_stream_flush(guac_audio_stream* audio) {
@@ -184,5 +246,7 @@ void guac_audio_stream_flush(guac_audio_stream* audio) {
     if (audio->encoder->flush_handler)
         audio->encoder->flush_handler(audio);
 
+    audio->__pending = 0;
+
 }
 
@@ -19,6 +19,7 @@
 
 #include "config.h"
 
+#include "arena.h"
 #include "client.h"
 #include "encode-jpeg.h"
 #include "encode-png.h"
@@ -36,6 +37,7 @@
 
 #include <dlfcn.h>
 #include <pthread.h>
+#include <sched.h>
 #include <stdarg.h>
 #include <stdio.h>
 #include <stdlib.h>
@@ -47,6 +49,265 @@ guac_layer __GUAC_DEFAULT_LAYER = {
 
 const guac_layer* GUAC_DEFAULT_LAYER = &__GUAC_DEFAULT_LAYER;
 
+/**
+ * Immutable snapshot of all users connected to a guac_client. Once published
+ * via guac_client_publish_users(), a snapshot is never modified; joins and
+ * leaves instead publish an entirely new snapshot.
+ */
+struct guac_client_user_list {
+
+    /**
+     * The user that first created the connection. This user will also have
+     * their "owner" flag set to a non-zero value. If the owner has left the
+     * connection, this will be NULL.
+     */
+    guac_user* owner;
+
+    /**
+     * The number of users within the users array which have joined the
+     * connection.
+     */
+    int count;
+
+    /**
+     * The number of users within the users array which are still joining the
+     * connection, stored after the first count users. Joining users receive
+     * all data written to the broadcast socket, but are otherwise not visible
+     * until their join has completed.
+     */
+    int joining;
+
+    /**
+     * All connected users, most recently joined first, followed by all users
+     * which are still joining.
+     */
+    guac_user* users[];
+
+};
+
+/**
+ * Allocates a new, empty snapshot of connected users having room for the
+ * given number of users. The count of the returned snapshot is initialized
+ * to zero.
+ *
+ * @param size
+ *     The maximum number of users that the snapshot must be able to contain.
+ *
+ * @return
+ *     A newly-allocated, empty snapshot of connected users.
+ */
+static guac_client_user_list* guac_client_user_list_alloc(int size) {
+
+    guac_client_user_list* users = malloc(sizeof(guac_client_user_list)
+            + sizeof(guac_user*) * size);
+
+    users->owner = NULL;
+    users->count = 0;
+    users->joining = 0;
+
+    return users;
+
+}
+
+/**
+ * Acquires the current snapshot of connected users for reading, registering
+ * the calling thread as a reader of the current epoch. The snapshot is
+ * guaranteed to remain valid until guac_client_release_users() is invoked
+ * with the same epoch. No locks are acquired.
+ *
+ * @param client
+ *     The client whose users should be acquired.
+ *
+ * @param epoch
+ *     Pointer to an int which will receive the epoch in which the snapshot
+ *     was acquired. This value must later be passed to
+ *     guac_client_release_users().
+ *
+ * @return
+ *     The current snapshot of connected users.
+ */
+static guac_client_user_list* guac_client_acquire_users(guac_client* client,
+        int* epoch) {
+
+    for (;;) {
+
+        /* Register as reader within current epoch */
+        int current = __atomic_load_n(&(client->__users_epoch),
+                __ATOMIC_SEQ_CST);
+        __atomic_add_fetch(&(client->__users_readers[current]), 1,
+                __ATOMIC_SEQ_CST);
+
+        /* If epoch has not changed, any snapshot read from this point
+         * forward cannot be freed until this reader is released */
+        if (__atomic_load_n(&(client->__users_epoch),
+                    __ATOMIC_SEQ_CST) == current) {
+            *epoch = current;
+            return __atomic_load_n(&(client->__users), __ATOMIC_SEQ_CST);
+        }
+
+        /* Otherwise, the epoch was flipped after it was read, and the
+         * publishing thread may not have seen this reader - retry */
+        __atomic_sub_fetch(&(client->__users_readers[current]), 1,
+                __ATOMIC_SEQ_CST);
+
+    }
+
+}
+
+/**
+ * Releases a snapshot of connected users previously acquired with
+ * guac_client_acquire_users(). The snapshot MUST NOT be used after this
+ * function returns.
+ *
+ * @param client
+ *     The client whose users were acquired.
+ *
+ * @param epoch
+ *     The epoch returned by the corresponding call to
+ *     guac_client_acquire_users().
+ */
+static void guac_client_release_users(guac_client* client, int epoch) {
+    __atomic_sub_fetch(&(client->__users_readers[epoch]), 1,
+            __ATOMIC_SEQ_CST);
+}
+
+/**
+ * Replaces the current snapshot of connected users with the given snapshot,
+ * waiting until no thread may still be reading the previous snapshot before
+ * freeing it. The __users_lock of the given client MUST be held.
+ *
+ * @param client
+ *     The client whose users are being replaced.
+ *
+ * @param users
+ *     The new snapshot of connected users.
+ */
+static void guac_client_publish_users(guac_client* client,
+        guac_client_user_list* users) {
+
+    /* Publish new snapshot; new readers may begin using it immediately */
+    guac_client_user_list* old_users = __atomic_exchange_n(
+            &(client->__users), users, __ATOMIC_SEQ_CST);
+
+    /* Direct all new readers to the other epoch */
+    int epoch = client->__users_epoch;
+    __atomic_store_n(&(client->__users_epoch), !epoch, __ATOMIC_SEQ_CST);
+
+    /* Wait for all readers that may have seen the old snapshot */
+    while (__atomic_load_n(&(client->__users_readers[epoch]),
+                __ATOMIC_SEQ_CST) != 0)
+        sched_yield();
+
+    free(old_users);
+
+}
+
+/**
+ * The given user has left the connection, or has failed to join.
+ */
+#define GUAC_CLIENT_USER_LEFT 0
+
+/**
+ * The given user is joining the connection. It receives all data written to
+ * the broadcast socket, but is otherwise not yet visible.
+ */
+#define GUAC_CLIENT_USER_JOINING 1
+
+/**
+ * The given user has successfully joined the connection.
+ */
+#define GUAC_CLIENT_USER_JOINED 2
+
+/**
+ * Publishes a new snapshot of connected users in which the given user has
+ * the given state, relative to the current snapshot. The __users_lock of the
+ * given client MUST be held. If the set of users receiving broadcast data is
+ * changing, the lock of the broadcast socket MUST also be held, such that no
+ * instruction is being written to the broadcast socket while the set of
+ * users changes.
+ *
+ * @param client
+ *     The client whose users are being updated.
+ *
+ * @param user
+ *     The user whose state is changing.
+ *
+ * @param state
+ *     The new state of the given user: GUAC_CLIENT_USER_LEFT,
+ *     GUAC_CLIENT_USER_JOINING, or GUAC_CLIENT_USER_JOINED.
+ */
+static void guac_client_update_users(guac_client* client, guac_user* user,
+        int state) {
+
+    int i;
+
+    guac_client_user_list* old_users = client->__users;
+    guac_client_user_list* users = guac_client_user_list_alloc(
+            old_users->count + old_users->joining + 1);
+
+    /* Newly-joined users are added to head */
+    if (state == GUAC_CLIENT_USER_JOINED)
+        users->users[users->count++] = user;
+
+    /* Copy all other users that have joined */
+    for (i = 0; i < old_users->count; i++) {
+        if (old_users->users[i] != user)
+            users->users[users->count++] = old_users->users[i];
+    }
+
+    /* Copy all other users that are joining */
+    for (i = old_users->count; i < old_users->count + old_users->joining;
+            i++) {
+        if (old_users->users[i] != user)
+            users->users[users->count + users->joining++] =
+                old_users->users[i];
+    }
+
+    /* Joining users are added to tail */
+    if (state == GUAC_CLIENT_USER_JOINING)
+        users->users[users->count + users->joining++] = user;
+
+    /* Update owner pointer if user is owner and joined, or was owner */
+    if (state == GUAC_CLIENT_USER_JOINED && user->owner)
+        users->owner = user;
+    else if (old_users->owner != user)
+        users->owner = old_users->owner;
+
+    guac_client_publish_users(client, users);
+
+}
+
+/**
+ * Invokes the given callback for each user which should receive data written
+ * to the broadcast socket of the given client, including users which are
+ * still joining. The callback is invoked exactly as by
+ * guac_client_foreach_user().
+ *
+ * @param client
+ *     The client whose users should be iterated.
+ *
+ * @param callback
+ *     The callback to invoke for each user.
+ *
+ * @param data
+ *     Arbitrary data to pass to the callback.
+ */
+static void guac_client_foreach_recipient(guac_client* client,
+        guac_user_callback* callback, void* data) {
+
+    int i;
+    int epoch;
+
+    guac_client_user_list* users = guac_client_acquire_users(client, &epoch);
+
+    /* Call function on each user, whether joined or joining */
+    for (i = 0; i < users->count + users->joining; i++)
+        callback(users->users[i], data);
+
+    guac_client_release_users(client, epoch);
+
+}
+
 /**
  * Single chunk of data, to be broadcast to all users.
  */
@@ -64,6 +325,40 @@ typedef struct __write_chunk {
 
 } __write_chunk;
 
+/**
+ * Data associated with the broadcast socket of a guac_client. Data written to
+ * the broadcast socket is serialized only once, into a shared buffer, and the
+ * contents of that buffer are written to each user as a single chunk when
+ * the buffer is full, when the current instruction ends, or when the
+ * broadcast socket is flushed.
+ */
+typedef struct __broadcast_data {
+
+    /**
+     * The client whose users should receive all data written.
+     */
+    guac_client* client;
+
+    /**
+     * Recursive lock which is held for the duration of each instruction
+     * written to the broadcast socket, and which guards access to the shared
+     * buffer.
+     */
+    pthread_mutex_t lock;
+
+    /**
+     * The number of bytes currently in the shared buffer.
+     */
+    int written;
+
+    /**
+     * The shared buffer. Bytes written go here before being written to the
+     * socket of each user.
+     */
+    char out_buf[GUAC_SOCKET_OUTPUT_BUFFER_SIZE];
+
+} __broadcast_data;
+
 guac_layer* guac_client_alloc_layer(guac_client* client) {
 
     /* Init new layer */
@@ -190,6 +485,50 @@ static void* __write_chunk_callback(guac_user* user, void* data) {
 
 }
 
+/**
+ * Writes the given chunk of data to the sockets of all connected users. The
+ * lock of the given broadcast data must be held.
+ *
+ * @param data
+ *     The data associated with the broadcast socket.
+ *
+ * @param buf
+ *     The buffer containing the data to write.
+ *
+ * @param count
+ *     The number of bytes to write from the given buffer.
+ */
+static void __guac_socket_broadcast_write_chunk(__broadcast_data* data,
+        const void* buf, size_t count) {
+
+    /* Build chunk */
+    __write_chunk chunk;
+    chunk.buffer = buf;
+    chunk.length = count;
+
+    /* Broadcast chunk to all users */
+    guac_client_foreach_recipient(data->client, __write_chunk_callback, &chunk);
+
+}
+
+/**
+ * Writes any data pending within the shared buffer of the broadcast socket
+ * to the sockets of all connected users, emptying the shared buffer. The lock
+ * of the given broadcast data must be held.
+ *
+ * @param data
+ *     The data associated with the broadcast socket.
+ */
+static void __guac_socket_broadcast_write_pending(__broadcast_data* data) {
+
+    if (data->written > 0) {
+        __guac_socket_broadcast_write_chunk(data, data->out_buf,
+                data->written);
+        data->written = 0;
+    }
+
+}
+
 /**
  * Socket write handler which operates on each of the sockets of all connected
  * users. This write handler will always succeed, but any failing user-specific
@@ -212,15 +551,40 @@ static void* __write_chunk_callback(guac_user* user, void* data) {
 static ssize_t __guac_socket_broadcast_write_handler(guac_socket* socket,
         const void* buf, size_t count) {
 
-    guac_client* client = (guac_client*) socket->data;
+    __broadcast_data* data = (__broadcast_data*) socket->data;
 
-    /* Build chunk */
-    __write_chunk chunk;
-    chunk.buffer = buf;
-    chunk.length = count;
+    pthread_mutex_lock(&(data->lock));
 
-    /* Broadcast chunk to all users */
-    guac_client_foreach_user(client, __write_chunk_callback, &chunk);
+    /* Write large chunks directly if nothing is pending */
+    if (data->written == 0 && count >= sizeof(data->out_buf))
+        __guac_socket_broadcast_write_chunk(data, buf, count);
+
+    /* Otherwise, append to shared buffer, writing to users once full */
+    else {
+
+        const char* current = buf;
+        size_t remaining = count;
+
+        while (remaining > 0) {
+
+            size_t chunk_size = sizeof(data->out_buf) - data->written;
+            if (chunk_size > remaining)
+                chunk_size = remaining;
+
+            memcpy(data->out_buf + data->written, current, chunk_size);
+            data->written += chunk_size;
+
+            current   += chunk_size;
+            remaining -= chunk_size;
+
+            if (data->written == sizeof(data->out_buf))
+                __guac_socket_broadcast_write_pending(data);
+
+        }
+
+    }
+
+    pthread_mutex_unlock(&(data->lock));
 
     return count;
 
@@ -265,10 +629,15 @@ static void* __flush_callback(guac_user* user, void* data) {
  */
 static ssize_t __guac_socket_broadcast_flush_handler(guac_socket* socket) {
 
-    guac_client* client = (guac_client*) socket->data;
+    __broadcast_data* data = (__broadcast_data*) socket->data;
 
-    /* Flush all users */
-    guac_client_foreach_user(client, __flush_callback, NULL);
+    pthread_mutex_lock(&(data->lock));
+
+    /* Write any pending data, then flush all users */
+    __guac_socket_broadcast_write_pending(data);
+    guac_client_foreach_recipient(data->client, __flush_callback, NULL);
+
+    pthread_mutex_unlock(&(data->lock));
 
     return 0;
 
@@ -309,10 +678,13 @@ static void* __lock_callback(guac_user* user, void* data) {
  */
 static void __guac_socket_broadcast_lock_handler(guac_socket* socket) {
 
-    guac_client* client = (guac_client*) socket->data;
+    __broadcast_data* data = (__broadcast_data*) socket->data;
+
+    /* Acquire shared buffer for duration of instruction */
+    pthread_mutex_lock(&(data->lock));
 
     /* Lock sockets of all users */
-    guac_client_foreach_user(client, __lock_callback, NULL);
+    guac_client_foreach_recipient(data->client, __lock_callback, NULL);
 
 }
 
@@ -349,10 +721,38 @@ static void* __unlock_callback(guac_user* user, void* data) {
  */
 static void __guac_socket_broadcast_unlock_handler(guac_socket* socket) {
 
-    guac_client* client = (guac_client*) socket->data;
+    __broadcast_data* data = (__broadcast_data*) socket->data;
+
+    /* Write completed instruction to all users as a single chunk */
+    __guac_socket_broadcast_write_pending(data);
 
     /* Unlock sockets of all users */
-    guac_client_foreach_user(client, __unlock_callback, NULL);
+    guac_client_foreach_recipient(data->client, __unlock_callback, NULL);
+
+    /* Release shared buffer */
+    pthread_mutex_unlock(&(data->lock));
+
+}
+
+/**
+ * Frees the data associated with the broadcast socket. Any pending data will
+ * already have been written to users, as guac_socket_free() flushes the
+ * socket prior to invoking this handler.
+ *
+ * @param socket
+ *     The broadcast socket being freed.
+ *
+ * @return
+ *     Always zero.
+ */
+static int __guac_socket_broadcast_free_handler(guac_socket* socket) {
+
+    __broadcast_data* data = (__broadcast_data*) socket->data;
+
+    pthread_mutex_destroy(&(data->lock));
+    free(data);
+
+    return 0;
 
 }
 
@@ -386,7 +786,7 @@ static int __guac_socket_broadcast_select_handler(guac_socket* socket,
 guac_client* guac_client_alloc() {
 
     int i;
-    pthread_rwlockattr_t lock_attributes;
+    pthread_mutexattr_t lock_attributes;
 
     /* Allocate new client */
     guac_client* client = malloc(sizeof(guac_client));
@@ -424,16 +824,25 @@ guac_client* guac_client_alloc() {
     }
 
 
-    /* Init locks */
-    pthread_rwlockattr_init(&lock_attributes);
-    pthread_rwlockattr_setpshared(&lock_attributes, PTHREAD_PROCESS_SHARED);
+    /* Init users list, initially empty */
+    client->__users = guac_client_user_list_alloc(0);
+    pthread_mutex_init(&(client->__users_lock), NULL);
 
-    pthread_rwlock_init(&(client->__users_lock), &lock_attributes);
+    /* Set up shared buffer for broadcast socket */
+    __broadcast_data* broadcast = malloc(sizeof(__broadcast_data));
+    broadcast->client = client;
+    broadcast->written = 0;
+
+    /* Broadcast lock may be reacquired by writes within an instruction */
+    pthread_mutexattr_init(&lock_attributes);
+    pthread_mutexattr_settype(&lock_attributes, PTHREAD_MUTEX_RECURSIVE);
+    pthread_mutex_init(&(broadcast->lock), &lock_attributes);
+    pthread_mutexattr_destroy(&lock_attributes);
 
     /* Set up socket to broadcast to all users */
     guac_socket* socket = guac_socket_alloc();
     client->socket = socket;
-    socket->data   = client;
+    socket->data   = broadcast;
 
     socket->read_handler   = __guac_socket_broadcast_read_handler;
     socket->write_handler  = __guac_socket_broadcast_write_handler;
@@ -441,6 +850,7 @@ guac_client* guac_client_alloc() {
     socket->flush_handler  = __guac_socket_broadcast_flush_handler;
     socket->lock_handler   = __guac_socket_broadcast_lock_handler;
     socket->unlock_handler = __guac_socket_broadcast_unlock_handler;
+    socket->free_handler   = __guac_socket_broadcast_free_handler;
 
     return client;
 
@@ -449,8 +859,8 @@ guac_client* guac_client_alloc() {
 void guac_client_free(guac_client* client) {
 
     /* Remove all users */
-    while (client->__users != NULL)
-        guac_client_remove_user(client, client->__users);
+    while (client->__users->count > 0)
+        guac_client_remove_user(client, client->__users->users[0]);
 
     if (client->free_handler) {
 
@@ -478,7 +888,8 @@ void guac_client_free(guac_client* client) {
             guac_client_log(client, GUAC_LOG_ERROR, "Unable to close plugin: %s", dlerror());
     }
 
-    pthread_rwlock_destroy(&(client->__users_lock));
+    pthread_mutex_destroy(&(client->__users_lock));
+    free(client->__users);
     free(client->connection_id);
     free(client);
 }
@@ -544,31 +955,38 @@ int guac_client_add_user(guac_client* client, guac_user* user, int argc, char**
 
     int retval = 0;
 
-    pthread_rwlock_wrlock(&(client->__users_lock));
+    __broadcast_data* broadcast = (__broadcast_data*) client->socket->data;
 
-    /* Call handler, if defined */
+    /* Begin sending broadcast data to the user before the join handler
+     * synchronizes the user's view of the connection, such that no update
+     * made after that synchronization can be missed. No instruction may be
+     * in progress on the broadcast socket while its recipients change. */
+    pthread_mutex_lock(&(broadcast->lock));
+    pthread_mutex_lock(&(client->__users_lock));
+    guac_client_update_users(client, user, GUAC_CLIENT_USER_JOINING);
+    pthread_mutex_unlock(&(client->__users_lock));
+    pthread_mutex_unlock(&(broadcast->lock));
+
+    /* Call handler, if defined. Output to other users continues while the
+     * handler runs. */
     if (client->join_handler)
         retval = client->join_handler(user, argc, argv);
 
-    /* Add to list if join was successful */
-    if (retval == 0) {
-
-        user->__prev = NULL;
-        user->__next = client->__users;
+    pthread_mutex_lock(&(broadcast->lock));
+    pthread_mutex_lock(&(client->__users_lock));
 
-        if (client->__users != NULL)
-            client->__users->__prev = user;
-
-        client->__users = user;
+    /* Make user visible if join was successful */
+    if (retval == 0) {
         client->connected_users++;
-
-        /* Update owner pointer if user is owner */
-        if (user->owner)
-            client->__owner = user;
-
+        guac_client_update_users(client, user, GUAC_CLIENT_USER_JOINED);
     }
 
-    pthread_rwlock_unlock(&(client->__users_lock));
+    /* Otherwise, stop sending broadcast data to the user */
+    else
+        guac_client_update_users(client, user, GUAC_CLIENT_USER_LEFT);
+
+    pthread_mutex_unlock(&(client->__users_lock));
+    pthread_mutex_unlock(&(broadcast->lock));
 
     return retval;
 
@@ -576,7 +994,19 @@ int guac_client_add_user(guac_client* client, guac_user* user, int argc, char**
 
 void guac_client_remove_user(guac_client* client, guac_user* user) {
 
-    pthread_rwlock_wrlock(&(client->__users_lock));
+    __broadcast_data* broadcast = (__broadcast_data*) client->socket->data;
+
+    /* No instruction may be in progress on the broadcast socket while its
+     * recipients change */
+    pthread_mutex_lock(&(broadcast->lock));
+    pthread_mutex_lock(&(client->__users_lock));
+
+    client->connected_users--;
+
+    /* Once published, no other thread can still be using the removed user
+     * via the users list */
+    guac_client_update_users(client, user, GUAC_CLIENT_USER_LEFT);
+    pthread_mutex_unlock(&(broadcast->lock));
 
     /* Call handler, if defined */
     if (user->leave_handler)
@@ -584,54 +1014,37 @@ void guac_client_remove_user(guac_client* client, guac_user* user) {
     else if (client->leave_handler)
         client->leave_handler(user);
 
-    /* Update prev / head */
-    if (user->__prev != NULL)
-        user->__prev->__next = user->__next;
-    else
-        client->__users = user->__next;
-
-    /* Update next */
-    if (user->__next != NULL)
-        user->__next->__prev = user->__prev;
-
-    client->connected_users--;
-
-    /* Update owner pointer if user was owner */
-    if (user->owner)
-        client->__owner = NULL;
-
-    pthread_rwlock_unlock(&(client->__users_lock));
+    pthread_mutex_unlock(&(client->__users_lock));
 
 }
 
 void guac_client_foreach_user(guac_client* client, guac_user_callback* callback, void* data) {
 
-    guac_user* current;
+    int i;
+    int epoch;
 
-    pthread_rwlock_rdlock(&(client->__users_lock));
+    guac_client_user_list* users = guac_client_acquire_users(client, &epoch);
 
     /* Call function on each user */
-    current = client->__users;
-    while (current != NULL) {
-        callback(current, data);
-        current = current->__next;
-    }
+    for (i = 0; i < users->count; i++)
+        callback(users->users[i], data);
 
-    pthread_rwlock_unlock(&(client->__users_lock));
+    guac_client_release_users(client, epoch);
 
 }
 
 void* guac_client_for_owner(guac_client* client, guac_user_callback* callback,
         void* data) {
 
+    int epoch;
     void* retval;
 
-    pthread_rwlock_rdlock(&(client->__users_lock));
+    guac_client_user_list* users = guac_client_acquire_users(client, &epoch);
 
     /* Invoke callback with current owner */
-    retval = callback(client->__owner, data);
+    retval = callback(users->owner, data);
 
-    pthread_rwlock_unlock(&(client->__users_lock));
+    guac_client_release_users(client, epoch);
 
     /* Return value from callback */
     return retval;
@@ -641,24 +1054,23 @@ void* guac_client_for_owner(guac_client* client, guac_user_callback* callback,
 void* guac_client_for_user(guac_client* client, guac_user* user,
         guac_user_callback* callback, void* data) {
 
-    guac_user* current;
+    int i;
+    int epoch;
 
     int user_valid = 0;
     void* retval;
 
-    pthread_rwlock_rdlock(&(client->__users_lock));
+    guac_client_user_list* users = guac_client_acquire_users(client, &epoch);
 
     /* Loop through all users, searching for a pointer to the given user */
-    current = client->__users;
-    while (current != NULL) {
+    for (i = 0; i < users->count; i++) {
 
         /* If the user's pointer exists in the list, they are indeed valid */
-        if (current == user) {
+        if (users->users[i] == user) {
             user_valid = 1;
             break;
         }
 
-        current = current->__next;
     }
 
     /* Use NULL if user does not actually exist */
@@ -668,7 +1080,7 @@ void* guac_client_for_user(guac_client* client, guac_user* user,
     /* Invoke callback with requested user (if they exist) */
     retval = callback(user, data);
 
-    pthread_rwlock_unlock(&(client->__users_lock));
+    guac_client_release_users(client, epoch);
 
     /* Return value from callback */
     return retval;
@@ -677,6 +1089,20 @@ void* guac_client_for_user(guac_client* client, guac_user* user,
 
 int guac_client_end_frame(guac_client* client) {
 
+#ifdef ENABLE_ARENA_STATS
+    /* Report any heap use by this thread during the frame */
+    int mallocs = guac_arena_malloc_count();
+    int frees = guac_arena_free_count();
+    if (mallocs > 0 || frees > 0)
+        guac_client_log(client, GUAC_LOG_DEBUG, "Frame required %i "
+                "malloc(s) and %i free(s), including %i heap allocation(s) "
+                "by the arena.", mallocs, frees,
+                guac_arena_heap_allocations());
+#endif
+
+    /* Reclaim all temporary memory allocated by this thread for the frame */
+    guac_arena_reset();
+
     /* Update and send timestamp */
     client->last_sent_timestamp = guac_timestamp_current();
     return guac_protocol_send_sync(client->socket, client->last_sent_timestamp);
@@ -796,6 +1222,27 @@ void guac_client_stream_png(guac_client* client, guac_socket* socket,
 
 }
 
+void guac_client_stream_png_buffer(guac_client* client, guac_socket* socket,
+        guac_composite_mode mode, const guac_layer* layer, int x, int y,
+        unsigned char* data, int width, int height, int stride) {
+
+    /* Allocate new stream for image */
+    guac_stream* stream = guac_client_alloc_stream(client);
+
+    /* Declare stream as containing image data */
+    guac_protocol_send_img(socket, stream, mode, layer, "image/png", x, y);
+
+    /* Write PNG data */
+    guac_png_write_buffer(socket, stream, data, width, height, stride);
+
+    /* Terminate stream */
+    guac_protocol_send_end(socket, stream);
+
+    /* Free allocated stream */
+    guac_client_free_stream(client, stream);
+
+}
+
 void guac_client_stream_jpeg(guac_client* client, guac_socket* socket,
         guac_composite_mode mode, const guac_layer* layer, int x, int y,
         cairo_surface_t* surface, int quality) {
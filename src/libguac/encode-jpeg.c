@@ -23,6 +23,7 @@
 #include "error.h"
 #include "palette.h"
 #include "protocol.h"
+#include "scratch.h"
 #include "stream.h"
 
 #include <cairo/cairo.h>
@@ -209,11 +210,17 @@ int guac_jpeg_write(guac_socket* socket, guac_stream* stream,
     cinfo.input_components = 3;
     cinfo.in_color_space = JCS_RGB;
 
-    /* Create a buffer for the write scan line which is where we will
-     * put the converted pixels (BGRx -> RGB) */
+    /* Reuse thread-local storage for the write scan line, which is where we
+     * will put the converted pixels (BGRx -> RGB) */
     int write_stride = cinfo.image_width * cinfo.input_components;
-    unsigned char *scanline_data = malloc(write_stride);
-    memset(scanline_data, 0, write_stride);
+    unsigned char *scanline_data = guac_scratch_get(
+            GUAC_SCRATCH_JPEG_SCANLINE, write_stride);
+    if (scanline_data == NULL) {
+        jpeg_destroy_compress(&cinfo);
+        guac_error = GUAC_STATUS_NO_MEMORY;
+        guac_error_message = "Unable to allocate JPEG scanline";
+        return -1;
+    }
 #endif
 
     /* Initialize the JPEG compressor */
@@ -253,10 +260,6 @@ int guac_jpeg_write(guac_socket* socket, guac_stream* stream,
         jpeg_write_scanlines(&cinfo, row_pointer, 1);
     }
 
-#ifndef JCS_EXTENSIONS
-    free(scanline_data);
-#endif
-
     /* Finalize compression */
     jpeg_finish_compress(&cinfo);
 
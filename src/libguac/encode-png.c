@@ -23,6 +23,7 @@
 #include "error.h"
 #include "palette.h"
 #include "protocol.h"
+#include "scratch.h"
 #include "stream.h"
 
 #include <png.h>
@@ -265,38 +266,114 @@ static void guac_png_flush_handler(png_structp png) {
 
 }
 
-int guac_png_write(guac_socket* socket, guac_stream* stream,
-        cairo_surface_t* surface) {
+/**
+ * Encodes the given surface, or the given image data if no surface is given,
+ * using Cairo's PNG encoder, creating a temporary surface around the image
+ * data if necessary. This is the fallback used when image data cannot be
+ * encoded using a palette.
+ *
+ * @param socket
+ *     The socket to send PNG blobs over.
+ *
+ * @param stream
+ *     The stream to associate with each blob.
+ *
+ * @param surface
+ *     The Cairo surface containing the given image data, or NULL if the image
+ *     data is not associated with any surface.
+ *
+ * @param data
+ *     The image data to encode, in the format of CAIRO_FORMAT_RGB24.
+ *
+ * @param width
+ *     The width of the image, in pixels.
+ *
+ * @param height
+ *     The height of the image, in pixels.
+ *
+ * @param stride
+ *     The number of bytes between the start of each row of image data.
+ *
+ * @return
+ *     Zero if the encoding operation is successful, non-zero otherwise.
+ */
+static int guac_png_cairo_write_data(guac_socket* socket,
+        guac_stream* stream, cairo_surface_t* surface, unsigned char* data,
+        int width, int height, int stride) {
+
+    int result;
+
+    /* Use existing surface, if any */
+    if (surface != NULL)
+        return guac_png_cairo_write(socket, stream, surface);
+
+    surface = cairo_image_surface_create_for_data(data, CAIRO_FORMAT_RGB24,
+            width, height, stride);
+
+    result = guac_png_cairo_write(socket, stream, surface);
+
+    cairo_surface_destroy(surface);
+    return result;
+
+}
+
+/**
+ * Encodes the given RGB24 image data as a palette-based PNG built within
+ * thread-local scratch memory, falling back to Cairo's PNG encoder if the
+ * image contains too many colors.
+ *
+ * @param socket
+ *     The socket to send PNG blobs over.
+ *
+ * @param stream
+ *     The stream to associate with each blob.
+ *
+ * @param surface
+ *     The Cairo surface containing the given image data, or NULL if the image
+ *     data is not associated with any surface.
+ *
+ * @param data
+ *     The image data to encode, in the format of CAIRO_FORMAT_RGB24.
+ *
+ * @param width
+ *     The width of the image, in pixels.
+ *
+ * @param height
+ *     The height of the image, in pixels.
+ *
+ * @param stride
+ *     The number of bytes between the start of each row of image data.
+ *
+ * @return
+ *     Zero if the encoding operation is successful, non-zero otherwise.
+ */
+static int guac_png_write_rgb24(guac_socket* socket, guac_stream* stream,
+        cairo_surface_t* surface, unsigned char* data, int width, int height,
+        int stride) {
 
     png_structp png;
     png_infop png_info;
     png_byte** png_rows;
+    png_byte* png_data;
     int bpp;
 
     int x, y;
 
     guac_png_write_state write_state;
 
-    /* Get image surface properties and data */
-    cairo_format_t format = cairo_image_surface_get_format(surface);
-    int width = cairo_image_surface_get_width(surface);
-    int height = cairo_image_surface_get_height(surface);
-    int stride = cairo_image_surface_get_stride(surface);
-    unsigned char* data = cairo_image_surface_get_data(surface);
-
-    /* If not RGB24, use Cairo PNG writer */
-    if (format != CAIRO_FORMAT_RGB24 || data == NULL)
-        return guac_png_cairo_write(socket, stream, surface);
-
-    /* Flush pending operations to surface */
-    cairo_surface_flush(surface);
+    /* Reuse thread-local storage for palette and pixel data */
+    guac_palette* palette = guac_scratch_get(GUAC_SCRATCH_PNG_PALETTE,
+            sizeof(guac_palette));
+    png_rows = guac_scratch_get(GUAC_SCRATCH_PNG_ROW_POINTERS,
+            sizeof(png_byte*) * height);
+    png_data = guac_scratch_get(GUAC_SCRATCH_PNG_ROWS,
+            sizeof(png_byte) * width * height);
 
-    /* Attempt to build palette */
-    guac_palette* palette = guac_palette_alloc(surface);
-
-    /* If not possible, resort to Cairo PNG writer */
-    if (palette == NULL)
-        return guac_png_cairo_write(socket, stream, surface);
+    /* If not possible to build palette, resort to Cairo PNG writer */
+    if (palette == NULL || png_rows == NULL || png_data == NULL
+            || guac_palette_build(palette, data, width, height, stride))
+        return guac_png_cairo_write_data(socket, stream, surface,
+                data, width, height, stride);
 
     /* Calculate BPP from palette size */
     if      (palette->size <= 2)  bpp = 1;
@@ -307,7 +384,6 @@ int guac_png_write(guac_socket* socket, guac_stream* stream,
     /* Set up PNG writer */
     png = png_create_write_struct(PNG_LIBPNG_VER_STRING, NULL, NULL, NULL);
     if (!png) {
-        guac_palette_free(palette);
         guac_error = GUAC_STATUS_INTERNAL_ERROR;
         guac_error_message = "libpng failed to create write structure";
         return -1;
@@ -316,7 +392,6 @@ int guac_png_write(guac_socket* socket, guac_stream* stream,
     png_info = png_create_info_struct(png);
     if (!png_info) {
         png_destroy_write_struct(&png, NULL);
-        guac_palette_free(palette);
         guac_error = GUAC_STATUS_INTERNAL_ERROR;
         guac_error_message = "libpng failed to create info structure";
         return -1;
@@ -325,7 +400,6 @@ int guac_png_write(guac_socket* socket, guac_stream* stream,
     /* Set error handler */
     if (setjmp(png_jmpbuf(png))) {
         png_destroy_write_struct(&png, &png_info);
-        guac_palette_free(palette);
         guac_error = GUAC_STATUS_IO_ERROR;
         guac_error_message = "libpng output error";
         return -1;
@@ -342,11 +416,10 @@ int guac_png_write(guac_socket* socket, guac_stream* stream,
             guac_png_flush_handler);
 
     /* Copy data from surface into PNG data */
-    png_rows = (png_byte**) malloc(sizeof(png_byte*) * height);
     for (y=0; y<height; y++) {
 
-        /* Allocate new PNG row */
-        png_byte* row = (png_byte*) malloc(sizeof(png_byte) * width);
+        /* Point to next PNG row within scratch storage */
+        png_byte* row = png_data + y * width;
         png_rows[y] = row;
 
         /* Copy data from surface into current row */
@@ -388,17 +461,37 @@ int guac_png_write(guac_socket* socket, guac_stream* stream,
     /* Finish write */
     png_destroy_write_struct(&png, &png_info);
 
-    /* Free palette */
-    guac_palette_free(palette);
-
-    /* Free PNG data */
-    for (y=0; y<height; y++)
-        free(png_rows[y]);
-    free(png_rows);
-
     /* Ensure all data is written */
     guac_png_flush_data(&write_state);
     return 0;
 
 }
 
+
+int guac_png_write(guac_socket* socket, guac_stream* stream,
+        cairo_surface_t* surface) {
+
+    /* Get image surface properties and data */
+    cairo_format_t format = cairo_image_surface_get_format(surface);
+    int width = cairo_image_surface_get_width(surface);
+    int height = cairo_image_surface_get_height(surface);
+    int stride = cairo_image_surface_get_stride(surface);
+    unsigned char* data = cairo_image_surface_get_data(surface);
+
+    /* If not RGB24, use Cairo PNG writer */
+    if (format != CAIRO_FORMAT_RGB24 || data == NULL)
+        return guac_png_cairo_write(socket, stream, surface);
+
+    /* Flush pending operations to surface */
+    cairo_surface_flush(surface);
+
+    return guac_png_write_rgb24(socket, stream, surface,
+            data, width, height, stride);
+
+}
+
+int guac_png_write_buffer(guac_socket* socket, guac_stream* stream,
+        unsigned char* data, int width, int height, int stride) {
+    return guac_png_write_rgb24(socket, stream, NULL,
+            data, width, height, stride);
+}
@@ -46,5 +46,35 @@
 int guac_png_write(guac_socket* socket, guac_stream* stream,
         cairo_surface_t* surface);
 
+/**
+ * Encodes the given RGB24 image data as a PNG, and sends the resulting data
+ * over the given stream and socket as blobs. Unlike guac_png_write(), no
+ * Cairo surface is needed, and none is created unless the image contains too
+ * many colors to be encoded using a palette.
+ *
+ * @param socket
+ *     The socket to send PNG blobs over.
+ *
+ * @param stream
+ *     The stream to associate with each blob.
+ *
+ * @param data
+ *     The image data to encode, in the format of CAIRO_FORMAT_RGB24.
+ *
+ * @param width
+ *     The width of the image, in pixels.
+ *
+ * @param height
+ *     The height of the image, in pixels.
+ *
+ * @param stride
+ *     The number of bytes between the start of each row of image data.
+ *
+ * @return
+ *     Zero if the encoding operation is successful, non-zero otherwise.
+ */
+int guac_png_write_buffer(guac_socket* socket, guac_stream* stream,
+        unsigned char* data, int width, int height, int stride);
+
 #endif
 
@@ -0,0 +1,159 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef _GUAC_ARENA_H
+#define _GUAC_ARENA_H
+
+/**
+ * Provides functions for allocating short-lived, thread-local memory which
+ * need not be freed individually. Memory is allocated from an arena owned by
+ * the calling thread, and is reclaimed all at once, either by releasing the
+ * arena back to a previously-obtained mark, or when the calling thread ends a
+ * frame with guac_client_end_frame(). Once the arena has grown to the size
+ * required by a thread's workload, allocations no longer touch the heap.
+ *
+ * @file arena.h
+ */
+
+#include <stddef.h>
+
+/**
+ * The alignment of all memory returned by guac_arena_alloc(), in bytes.
+ */
+#define GUAC_ARENA_ALIGNMENT 16
+
+/**
+ * The minimum size of each block of memory allocated from the heap to back
+ * the arena of a thread, in bytes.
+ */
+#define GUAC_ARENA_BLOCK_SIZE 65536
+
+/**
+ * The number of times the arena of a thread may be reset before its blocks
+ * are considered for trimming. Blocks not used at all within that many
+ * resets are freed, as are blocks larger than GUAC_ARENA_BLOCK_SIZE of which
+ * no more than half was needed at once.
+ */
+#define GUAC_ARENA_TRIM_INTERVAL 256
+
+/**
+ * A position within the arena of the calling thread. All memory allocated
+ * after a mark was obtained is reclaimed when the arena is released back to
+ * that mark.
+ */
+typedef struct guac_arena_mark {
+
+    /**
+     * The index of the arena block which was current when the mark was
+     * obtained.
+     */
+    int block;
+
+    /**
+     * The number of bytes of that block which were in use when the mark was
+     * obtained.
+     */
+    size_t used;
+
+} guac_arena_mark;
+
+/**
+ * Allocates the given number of bytes from the arena of the calling thread.
+ * The returned memory MUST NOT be freed with free(), and remains valid only
+ * until the arena is released to a mark obtained before this call, or until
+ * the arena is reset.
+ *
+ * @param size
+ *     The number of bytes to allocate.
+ *
+ * @return
+ *     A pointer to at least the given number of bytes, aligned to
+ *     GUAC_ARENA_ALIGNMENT, or NULL if the arena could not be grown.
+ */
+void* guac_arena_alloc(size_t size);
+
+/**
+ * Returns the current position within the arena of the calling thread, such
+ * that all memory allocated from this point forward may later be reclaimed
+ * with guac_arena_release().
+ *
+ * @return
+ *     The current position within the arena of the calling thread.
+ */
+guac_arena_mark guac_arena_get_mark();
+
+/**
+ * Reclaims all memory allocated from the arena of the calling thread since
+ * the given mark was obtained. The heap memory backing the arena is kept for
+ * reuse.
+ *
+ * @param mark
+ *     A mark previously returned by guac_arena_get_mark() within the calling
+ *     thread.
+ */
+void guac_arena_release(guac_arena_mark mark);
+
+/**
+ * Reclaims all memory allocated from the arena of the calling thread. This is
+ * invoked automatically by guac_client_end_frame(), and thus memory allocated
+ * from the arena MUST NOT be used across the end of a frame by the thread
+ * ending that frame. The heap memory backing the arena is kept for reuse,
+ * except that every GUAC_ARENA_TRIM_INTERVAL resets, memory which was not
+ * needed during that interval is freed.
+ */
+void guac_arena_reset();
+
+/**
+ * Returns the number of heap allocations performed by the arena of the
+ * calling thread since the arena was last reset. When the arena has grown to
+ * fit the workload of the calling thread, this will be zero at the end of
+ * each frame.
+ *
+ * @return
+ *     The number of heap allocations performed by the arena since the last
+ *     reset.
+ */
+int guac_arena_heap_allocations();
+
+/**
+ * Returns the number of calls to malloc(), calloc() and realloc() made by
+ * the calling thread since its arena was last reset, whether by libguac or
+ * by any other code. This value is only tracked if libguac was built with
+ * --enable-arena-stats, which replaces the allocator functions of the
+ * process with counting wrappers, and is always zero otherwise.
+ *
+ * @return
+ *     The number of allocations made by the calling thread since the last
+ *     reset.
+ */
+int guac_arena_malloc_count();
+
+/**
+ * Returns the number of calls to free() and realloc() on non-NULL pointers
+ * made by the calling thread since its arena was last reset. As with
+ * guac_arena_malloc_count(), this value is only tracked if libguac was
+ * built with --enable-arena-stats, and is always zero otherwise.
+ *
+ * @return
+ *     The number of frees made by the calling thread since the last reset.
+ */
+int guac_arena_free_count();
+
+#endif
+
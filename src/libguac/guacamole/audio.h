@@ -108,6 +108,30 @@ struct guac_audio_stream {
      */
     void* data;
 
+    /**
+     * The minimum duration of audio, in milliseconds, to accumulate before
+     * that audio is automatically flushed by guac_audio_stream_write_pcm().
+     * If zero, audio is only sent when guac_audio_stream_flush() is invoked
+     * explicitly or when the encoder's own buffer is full. Larger values
+     * result in fewer, larger blobs at the cost of added latency. This is
+     * zero by default.
+     */
+    int packet_interval;
+
+    /**
+     * Non-zero if PCM data written to this stream which consists entirely of
+     * silence should be discarded rather than sent, zero otherwise. Any audio
+     * buffered prior to discarded silence is flushed immediately. This is
+     * zero by default.
+     */
+    int suppress_silence;
+
+    /**
+     * The number of bytes of PCM data written to this stream since it was
+     * last flushed.
+     */
+    int __pending;
+
 };
 
 /**
@@ -207,7 +231,11 @@ void guac_audio_stream_free(guac_audio_stream* stream);
 /**
  * Writes PCM data to the given audio stream. This PCM data will be
  * automatically encoded by the audio encoder associated with this stream. The
- * PCM data must be 2-channel, 44100 Hz, with signed 16-bit samples.
+ * PCM data must be 2-channel, 44100 Hz, with signed 16-bit samples. If
+ * silence suppression is enabled and the PCM data is entirely silent, it is
+ * discarded and the stream is flushed instead. If a packetization interval is
+ * set, the stream is flushed automatically once at least that much audio has
+ * been written since the last flush.
  *
  * @param stream
  *     The guac_audio_stream to write PCM data through.
@@ -34,6 +34,13 @@
  */
 typedef struct guac_client guac_client;
 
+/**
+ * An immutable snapshot of the users connected to a guac_client. The
+ * structure of this snapshot is internal to guac_client, and connected users
+ * should instead be iterated with guac_client_foreach_user().
+ */
+typedef struct guac_client_user_list guac_client_user_list;
+
 /**
  * Possible current states of the Guacamole client. Currently, the only
  * two states are GUAC_CLIENT_RUNNING and GUAC_CLIENT_STOPPING.
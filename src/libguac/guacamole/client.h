@@ -163,23 +163,33 @@ struct guac_client {
     char* connection_id;
 
     /**
-     * Lock which is acquired when the users list is being manipulated, or when
-     * the users list is being iterated.
+     * Lock which is acquired when the users list is being replaced. This
+     * lock serializes updates to the users list, and is held while leave
+     * handlers run. The users list is iterated without acquiring any lock,
+     * and this lock is not held while join handlers run.
      */
-    pthread_rwlock_t __users_lock;
+    pthread_mutex_t __users_lock;
 
     /**
-     * The first user within the list of all connected users, or NULL if no
-     * users are currently connected.
+     * Immutable snapshot of all connected users, including the owner of the
+     * connection, if still connected. This snapshot is replaced atomically
+     * whenever a user joins or leaves, and the previous snapshot is freed
+     * only once no thread may still be iterating it.
      */
-    guac_user* __users;
+    guac_client_user_list* __users;
 
     /**
-     * The user that first created this connection. This user will also have
-     * their "owner" flag set to a non-zero value. If the owner has left the
-     * connection, this will be NULL.
+     * The current epoch of the users list, either 0 or 1. Threads iterating
+     * the users list register themselves within the counter for the current
+     * epoch, and the epoch is flipped each time the users list is replaced.
      */
-    guac_user* __owner;
+    int __users_epoch;
+
+    /**
+     * The number of threads currently iterating the users list, for each of
+     * the two possible values of __users_epoch.
+     */
+    int __users_readers[2];
 
     /**
      * The number of currently-connected users. This value may include inactive
@@ -406,7 +416,14 @@ void guac_client_free_stream(guac_client* client, guac_stream* stream);
 /**
  * Adds the given user to the internal list of connected users. Future writes
  * to the broadcast socket stored within guac_client will also write to this
- * user. The join handler of this guac_client will be called.
+ * user. The join handler of this guac_client will be called before the user
+ * is added, without holding any lock that would block output to other users.
+ * The user begins receiving broadcast output just before the join handler is
+ * called, so no update made after the join handler has synchronized the
+ * user's view of the connection is missed. The user is not visible to
+ * guac_client_foreach_user() and similar functions until the join handler
+ * has returned successfully. If the join handler fails, the user stops
+ * receiving broadcast output and is not added.
  *
  * @param client The proxy client to add the user to.
  * @param user The user to add.
@@ -419,7 +436,10 @@ int guac_client_add_user(guac_client* client, guac_user* user, int argc, char**
 
 /**
  * Removes the given user, removing the user from the internally-tracked list
- * of connected users, and calling any appropriate leave handler.
+ * of connected users, and calling any appropriate leave handler. The leave
+ * handler is called only after the user has been removed and no other thread
+ * can still be invoking a guac_client_foreach_user() (or similar) callback
+ * with that user.
  *
  * @param client The proxy client to return the buffer to.
  * @param user The user to remove.
@@ -599,6 +619,51 @@ void guac_client_stream_png(guac_client* client, guac_socket* socket,
         guac_composite_mode mode, const guac_layer* layer, int x, int y,
         cairo_surface_t* surface);
 
+/**
+ * Streams the given RGB24 image data over an image stream ("img"
+ * instruction) as PNG-encoded data, exactly as guac_client_stream_png()
+ * would stream a surface containing that data. No Cairo surface needs to be
+ * created to wrap the image data, and thus a rectangle within a larger image
+ * can be streamed by pointing to its first pixel and using the stride of the
+ * larger image. The image stream will be automatically allocated and freed.
+ *
+ * @param client
+ *     The Guacamole client for which the image stream should be allocated.
+ *
+ * @param socket
+ *     The socket over which instructions associated with the image stream
+ *     should be sent.
+ *
+ * @param mode
+ *     The composite mode to use when rendering the image over the given layer.
+ *
+ * @param layer
+ *     The destination layer.
+ *
+ * @param x
+ *     The X coordinate of the upper-left corner of the destination rectangle
+ *     within the given layer.
+ *
+ * @param y
+ *     The Y coordinate of the upper-left corner of the destination rectangle
+ *     within the given layer.
+ *
+ * @param data
+ *     The image data to be streamed, in the format of CAIRO_FORMAT_RGB24.
+ *
+ * @param width
+ *     The width of the image, in pixels.
+ *
+ * @param height
+ *     The height of the image, in pixels.
+ *
+ * @param stride
+ *     The number of bytes between the start of each row of image data.
+ */
+void guac_client_stream_png_buffer(guac_client* client, guac_socket* socket,
+        guac_composite_mode mode, const guac_layer* layer, int x, int y,
+        unsigned char* data, int width, int height, int stride);
+
 /**
  * Streams the image data of the given surface over an image stream ("img"
  * instruction) as JPEG-encoded data at the given quality. The image stream
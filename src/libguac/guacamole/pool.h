@@ -66,6 +66,14 @@ struct guac_pool {
      */
     pthread_mutex_t __lock;
 
+    /**
+     * Stack of guac_pool_int entries which are not currently within the
+     * pool, and which are reused when integers are freed rather than
+     * allocating new entries. Entries are only freed when the pool itself
+     * is freed.
+     */
+    guac_pool_int* __unused;
+
 };
 
 struct guac_pool_int {
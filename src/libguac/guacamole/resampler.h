@@ -0,0 +1,125 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef _GUAC_RESAMPLER_H
+#define _GUAC_RESAMPLER_H
+
+/**
+ * Provides functions for converting blocks of PCM audio between sample rates,
+ * numbers of channels, and sample sizes. Conversion is stateful, such that
+ * audio split arbitrarily across successive blocks (even mid-sample) converts
+ * identically to audio provided all at once.
+ *
+ * @file resampler.h
+ */
+
+#include "resampler-types.h"
+
+/**
+ * The maximum number of input frames converted by a single pass through a
+ * guac_resampler. Larger blocks of audio are converted in multiple passes,
+ * bounding the size of the resampler's internal buffers.
+ */
+#define GUAC_RESAMPLER_CHUNK_FRAMES 4096
+
+/**
+ * Allocates a new resampler which converts signed PCM audio in host byte
+ * order from the given input format to the given output format. The
+ * conversion routines used are selected once, here, based on the specific
+ * pair of formats given. If the input and output rates differ, the audio is
+ * resampled using linear interpolation.
+ *
+ * @param in_rate
+ *     The number of samples per second of the input audio.
+ *
+ * @param in_channels
+ *     The number of channels within the input audio. Legal values are 1 or 2.
+ *
+ * @param in_bps
+ *     The number of bits per sample per channel of the input audio. Legal
+ *     values are 8 or 16.
+ *
+ * @param out_rate
+ *     The number of samples per second of the output audio.
+ *
+ * @param out_channels
+ *     The number of channels within the output audio. Legal values are 1 or
+ *     2.
+ *
+ * @param out_bps
+ *     The number of bits per sample per channel of the output audio. Legal
+ *     values are 8 or 16.
+ *
+ * @return
+ *     A newly-allocated resampler, or NULL if either format is not
+ *     supported.
+ */
+guac_resampler* guac_resampler_alloc(int in_rate, int in_channels, int in_bps,
+        int out_rate, int out_channels, int out_bps);
+
+/**
+ * Returns the maximum number of bytes of output which may be produced by a
+ * call to guac_resampler_convert() given the provided number of bytes of
+ * input.
+ *
+ * @param resampler
+ *     The resampler that would perform the conversion.
+ *
+ * @param length
+ *     The number of bytes of input audio.
+ *
+ * @return
+ *     The maximum number of bytes of output audio that could be produced.
+ */
+int guac_resampler_max_output(guac_resampler* resampler, int length);
+
+/**
+ * Converts the given block of input audio, writing the converted audio to
+ * the given output buffer. All input is consumed. Any trailing partial frame
+ * of input is retained and converted upon the next call.
+ *
+ * @param resampler
+ *     The resampler to use to perform the conversion.
+ *
+ * @param input
+ *     The input audio to convert.
+ *
+ * @param length
+ *     The number of bytes of input audio.
+ *
+ * @param output
+ *     The buffer to which converted audio should be written. This buffer
+ *     must be at least guac_resampler_max_output() bytes in size.
+ *
+ * @return
+ *     The number of bytes of converted audio written to the output buffer.
+ */
+int guac_resampler_convert(guac_resampler* resampler,
+        const unsigned char* input, int length, unsigned char* output);
+
+/**
+ * Frees the given resampler and all associated resources.
+ *
+ * @param resampler
+ *     The resampler to free.
+ */
+void guac_resampler_free(guac_resampler* resampler);
+
+#endif
+
@@ -127,22 +127,6 @@ struct guac_user {
      */
     int active;
 
-    /**
-     * The previous user in the group of users within the same logical
-     * connection.  This is currently only used internally by guac_client to
-     * track its set of connected users. To iterate connected users, use
-     * guac_client_foreach_user().
-     */
-    guac_user* __prev;
-
-    /**
-     * The next user in the group of users within the same logical connection.
-     * This is currently only used internally by guac_client to track its set
-     * of connected users. To iterate connected users, use
-     * guac_client_foreach_user().
-     */
-    guac_user* __next;
-
     /**
      * The time (in milliseconds) of receipt of the last sync message from
      * the user.
@@ -28,17 +28,12 @@
 #include <stdlib.h>
 #include <string.h>
 
-guac_palette* guac_palette_alloc(cairo_surface_t* surface) {
+int guac_palette_build(guac_palette* palette, unsigned char* data,
+        int width, int height, int stride) {
 
     int x, y;
 
-    int width = cairo_image_surface_get_width(surface);
-    int height = cairo_image_surface_get_height(surface);
-    int stride = cairo_image_surface_get_stride(surface);
-    unsigned char* data = cairo_image_surface_get_data(surface);
-
-    /* Allocate palette */
-    guac_palette* palette = (guac_palette*) malloc(sizeof(guac_palette));
+    /* Clear palette */
     memset(palette, 0, sizeof(guac_palette));
 
     for (y=0; y<height; y++) {
@@ -63,10 +58,8 @@ guac_palette* guac_palette_alloc(cairo_surface_t* surface) {
                     png_color* c;
 
                     /* Stop if already at capacity */
-                    if (palette->size == 256) {
-                        guac_palette_free(palette);
-                        return NULL;
-                    }
+                    if (palette->size == 256)
+                        return 1;
 
                     /* Store in palette */
                     c = &(palette->colors[palette->size]);
@@ -97,6 +90,24 @@ guac_palette* guac_palette_alloc(cairo_surface_t* surface) {
 
     }
 
+    return 0;
+
+}
+
+guac_palette* guac_palette_alloc(cairo_surface_t* surface) {
+
+    /* Allocate palette */
+    guac_palette* palette = (guac_palette*) malloc(sizeof(guac_palette));
+
+    /* Build palette, failing if too many colors */
+    if (guac_palette_build(palette, cairo_image_surface_get_data(surface),
+                cairo_image_surface_get_width(surface),
+                cairo_image_surface_get_height(surface),
+                cairo_image_surface_get_stride(surface))) {
+        guac_palette_free(palette);
+        return NULL;
+    }
+
     return palette;
 
 }
@@ -40,6 +40,36 @@ typedef struct guac_palette {
 } guac_palette;
 
 guac_palette* guac_palette_alloc(cairo_surface_t* surface);
+
+/**
+ * Builds a palette of all colors within the given RGB24 image data, storing
+ * that palette within the given, caller-provided palette structure. Unlike
+ * guac_palette_alloc(), no memory is allocated.
+ *
+ * @param palette
+ *     The palette structure to populate. Any existing contents are
+ *     overwritten.
+ *
+ * @param data
+ *     The image data whose colors should be stored in the palette, in the
+ *     format of CAIRO_FORMAT_RGB24.
+ *
+ * @param width
+ *     The width of the image, in pixels.
+ *
+ * @param height
+ *     The height of the image, in pixels.
+ *
+ * @param stride
+ *     The number of bytes between the start of each row of image data.
+ *
+ * @return
+ *     Zero if the palette was built successfully, non-zero if the image
+ *     contains more than 256 colors.
+ */
+int guac_palette_build(guac_palette* palette, unsigned char* data,
+        int width, int height, int stride);
+
 int guac_palette_find(guac_palette* palette, int color);
 void guac_palette_free(guac_palette* palette);
 
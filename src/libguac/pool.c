@@ -38,6 +38,7 @@ guac_pool* guac_pool_alloc(int size) {
     pool->__next_value = 0;
     pool->__head = NULL;
     pool->__tail = NULL;
+    pool->__unused = NULL;
 
     /* Init lock */
     pthread_mutexattr_init(&lock_attributes);
@@ -60,6 +61,16 @@ void guac_pool_free(guac_pool* pool) {
         free(old);
     }
 
+    /* Free all unused entries */
+    current = pool->__unused;
+    while (current != NULL) {
+
+        guac_pool_int* old = current;
+        current = current->__next;
+
+        free(old);
+    }
+
     /* Destroy lock */
     pthread_mutex_destroy(&(pool->__lock));
 
@@ -71,6 +82,7 @@ void guac_pool_free(guac_pool* pool) {
 int guac_pool_next_int(guac_pool* pool) {
 
     int value;
+    guac_pool_int* old_head;
 
     /* Acquire exclusive access */
     pthread_mutex_lock(&(pool->__lock));
@@ -85,21 +97,22 @@ int guac_pool_next_int(guac_pool* pool) {
     }
 
     /* Otherwise, remove first integer. */
-    value = pool->__head->value;
+    old_head = pool->__head;
+    value = old_head->value;
 
     /* If only one element exists, reset pool to empty. */
-    if (pool->__tail == pool->__head) {
-        free(pool->__head);
+    if (pool->__tail == old_head) {
         pool->__head = NULL;
         pool->__tail = NULL;
     }
 
     /* Otherwise, advance head. */
-    else {
-        guac_pool_int* old_head = pool->__head;
+    else
         pool->__head = old_head->__next;
-        free(old_head);
-    }
+
+    /* Keep entry for reuse by guac_pool_free_int() */
+    old_head->__next = pool->__unused;
+    pool->__unused = old_head;
 
     /* Return retrieved value. */
     pthread_mutex_unlock(&(pool->__lock));
@@ -108,16 +121,31 @@ int guac_pool_next_int(guac_pool* pool) {
 
 void guac_pool_free_int(guac_pool* pool, int value) {
 
-    /* Allocate and initialize new returned value */
-    guac_pool_int* pool_int = malloc(sizeof(guac_pool_int));
-    pool_int->value = value;
-    pool_int->__next = NULL;
+    guac_pool_int* pool_int;
 
     /* Acquire exclusive access */
     pthread_mutex_lock(&(pool->__lock));
 
     pool->active--;
 
+    /* Reuse an unused entry, if any */
+    pool_int = pool->__unused;
+    if (pool_int != NULL)
+        pool->__unused = pool_int->__next;
+
+    /* Otherwise, allocate a new entry. If this fails, the value is simply
+     * never returned to the pool. */
+    else {
+        pool_int = malloc(sizeof(guac_pool_int));
+        if (pool_int == NULL) {
+            pthread_mutex_unlock(&(pool->__lock));
+            return;
+        }
+    }
+
+    pool_int->value = value;
+    pool_int->__next = NULL;
+
     /* If pool empty, store as sole entry. */
     if (pool->__tail == NULL)
         pool->__head = pool->__tail = pool_int;
@@ -132,4 +160,3 @@ void guac_pool_free_int(guac_pool* pool, int value) {
     pthread_mutex_unlock(&(pool->__lock));
 
 }
-
@@ -0,0 +1,506 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "config.h"
+
+#include "resampler.h"
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * Function which decodes the given number of frames of input audio into
+ * signed 16-bit samples having the number of channels of the output audio.
+ *
+ * @param input
+ *     The input audio to decode.
+ *
+ * @param frames
+ *     The number of frames of input audio to decode.
+ *
+ * @param output
+ *     The buffer which should receive the decoded samples.
+ */
+typedef void guac_resampler_decoder(const unsigned char* input, int frames,
+        int16_t* output);
+
+/**
+ * Function which encodes the given number of signed 16-bit samples as
+ * samples of the output audio.
+ *
+ * @param input
+ *     The samples to encode.
+ *
+ * @param samples
+ *     The number of samples to encode (frames multiplied by channels).
+ *
+ * @param output
+ *     The buffer which should receive the encoded samples.
+ */
+typedef void guac_resampler_encoder(const int16_t* input, int samples,
+        unsigned char* output);
+
+struct guac_resampler {
+
+    /**
+     * The number of bytes in each frame of input audio.
+     */
+    int in_frame_size;
+
+    /**
+     * The number of channels within the output audio.
+     */
+    int out_channels;
+
+    /**
+     * The number of bytes in each frame of output audio.
+     */
+    int out_frame_size;
+
+    /**
+     * The decoder which translates input frames to 16-bit samples having the
+     * output number of channels.
+     */
+    guac_resampler_decoder* decode;
+
+    /**
+     * The encoder which translates 16-bit samples to output samples.
+     */
+    guac_resampler_encoder* encode;
+
+    /**
+     * The number of input frames to advance for each output frame, as a 16.16
+     * fixed-point value, or zero if the input and output rates are identical.
+     */
+    uint32_t step;
+
+    /**
+     * The position of the next output frame relative to the previous frame,
+     * as a 16.16 fixed-point number of input frames.
+     */
+    uint32_t position;
+
+    /**
+     * The last decoded input frame of the previous pass, from which the
+     * first output frames of the next pass are interpolated.
+     */
+    int16_t previous[2];
+
+    /**
+     * Any trailing partial frame of input audio from the previous call to
+     * guac_resampler_convert().
+     */
+    unsigned char partial[4];
+
+    /**
+     * The number of bytes stored within the partial frame buffer.
+     */
+    int partial_length;
+
+    /**
+     * Buffer of decoded input frames, large enough for
+     * GUAC_RESAMPLER_CHUNK_FRAMES frames.
+     */
+    int16_t* decoded;
+
+    /**
+     * Buffer of interpolated output frames, large enough for the output of
+     * GUAC_RESAMPLER_CHUNK_FRAMES input frames, or NULL if the input and
+     * output rates are identical.
+     */
+    int16_t* resampled;
+
+};
+
+/**
+ * Reads a signed 16-bit sample from the given, possibly unaligned, location.
+ */
+static int16_t guac_resampler_read_s16(const unsigned char* input) {
+    int16_t sample;
+    memcpy(&sample, input, sizeof(sample));
+    return sample;
+}
+
+/**
+ * Decodes 16-bit input having the same number of channels as the output.
+ */
+static void guac_resampler_decode_s16(const unsigned char* input, int frames,
+        int16_t* output, int channels) {
+    memcpy(output, input, frames * channels * sizeof(int16_t));
+}
+
+/**
+ * Decoder for 16-bit mono input and mono output.
+ */
+static void guac_resampler_decode_s16_mono(const unsigned char* input,
+        int frames, int16_t* output) {
+    guac_resampler_decode_s16(input, frames, output, 1);
+}
+
+/**
+ * Decoder for 16-bit stereo input and stereo output.
+ */
+static void guac_resampler_decode_s16_stereo(const unsigned char* input,
+        int frames, int16_t* output) {
+    guac_resampler_decode_s16(input, frames, output, 2);
+}
+
+/**
+ * Decoder for 16-bit mono input and stereo output.
+ */
+static void guac_resampler_decode_s16_mono_to_stereo(
+        const unsigned char* input, int frames, int16_t* output) {
+
+    int i;
+    for (i = 0; i < frames; i++) {
+        int16_t sample = guac_resampler_read_s16(input + i * 2);
+        output[i * 2]     = sample;
+        output[i * 2 + 1] = sample;
+    }
+
+}
+
+/**
+ * Decoder for 16-bit stereo input and mono output, averaging both channels.
+ */
+static void guac_resampler_decode_s16_stereo_to_mono(
+        const unsigned char* input, int frames, int16_t* output) {
+
+    int i;
+    for (i = 0; i < frames; i++) {
+        int left  = guac_resampler_read_s16(input + i * 4);
+        int right = guac_resampler_read_s16(input + i * 4 + 2);
+        output[i] = (left + right) / 2;
+    }
+
+}
+
+/**
+ * Decodes 8-bit input having the same number of channels as the output.
+ */
+static void guac_resampler_decode_s8(const unsigned char* input, int frames,
+        int16_t* output, int channels) {
+
+    int i;
+    const int8_t* samples = (const int8_t*) input;
+
+    for (i = 0; i < frames * channels; i++)
+        output[i] = samples[i] * 256;
+
+}
+
+/**
+ * Decoder for 8-bit mono input and mono output.
+ */
+static void guac_resampler_decode_s8_mono(const unsigned char* input,
+        int frames, int16_t* output) {
+    guac_resampler_decode_s8(input, frames, output, 1);
+}
+
+/**
+ * Decoder for 8-bit stereo input and stereo output.
+ */
+static void guac_resampler_decode_s8_stereo(const unsigned char* input,
+        int frames, int16_t* output) {
+    guac_resampler_decode_s8(input, frames, output, 2);
+}
+
+/**
+ * Decoder for 8-bit mono input and stereo output.
+ */
+static void guac_resampler_decode_s8_mono_to_stereo(
+        const unsigned char* input, int frames, int16_t* output) {
+
+    int i;
+    const int8_t* samples = (const int8_t*) input;
+
+    for (i = 0; i < frames; i++) {
+        int16_t sample = samples[i] * 256;
+        output[i * 2]     = sample;
+        output[i * 2 + 1] = sample;
+    }
+
+}
+
+/**
+ * Decoder for 8-bit stereo input and mono output, averaging both channels.
+ */
+static void guac_resampler_decode_s8_stereo_to_mono(
+        const unsigned char* input, int frames, int16_t* output) {
+
+    int i;
+    const int8_t* samples = (const int8_t*) input;
+
+    for (i = 0; i < frames; i++)
+        output[i] = (samples[i * 2] + samples[i * 2 + 1]) * 128;
+
+}
+
+/**
+ * Encoder for 16-bit output.
+ */
+static void guac_resampler_encode_s16(const int16_t* input, int samples,
+        unsigned char* output) {
+    memcpy(output, input, samples * sizeof(int16_t));
+}
+
+/**
+ * Encoder for 8-bit output.
+ */
+static void guac_resampler_encode_s8(const int16_t* input, int samples,
+        unsigned char* output) {
+
+    int i;
+    int8_t* encoded = (int8_t*) output;
+
+    for (i = 0; i < samples; i++)
+        encoded[i] = input[i] >> 8;
+
+}
+
+/**
+ * Decoders for each combination of input sample size and input/output
+ * channel count, indexed by [in_bps == 16][in_channels - 1][out_channels - 1].
+ */
+static guac_resampler_decoder* const guac_resampler_decoders[2][2][2] = {
+    {
+        { guac_resampler_decode_s8_mono,   guac_resampler_decode_s8_mono_to_stereo },
+        { guac_resampler_decode_s8_stereo_to_mono, guac_resampler_decode_s8_stereo }
+    },
+    {
+        { guac_resampler_decode_s16_mono,  guac_resampler_decode_s16_mono_to_stereo },
+        { guac_resampler_decode_s16_stereo_to_mono, guac_resampler_decode_s16_stereo }
+    }
+};
+
+guac_resampler* guac_resampler_alloc(int in_rate, int in_channels, int in_bps,
+        int out_rate, int out_channels, int out_bps) {
+
+    /* Only mono/stereo 8- or 16-bit audio is supported */
+    if ((in_bps != 8 && in_bps != 16) || (out_bps != 8 && out_bps != 16)
+            || in_channels < 1 || in_channels > 2
+            || out_channels < 1 || out_channels > 2
+            || in_rate <= 0 || out_rate <= 0)
+        return NULL;
+
+    guac_resampler* resampler = calloc(1, sizeof(guac_resampler));
+
+    resampler->in_frame_size = in_channels * in_bps / 8;
+    resampler->out_channels = out_channels;
+    resampler->out_frame_size = out_channels * out_bps / 8;
+
+    /* Select conversion routines for this specific pair of formats */
+    resampler->decode =
+        guac_resampler_decoders[in_bps == 16][in_channels - 1][out_channels - 1];
+
+    if (out_bps == 16)
+        resampler->encode = guac_resampler_encode_s16;
+    else
+        resampler->encode = guac_resampler_encode_s8;
+
+    resampler->decoded = malloc(GUAC_RESAMPLER_CHUNK_FRAMES
+            * out_channels * sizeof(int16_t));
+
+    /* Interpolation is needed only if rates differ */
+    if (in_rate != out_rate) {
+
+        resampler->step = ((uint64_t) in_rate << 16) / out_rate;
+        if (resampler->step == 0)
+            resampler->step = 1;
+
+        resampler->resampled = malloc(
+                (((uint64_t) GUAC_RESAMPLER_CHUNK_FRAMES << 16)
+                     / resampler->step + 1)
+                * out_channels * sizeof(int16_t));
+
+    }
+
+    return resampler;
+
+}
+
+int guac_resampler_max_output(guac_resampler* resampler, int length) {
+
+    uint64_t frames = (resampler->partial_length + length)
+                    / resampler->in_frame_size;
+
+    /* Without resampling, each input frame produces one output frame */
+    if (resampler->step == 0)
+        return frames * resampler->out_frame_size;
+
+    return ((frames << 16) / resampler->step + 1) * resampler->out_frame_size;
+
+}
+
+/**
+ * Linearly interpolates output frames from the given decoded input frames,
+ * continuing from the position and previous frame left by the prior pass.
+ *
+ * @param resampler
+ *     The resampler performing the interpolation.
+ *
+ * @param frames
+ *     The number of decoded input frames available within the resampler's
+ *     decoded buffer.
+ *
+ * @return
+ *     The number of frames written to the resampler's resampled buffer.
+ */
+static int guac_resampler_interpolate(guac_resampler* resampler,
+        int frames) {
+
+    int c;
+    int written = 0;
+    int channels = resampler->out_channels;
+
+    const int16_t* decoded = resampler->decoded;
+    int16_t* output = resampler->resampled;
+
+    /* Produce each output frame lying between available input frames,
+     * where index zero refers to the last frame of the previous pass */
+    while ((resampler->position >> 16) < frames) {
+
+        int index = resampler->position >> 16;
+
+        /* Drop lowest bit of fraction so products fit within an int */
+        int fraction = (resampler->position & 0xFFFF) >> 1;
+
+        const int16_t* a = (index == 0) ? resampler->previous
+                                        : decoded + (index - 1) * channels;
+        const int16_t* b = decoded + index * channels;
+
+        for (c = 0; c < channels; c++)
+            *(output++) = a[c] + (((b[c] - a[c]) * fraction) >> 15);
+
+        resampler->position += resampler->step;
+        written++;
+
+    }
+
+    /* Continue relative to the last frame of this pass */
+    resampler->position -= frames << 16;
+    memcpy(resampler->previous, decoded + (frames - 1) * channels,
+            channels * sizeof(int16_t));
+
+    return written;
+
+}
+
+/**
+ * Converts the given number of whole input frames, which must not exceed
+ * GUAC_RESAMPLER_CHUNK_FRAMES.
+ *
+ * @param resampler
+ *     The resampler to use to perform the conversion.
+ *
+ * @param input
+ *     The input frames to convert.
+ *
+ * @param frames
+ *     The number of input frames to convert.
+ *
+ * @param output
+ *     The buffer to which converted audio should be written.
+ *
+ * @return
+ *     The number of bytes of converted audio written.
+ */
+static int guac_resampler_convert_frames(guac_resampler* resampler,
+        const unsigned char* input, int frames, unsigned char* output) {
+
+    resampler->decode(input, frames, resampler->decoded);
+
+    /* Re-encode directly if no resampling is needed */
+    if (resampler->step == 0) {
+        resampler->encode(resampler->decoded,
+                frames * resampler->out_channels, output);
+        return frames * resampler->out_frame_size;
+    }
+
+    frames = guac_resampler_interpolate(resampler, frames);
+    resampler->encode(resampler->resampled,
+            frames * resampler->out_channels, output);
+
+    return frames * resampler->out_frame_size;
+
+}
+
+int guac_resampler_convert(guac_resampler* resampler,
+        const unsigned char* input, int length, unsigned char* output) {
+
+    int frames;
+    int written = 0;
+    int in_frame_size = resampler->in_frame_size;
+
+    /* Complete any partial frame left by the previous call */
+    if (resampler->partial_length > 0) {
+
+        int needed = in_frame_size - resampler->partial_length;
+
+        /* Store input and wait for more if still incomplete */
+        if (length < needed) {
+            memcpy(resampler->partial + resampler->partial_length,
+                    input, length);
+            resampler->partial_length += length;
+            return 0;
+        }
+
+        memcpy(resampler->partial + resampler->partial_length,
+                input, needed);
+        input += needed;
+        length -= needed;
+
+        resampler->partial_length = 0;
+        written += guac_resampler_convert_frames(resampler,
+                resampler->partial, 1, output);
+
+    }
+
+    /* Convert all whole frames, one chunk at a time */
+    frames = length / in_frame_size;
+    while (frames > 0) {
+
+        int chunk = frames;
+        if (chunk > GUAC_RESAMPLER_CHUNK_FRAMES)
+            chunk = GUAC_RESAMPLER_CHUNK_FRAMES;
+
+        written += guac_resampler_convert_frames(resampler, input, chunk,
+                output + written);
+
+        input += chunk * in_frame_size;
+        length -= chunk * in_frame_size;
+        frames -= chunk;
+
+    }
+
+    /* Retain any trailing partial frame */
+    memcpy(resampler->partial, input, length);
+    resampler->partial_length = length;
+
+    return written;
+
+}
+
+void guac_resampler_free(guac_resampler* resampler) {
+    free(resampler->decoded);
+    free(resampler->resampled);
+    free(resampler);
+}
+
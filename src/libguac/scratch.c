@@ -0,0 +1,137 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "config.h"
+
+#include "scratch.h"
+
+#include <pthread.h>
+#include <stdlib.h>
+
+/**
+ * A single, reusable buffer of scratch memory.
+ */
+typedef struct guac_scratch_buffer {
+
+    /**
+     * The allocated memory, or NULL if nothing has yet been allocated.
+     */
+    void* data;
+
+    /**
+     * The number of bytes allocated.
+     */
+    size_t size;
+
+    /**
+     * The largest number of bytes requested since the buffer was last
+     * considered for trimming.
+     */
+    size_t high_water;
+
+    /**
+     * The number of requests since the buffer was last considered for
+     * trimming.
+     */
+    int requests;
+
+} guac_scratch_buffer;
+
+static pthread_key_t  __guac_scratch_key;
+static pthread_once_t __guac_scratch_key_init = PTHREAD_ONCE_INIT;
+
+/**
+ * Frees all scratch buffers allocated by a thread which is exiting.
+ *
+ * @param pointer
+ *     The array of GUAC_SCRATCH_SLOTS guac_scratch_buffer structures
+ *     associated with the exiting thread.
+ */
+static void __guac_scratch_free(void* pointer) {
+
+    guac_scratch_buffer* buffers = (guac_scratch_buffer*) pointer;
+    int i;
+
+    for (i = 0; i < GUAC_SCRATCH_SLOTS; i++)
+        free(buffers[i].data);
+
+    free(buffers);
+
+}
+
+static void __guac_alloc_scratch_key() {
+
+    /* Create key, free any allocated scratch buffers on thread exit */
+    pthread_key_create(&__guac_scratch_key, __guac_scratch_free);
+
+}
+
+void* guac_scratch_get(guac_scratch_slot slot, size_t size) {
+
+    guac_scratch_buffer* buffers;
+    guac_scratch_buffer* buffer;
+
+    /* Init scratch key, if not already initialized */
+    pthread_once(&__guac_scratch_key_init, __guac_alloc_scratch_key);
+
+    /* Retrieve thread-local scratch buffers */
+    buffers = (guac_scratch_buffer*) pthread_getspecific(__guac_scratch_key);
+
+    /* Allocate thread-local scratch buffers if not already allocated */
+    if (buffers == NULL) {
+        buffers = calloc(GUAC_SCRATCH_SLOTS, sizeof(guac_scratch_buffer));
+        if (buffers == NULL)
+            return NULL;
+        pthread_setspecific(__guac_scratch_key, buffers);
+    }
+
+    buffer = &(buffers[slot]);
+
+    /* Track largest size needed within current trim interval */
+    if (size > buffer->high_water)
+        buffer->high_water = size;
+
+    /* Release buffer if it has been much larger than needed for the entire
+     * interval (it is reallocated at the requested size below) */
+    if (++buffer->requests >= GUAC_SCRATCH_TRIM_INTERVAL) {
+
+        if (buffer->high_water <= buffer->size / 2) {
+            free(buffer->data);
+            buffer->data = NULL;
+            buffer->size = 0;
+        }
+
+        buffer->high_water = 0;
+        buffer->requests = 0;
+
+    }
+
+    /* Replace buffer only if too small (old contents need not be kept) */
+    if (buffer->size < size) {
+
+        free(buffer->data);
+        buffer->data = malloc(size);
+        buffer->size = (buffer->data != NULL) ? size : 0;
+
+    }
+
+    return buffer->data;
+
+}
+
@@ -0,0 +1,95 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef GUAC_SCRATCH_H
+#define GUAC_SCRATCH_H
+
+#include "config.h"
+
+#include <stddef.h>
+
+/**
+ * The number of requests for scratch memory for a particular purpose after
+ * which the buffer for that purpose is considered for trimming. If no request
+ * within that many requests needed more than half of the buffer, the buffer
+ * is reallocated at the size requested, such that memory allocated for an
+ * unusually large image is not retained indefinitely.
+ */
+#define GUAC_SCRATCH_TRIM_INTERVAL 256
+
+/**
+ * The purposes for which thread-local scratch memory may be requested via
+ * guac_scratch_get(). Each purpose has its own independent buffer, such that
+ * buffers for different purposes may be used simultaneously.
+ */
+typedef enum guac_scratch_slot {
+
+    /**
+     * Storage for the palette built while encoding a PNG.
+     */
+    GUAC_SCRATCH_PNG_PALETTE,
+
+    /**
+     * Storage for the palette indices of every pixel of a PNG.
+     */
+    GUAC_SCRATCH_PNG_ROWS,
+
+    /**
+     * Storage for the array of row pointers passed to libpng.
+     */
+    GUAC_SCRATCH_PNG_ROW_POINTERS,
+
+    /**
+     * Storage for the single RGB scanline converted while encoding a JPEG.
+     */
+    GUAC_SCRATCH_JPEG_SCANLINE,
+
+    /**
+     * The total number of scratch slots. This MUST be the last value of this
+     * enum.
+     */
+    GUAC_SCRATCH_SLOTS
+
+} guac_scratch_slot;
+
+/**
+ * Returns thread-local scratch memory of at least the given size, reserved
+ * for the given purpose. The memory is reused by later calls for the same
+ * purpose within the same thread, and is reallocated only if a larger size is
+ * requested, such that encoding images of similar size repeatedly does not
+ * allocate, or if the buffer has been much larger than needed for the last
+ * GUAC_SCRATCH_TRIM_INTERVAL requests, such that it shrinks. The contents of
+ * the returned memory are undefined. The memory is freed automatically when
+ * the thread exits, and MUST NOT be freed manually.
+ *
+ * @param slot
+ *     The purpose for which the scratch memory is being requested.
+ *
+ * @param size
+ *     The minimum number of bytes required.
+ *
+ * @return
+ *     A pointer to at least the given number of bytes of scratch memory,
+ *     valid until the next call to guac_scratch_get() for the same slot
+ *     within the same thread, or NULL if the memory could not be allocated.
+ */
+void* guac_scratch_get(guac_scratch_slot slot, size_t size);
+
+#endif
+
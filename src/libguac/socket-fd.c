@@ -103,10 +103,10 @@ ssize_t guac_socket_fd_write(guac_socket* socket,
 
 #ifdef __MINGW32__
         /* MINGW32 WINSOCK only works with send() */
-        retval = send(data->fd, buf, count, 0);
+        retval = send(data->fd, buffer, count, 0);
 #else
         /* Use write() for all other platforms */
-        retval = write(data->fd, buf, count);
+        retval = write(data->fd, buffer, count);
 #endif
 
         /* Record errors in guac_error */
@@ -243,6 +243,17 @@ static ssize_t guac_socket_fd_write_buffered(guac_socket* socket,
     const char* current = buf;
     guac_socket_fd_data* data = (guac_socket_fd_data*) socket->data;
 
+    /* Write chunks at least as large as the buffer directly, rather than
+     * copying them into the buffer first, if nothing is pending */
+    if (data->written == 0 && count >= sizeof(data->out_buf)) {
+
+        if (guac_socket_fd_write(socket, buf, count))
+            return -1;
+
+        return original_count;
+
+    }
+
     /* Append to buffer, flush if necessary */
     while (count > 0) {
 
@@ -25,14 +25,16 @@
 
 #include <freerdp/freerdp.h>
 #include <freerdp/channels/channels.h>
+#include <guacamole/arena.h>
 #include <guacamole/protocol.h>
+#include <guacamole/resampler.h>
 #include <guacamole/socket.h>
 #include <guacamole/stream.h>
 #include <guacamole/user.h>
 
-#include <assert.h>
 #include <errno.h>
 #include <stdlib.h>
+#include <string.h>
 #include <pthread.h>
 
 /**
@@ -237,6 +239,25 @@ static void guac_rdp_audio_buffer_ack(guac_rdp_audio_buffer* audio_buffer,
 
 }
 
+/**
+ * Frees the resampler currently used by the given audio buffer, if any, such
+ * that a new resampler will be selected based on the input and output
+ * formats in effect when audio is next written. The audio buffer must already
+ * be locked.
+ *
+ * @param audio_buffer
+ *     The audio buffer whose resampler should be reset.
+ */
+static void guac_rdp_audio_buffer_reset_resampler(
+        guac_rdp_audio_buffer* audio_buffer) {
+
+    if (audio_buffer->resampler != NULL) {
+        guac_resampler_free(audio_buffer->resampler);
+        audio_buffer->resampler = NULL;
+    }
+
+}
+
 void guac_rdp_audio_buffer_set_stream(guac_rdp_audio_buffer* audio_buffer,
         guac_user* user, guac_stream* stream, int rate, int channels, int bps) {
 
@@ -249,6 +270,9 @@ void guac_rdp_audio_buffer_set_stream(guac_rdp_audio_buffer* audio_buffer,
     audio_buffer->in_format.channels = channels;
     audio_buffer->in_format.bps = bps;
 
+    /* Input format may have changed */
+    guac_rdp_audio_buffer_reset_resampler(audio_buffer);
+
     /* Acknowledge stream creation (if buffer is ready to receive) */
     guac_rdp_audio_buffer_ack(audio_buffer,
             "OK", GUAC_PROTOCOL_STATUS_SUCCESS);
@@ -273,6 +297,9 @@ void guac_rdp_audio_buffer_set_output(guac_rdp_audio_buffer* audio_buffer,
     audio_buffer->out_format.channels = channels;
     audio_buffer->out_format.bps = bps;
 
+    /* Output format may have changed */
+    guac_rdp_audio_buffer_reset_resampler(audio_buffer);
+
     pthread_mutex_unlock(&(audio_buffer->lock));
 
 }
@@ -287,6 +314,7 @@ void guac_rdp_audio_buffer_begin(guac_rdp_audio_buffer* audio_buffer,
     audio_buffer->bytes_written = 0;
     audio_buffer->flush_handler = flush_handler;
     audio_buffer->data = data;
+    guac_rdp_audio_buffer_reset_resampler(audio_buffer);
 
     /* Calculate size of each packet in bytes */
     audio_buffer->packet_size = packet_frames
@@ -305,127 +333,66 @@ void guac_rdp_audio_buffer_begin(guac_rdp_audio_buffer* audio_buffer,
 
 }
 
-/**
- * Reads a single sample from the given buffer of data, using the input
- * format defined within the given audio buffer. Each read sample is
- * translated to a signed 16-bit value, even if the input format is 8-bit.
- * The offset into the given buffer will be determined according to the
- * input and output formats, the number of bytes sent thus far, and the
- * number of bytes received (excluding the contents of the buffer).
- *
- * @param audio_buffer
- *     The audio buffer dictating the format of the given data buffer, as
- *     well as the offset from which the sample should be read.
- *
- * @param buffer
- *     The buffer of raw PCM audio data from which the sample should be read.
- *     This buffer MUST NOT contain data already taken into account by the
- *     audio buffer's total_bytes_received counter.
- *
- * @param length
- *     The number of bytes within the given buffer of PCM data.
- *
- * @param sample
- *     A pointer to the int16_t in which the read sample should be stored. If
- *     the input format is 8-bit, the sample will be shifted left by 8 bits
- *     to produce a 16-bit sample.
- *
- * @return
- *     Non-zero if a sample was successfully read, zero if no data remains
- *     within the given buffer that has not already been mapped to an
- *     output sample.
- */
-static int guac_rdp_audio_buffer_read_sample(
-        guac_rdp_audio_buffer* audio_buffer, const char* buffer, int length,
-        int16_t* sample) {
-
-    int in_bps = audio_buffer->in_format.bps;
-    int in_rate = audio_buffer->in_format.rate;
-    int in_channels = audio_buffer->in_format.channels;
-
-    int out_bps = audio_buffer->out_format.bps;
-    int out_rate = audio_buffer->out_format.rate;
-    int out_channels = audio_buffer->out_format.channels;
-
-    /* Calculate position within audio output */
-    int current_sample  = audio_buffer->total_bytes_sent / out_bps;
-    int current_frame   = current_sample / out_channels;
-    int current_channel = current_sample % out_channels;
-
-    /* Map output channel to input channel */
-    if (current_channel >= in_channels)
-        current_channel = in_channels - 1;
-
-    /* Transform output position to input position */
-    current_frame = (int) current_frame * ((double) in_rate / out_rate);
-    current_sample = current_frame * in_channels + current_channel;
-
-    /* Calculate offset within given buffer from absolute input position */
-    int offset = current_sample * in_bps
-               - audio_buffer->total_bytes_received;
-
-    /* It should be impossible for the offset to ever go negative */
-    assert(offset >= 0);
-
-    /* Apply offset to buffer */
-    buffer += offset;
-    length -= offset;
-
-    /* Read only if sufficient data is present in the given buffer */
-    if (length < in_bps)
-        return 0;
+void guac_rdp_audio_buffer_write(guac_rdp_audio_buffer* audio_buffer,
+        char* buffer, int length) {
 
-    /* Simply read sample directly if input is 16-bit */
-    if (in_bps == 2) {
-        *sample = *((int16_t*) buffer);
-        return 1;
-    }
+    pthread_mutex_lock(&(audio_buffer->lock));
 
-    /* Translate to 16-bit if input is 8-bit */
-    if (in_bps == 1) {
-        *sample = *buffer << 8;
-        return 1;
+    /* Ignore packet if there is no buffer */
+    if (audio_buffer->packet_size == 0 || audio_buffer->packet == NULL) {
+        pthread_mutex_unlock(&(audio_buffer->lock));
+        return;
     }
 
-    /* Accepted audio formats are required to be 8- or 16-bit */
-    return 0;
+    /* Select a resampler for the current formats if not yet selected */
+    if (audio_buffer->resampler == NULL) {
 
-}
+        audio_buffer->resampler = guac_resampler_alloc(
+                audio_buffer->in_format.rate,
+                audio_buffer->in_format.channels,
+                audio_buffer->in_format.bps * 8,
+                audio_buffer->out_format.rate,
+                audio_buffer->out_format.channels,
+                audio_buffer->out_format.bps * 8);
 
-void guac_rdp_audio_buffer_write(guac_rdp_audio_buffer* audio_buffer,
-        char* buffer, int length) {
+        /* Accepted audio formats are required to be 8- or 16-bit */
+        if (audio_buffer->resampler == NULL) {
+            pthread_mutex_unlock(&(audio_buffer->lock));
+            return;
+        }
 
-    int16_t sample;
+    }
 
-    pthread_mutex_lock(&(audio_buffer->lock));
+    /* Convert received audio to the output format within temporary
+     * storage */
+    guac_arena_mark mark = guac_arena_get_mark();
+    unsigned char* converted = guac_arena_alloc(
+            guac_resampler_max_output(audio_buffer->resampler, length));
 
-    /* Ignore packet if there is no buffer */
-    if (audio_buffer->packet_size == 0 || audio_buffer->packet == NULL) {
+    if (converted == NULL) {
         pthread_mutex_unlock(&(audio_buffer->lock));
         return;
     }
 
-    int out_bps = audio_buffer->out_format.bps;
+    unsigned char* current = converted;
+    int remaining = guac_resampler_convert(audio_buffer->resampler,
+            (unsigned char*) buffer, length, converted);
 
     /* Continuously write packets until no data remains */
-    while (guac_rdp_audio_buffer_read_sample(audio_buffer,
-                buffer, length, &sample) > 0) {
+    while (remaining > 0) {
 
-        char* current = audio_buffer->packet + audio_buffer->bytes_written;
+        /* Copy as much as fits within the current packet */
+        int chunk_size = audio_buffer->packet_size
+                       - audio_buffer->bytes_written;
+        if (chunk_size > remaining)
+            chunk_size = remaining;
 
-        /* Store as 16-bit or 8-bit, depending on output format */
-        if (out_bps == 2)
-            *((int16_t*) current) = sample;
-        else if (out_bps == 1)
-            *current = sample >> 8;
+        memcpy(audio_buffer->packet + audio_buffer->bytes_written,
+                current, chunk_size);
 
-        /* Accepted audio formats are required to be 8- or 16-bit */
-        else
-            assert(0);
-
-        /* Update byte counters */
-        audio_buffer->bytes_written += out_bps;
-        audio_buffer->total_bytes_sent += out_bps;
+        audio_buffer->bytes_written += chunk_size;
+        current += chunk_size;
+        remaining -= chunk_size;
 
         /* Invoke flush handler if full */
         if (audio_buffer->bytes_written == audio_buffer->packet_size) {
@@ -442,9 +409,7 @@ void guac_rdp_audio_buffer_write(guac_rdp_audio_buffer* audio_buffer,
 
     } /* end packet write loop */
 
-    /* Track current position in audio stream */
-    audio_buffer->total_bytes_received += length;
-
+    guac_arena_release(mark);
     pthread_mutex_unlock(&(audio_buffer->lock));
 
 }
@@ -466,9 +431,8 @@ void guac_rdp_audio_buffer_end(guac_rdp_audio_buffer* audio_buffer) {
     audio_buffer->packet_size = 0;
     audio_buffer->flush_handler = NULL;
 
-    /* Reset I/O counters */
-    audio_buffer->total_bytes_sent = 0;
-    audio_buffer->total_bytes_received = 0;
+    /* Discard conversion state */
+    guac_rdp_audio_buffer_reset_resampler(audio_buffer);
 
     /* Free packet (if any) */
     free(audio_buffer->packet);
@@ -480,6 +444,7 @@ void guac_rdp_audio_buffer_end(guac_rdp_audio_buffer* audio_buffer) {
 
 void guac_rdp_audio_buffer_free(guac_rdp_audio_buffer* audio_buffer) {
     pthread_mutex_destroy(&(audio_buffer->lock));
+    guac_rdp_audio_buffer_reset_resampler(audio_buffer);
     free(audio_buffer->packet);
     free(audio_buffer);
 }
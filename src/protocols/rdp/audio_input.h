@@ -24,6 +24,7 @@
 #include "dvc.h"
 
 #include <freerdp/freerdp.h>
+#include <guacamole/resampler.h>
 #include <guacamole/stream.h>
 #include <guacamole/user.h>
 
@@ -122,16 +123,11 @@ typedef struct guac_rdp_audio_buffer {
     int bytes_written;
 
     /**
-     * The total number of bytes having ever been received by the Guacamole
-     * server for the current audio stream.
+     * The resampler which converts audio received from the user from the
+     * input format to the output format, or NULL if no resampler has yet
+     * been selected for the current pair of formats.
      */
-    int total_bytes_received;
-
-    /**
-     * The total number of bytes having ever been sent to the RDP server for
-     * the current audio stream.
-     */
-    int total_bytes_sent;
+    guac_resampler* resampler;
 
     /**
      * All audio data being prepared for sending to the AUDIO_INPUT channel.
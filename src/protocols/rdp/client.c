@@ -76,6 +76,9 @@ int guac_client_init(guac_client* client, int argc, char** argv) {
     /* Init RDP lock */
     pthread_mutex_init(&(rdp_client->rdp_lock), &(rdp_client->attributes));
 
+    /* Init SVC flush lock */
+    pthread_mutex_init(&(rdp_client->svc_flush_lock), NULL);
+
     /* Clear keysym state mapping and keymap */
     memset(rdp_client->keysym_state, 0, sizeof(guac_rdp_keysym_state_map));
     memset(rdp_client->keymap, 0, sizeof(guac_rdp_static_keymap));
@@ -106,6 +109,12 @@ int guac_rdp_client_free_handler(guac_client* client) {
     /* Free display update module */
     guac_rdp_disp_free(rdp_client->disp);
 
+    /* Free display, including any buffers used to render glyphs */
+    if (rdp_client->display != NULL) {
+        guac_common_display_free(rdp_client->display);
+        guac_rdp_glyph_run_reset(&rdp_client->glyph_run);
+    }
+
     /* Clean up filesystem, if allocated */
     if (rdp_client->filesystem != NULL)
         guac_rdp_fs_free(rdp_client->filesystem);
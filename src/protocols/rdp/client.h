@@ -89,6 +89,12 @@
  */
 #define GUAC_RDP_AUDIO_BPS 16
 
+/**
+ * The minimum duration of audio, in milliseconds, to accumulate from received
+ * wave PDUs before sending that audio as a single packet.
+ */
+#define GUAC_RDP_AUDIO_PACKET_INTERVAL 100
+
 /**
  * Handler which frees all data associated with the guac_client.
  */
@@ -30,6 +30,7 @@
 #include "unicode.h"
 
 #include <freerdp/utils/svc_plugin.h>
+#include <guacamole/arena.h>
 #include <guacamole/client.h>
 
 #ifdef ENABLE_WINPR
@@ -129,6 +130,7 @@ void guac_rdpdr_fs_process_read(guac_rdpdr_device* device,
     int bytes_read;
 
     wStream* output_stream;
+    guac_arena_mark mark = guac_arena_get_mark();
 
     /* Read packet */
     Stream_Read_UINT32(input_stream, length);
@@ -142,12 +144,15 @@ void guac_rdpdr_fs_process_read(guac_rdpdr_device* device,
     if (length > GUAC_RDP_MAX_READ_BUFFER)
         length = GUAC_RDP_MAX_READ_BUFFER;
 
-    /* Allocate buffer */
-    buffer = malloc(length);
+    /* Allocate buffer from temporary storage */
+    buffer = guac_arena_alloc(length);
 
     /* Attempt read */
-    bytes_read = guac_rdp_fs_read((guac_rdp_fs*) device->data, file_id, offset,
-            buffer, length);
+    if (buffer == NULL)
+        bytes_read = GUAC_RDP_FS_EINVAL;
+    else
+        bytes_read = guac_rdp_fs_read((guac_rdp_fs*) device->data, file_id,
+                offset, buffer, length);
 
     /* If error, return invalid parameter */
     if (bytes_read < 0) {
@@ -165,7 +170,7 @@ void guac_rdpdr_fs_process_read(guac_rdpdr_device* device,
     }
 
     svc_plugin_send((rdpSvcPlugin*) device->rdpdr, output_stream);
-    free(buffer);
+    guac_arena_release(mark);
 
 }
 
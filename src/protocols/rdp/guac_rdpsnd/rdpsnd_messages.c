@@ -136,7 +136,9 @@ void guac_rdpsnd_formats_handler(guac_rdpsndPlugin* rdpsnd,
 
                     /* Ensure audio stream is configured to use accepted
                      * format */
+                    pthread_mutex_lock(&(rdp_client->rdp_lock));
                     guac_audio_stream_reset(audio, NULL, rate, channels, bps);
+                    pthread_mutex_unlock(&(rdp_client->rdp_lock));
 
                     /* Queue format for sending as accepted */
                     Stream_EnsureRemainingCapacity(output_stream,
@@ -265,11 +267,14 @@ void guac_rdpsnd_wave_info_handler(guac_rdpsndPlugin* rdpsnd,
     rdpsnd->next_pdu_is_wave = TRUE;
 
     /* Reset audio stream if format has changed */
-    if (audio != NULL)
+    if (audio != NULL) {
+        pthread_mutex_lock(&(rdp_client->rdp_lock));
         guac_audio_stream_reset(audio, NULL,
                 rdpsnd->formats[format].rate,
                 rdpsnd->formats[format].channels,
                 rdpsnd->formats[format].bps);
+        pthread_mutex_unlock(&(rdp_client->rdp_lock));
+    }
 
 }
 
@@ -294,13 +299,6 @@ void guac_rdpsnd_wave_handler(guac_rdpsndPlugin* rdpsnd,
     /* Copy over first four bytes */
     memcpy(buffer, rdpsnd->initial_wave_data, 4);
 
-    /* Write rest of audio packet */
-    if (audio != NULL) {
-        guac_audio_stream_write_pcm(audio, buffer,
-                rdpsnd->incoming_wave_size + 4);
-        guac_audio_stream_flush(audio);
-    }
-
     /* Write Wave Confirmation PDU */
     Stream_Write_UINT8(output_stream, SNDC_WAVECONFIRM);
     Stream_Write_UINT8(output_stream, 0);
@@ -309,9 +307,17 @@ void guac_rdpsnd_wave_handler(guac_rdpsndPlugin* rdpsnd,
     Stream_Write_UINT8(output_stream, rdpsnd->waveinfo_block_number);
     Stream_Write_UINT8(output_stream, 0);
 
-    /* Send Wave Confirmation PDU */
     pthread_mutex_lock(&(rdp_client->rdp_lock));
+
+    /* Write rest of audio packet (flushed once a full packet accumulates, or
+     * at the end of the current frame) */
+    if (audio != NULL)
+        guac_audio_stream_write_pcm(audio, buffer,
+                rdpsnd->incoming_wave_size + 4);
+
+    /* Send Wave Confirmation PDU */
     svc_plugin_send(plugin, output_stream);
+
     pthread_mutex_unlock(&(rdp_client->rdp_lock));
 
     /* We no longer expect to receive wave data */
@@ -322,7 +328,16 @@ void guac_rdpsnd_wave_handler(guac_rdpsndPlugin* rdpsnd,
 void guac_rdpsnd_close_handler(guac_rdpsndPlugin* rdpsnd,
         wStream* input_stream, guac_rdpsnd_pdu_header* header) {
 
-    /* Do nothing */
+    /* Get associated client data */
+    guac_client* client = rdpsnd->client;
+    guac_rdp_client* rdp_client = (guac_rdp_client*) client->data;
+
+    /* Send any audio still buffered, as no further audio will follow */
+    if (rdp_client->audio != NULL) {
+        pthread_mutex_lock(&(rdp_client->rdp_lock));
+        guac_audio_stream_flush(rdp_client->audio);
+        pthread_mutex_unlock(&(rdp_client->rdp_lock));
+    }
 
 }
 
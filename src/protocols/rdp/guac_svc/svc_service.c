@@ -113,7 +113,7 @@ void guac_svc_process_terminate(rdpSvcPlugin* plugin) {
     /* Remove and free SVC */
     guac_client_log(svc->client, GUAC_LOG_INFO, "Closing channel \"%s\"...", svc->name);
     guac_rdp_remove_svc(svc->client, svc->name);
-    free(svc);
+    guac_rdp_free_svc(svc);
 
     free(plugin);
 
@@ -138,12 +138,10 @@ void guac_svc_process_receive(rdpSvcPlugin* plugin,
         return;
     }
 
-    /* Send blob */
-    guac_protocol_send_blob(svc->client->socket, svc->output_pipe,
-            Stream_Buffer(input_stream),
+    /* Send received data along output pipe (if coalescing is enabled for
+     * the channel, buffered data is sent at the end of the current frame) */
+    guac_rdp_svc_receive(svc, Stream_Buffer(input_stream),
             Stream_Length(input_stream));
 
-    guac_socket_flush(svc->client->socket);
-
 }
 
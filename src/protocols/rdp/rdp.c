@@ -303,6 +303,16 @@ BOOL rdp_freerdp_pre_connect(freerdp* instance) {
 
             guac_rdp_svc* svc = guac_rdp_alloc_svc(client, *current);
 
+            /* Allow coalescing only if explicitly requested for channel */
+            if (settings->svc_coalesce_names != NULL) {
+                char** coalesce = settings->svc_coalesce_names;
+                while (*coalesce != NULL) {
+                    if (strcmp(*coalesce, *current) == 0)
+                        svc->coalesce = 1;
+                    coalesce++;
+                }
+            }
+
             /* Attempt to load guacsvc plugin for new static channel */
             if (freerdp_channels_load_plugin(channels, instance->settings,
                         "guacsvc", svc)) {
@@ -709,18 +719,36 @@ static int guac_rdp_handle_connection(guac_client* client) {
     /* Init random number generator */
     srandom(time(NULL));
 
-    /* Set up screen recording, if requested */
-    if (settings->recording_path != NULL) {
-        guac_common_recording_create(client,
-                settings->recording_path,
-                settings->recording_name,
-                settings->create_recording_path);
+    /* Create display and recording only for the first connection */
+    if (rdp_client->display == NULL) {
+
+        /* Set up screen recording, if requested */
+        if (settings->recording_path != NULL) {
+            guac_common_recording_create(client,
+                    settings->recording_path,
+                    settings->recording_name,
+                    settings->create_recording_path);
+        }
+
+        /* Create display */
+        rdp_client->display = guac_common_display_alloc(client,
+                rdp_client->settings->width,
+                rdp_client->settings->height);
+
     }
 
-    /* Create display */
-    rdp_client->display = guac_common_display_alloc(client,
-            rdp_client->settings->width,
-            rdp_client->settings->height);
+    /* Otherwise, retain the existing display, its layers and buffers across
+     * the reconnect, such that the content redrawn by the RDP server is
+     * compared against what the users already have and only the changes are
+     * sent */
+    else {
+        pthread_mutex_lock(&(rdp_client->rdp_lock));
+        guac_common_surface_resize(rdp_client->display->default_surface,
+                rdp_client->settings->width,
+                rdp_client->settings->height);
+        guac_common_surface_reset_clip(rdp_client->display->default_surface);
+        pthread_mutex_unlock(&(rdp_client->rdp_lock));
+    }
 
     rdp_client->current_surface = rdp_client->display->default_surface;
 
@@ -883,6 +911,17 @@ static int guac_rdp_handle_connection(guac_client* client) {
             guac_client_abort(client, GUAC_PROTOCOL_STATUS_UPSTREAM_ERROR,
                     "Connection closed.");
 
+        /* Send any audio received during this frame, such that the end of a
+         * sound is not held back waiting for a full packet */
+        if (rdp_client->audio != NULL) {
+            pthread_mutex_lock(&(rdp_client->rdp_lock));
+            guac_audio_stream_flush(rdp_client->audio);
+            pthread_mutex_unlock(&(rdp_client->rdp_lock));
+        }
+
+        /* Write and send any buffered static channel data */
+        guac_rdp_svc_flush_all(client);
+
         /* End of frame */
         guac_common_display_flush(rdp_client->display);
         guac_client_end_frame(client);
@@ -893,9 +932,15 @@ static int guac_rdp_handle_connection(guac_client* client) {
 
     }
 
-    /* Kill client and finish connection */
-    guac_client_stop(client);
-    guac_client_log(client, GUAC_LOG_INFO, "Internal RDP client disconnected");
+    /* Kill client and finish connection, unless reconnecting */
+    if (!guac_rdp_disp_reconnect_needed(rdp_client->disp)) {
+        guac_client_stop(client);
+        guac_client_log(client, GUAC_LOG_INFO,
+                "Internal RDP client disconnected");
+    }
+    else
+        guac_client_log(client, GUAC_LOG_INFO,
+                "Reconnecting internal RDP client");
 
     pthread_mutex_lock(&(rdp_client->rdp_lock));
 
@@ -916,8 +961,10 @@ static int guac_rdp_handle_connection(guac_client* client) {
     /* Free SVC list */
     guac_common_list_free(rdp_client->available_svc);
 
-    /* Free display */
-    guac_common_display_free(rdp_client->display);
+    /* Discard any glyphs of the old connection. The display, including any
+     * buffers used to render glyphs, is kept for the next connection and is
+     * freed only once the client is freed. */
+    rdp_client->glyph_run.count = 0;
 
     pthread_mutex_unlock(&(rdp_client->rdp_lock));
     return 0;
@@ -938,8 +985,14 @@ void* guac_rdp_client_thread(void* data) {
                 GUAC_RDP_AUDIO_CHANNELS,
                 GUAC_RDP_AUDIO_BPS);
 
+        /* Batch wave PDUs into larger packets, skipping silence */
+        if (rdp_client->audio != NULL) {
+            rdp_client->audio->packet_interval = GUAC_RDP_AUDIO_PACKET_INTERVAL;
+            rdp_client->audio->suppress_silence = 1;
+        }
+
         /* Warn if no audio encoding is available */
-        if (rdp_client->audio == NULL)
+        else
             guac_client_log(client, GUAC_LOG_INFO,
                     "No available audio encoding. Sound disabled.");
 
@@ -29,6 +29,7 @@
 #include "guac_list.h"
 #include "rdp_disp.h"
 #include "rdp_fs.h"
+#include "rdp_glyph.h"
 #include "rdp_keymap.h"
 #include "rdp_settings.h"
 
@@ -76,6 +77,11 @@ typedef struct guac_rdp_client {
      */
     uint32_t glyph_color;
 
+    /**
+     * The glyphs drawn as part of the current run of text, if any.
+     */
+    guac_rdp_glyph_run glyph_run;
+
     /**
      * The display.
      */
@@ -158,6 +164,15 @@ typedef struct guac_rdp_client {
      */
     guac_common_list* available_svc;
 
+    /**
+     * Lock which is held while the SVCs within available_svc are flushed,
+     * and while SVCs are added to or removed from that list. An SVC thus
+     * cannot be freed while it is being flushed. Unlike the lock of
+     * available_svc itself, this lock is never acquired while a user is
+     * joining, and may be held while sending data to connected users.
+     */
+    pthread_mutex_t svc_flush_lock;
+
     /**
      * Lock which is locked and unlocked for each RDP message, and for each
      * part of the RDP client instance which may be dynamically freed and
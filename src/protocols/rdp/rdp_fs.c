@@ -19,6 +19,7 @@
 
 #include "config.h"
 
+#include "guac_listing.h"
 #include "rdp_fs.h"
 #include "rdp_status.h"
 #include "rdp_stream.h"
@@ -64,12 +65,14 @@ guac_rdp_fs* guac_rdp_fs_alloc(guac_client* client, const char* drive_path,
     fs->drive_path = strdup(drive_path);
     fs->file_id_pool = guac_pool_alloc(0);
     fs->open_files = 0;
+    fs->listing_cache = guac_common_listing_cache_alloc();
 
     return fs;
 
 }
 
 void guac_rdp_fs_free(guac_rdp_fs* fs) {
+    guac_common_listing_cache_free(fs->listing_cache);
     guac_pool_free(fs->file_id_pool);
     free(fs->drive_path);
     free(fs);
@@ -314,6 +317,10 @@ int guac_rdp_fs_open(guac_rdp_fs* fs, const char* path,
 
     }
 
+    /* Any cached listings may no longer be accurate if creating files */
+    if (flags & O_CREAT)
+        guac_common_listing_cache_invalidate(fs->listing_cache);
+
     /* Create directory first, if necessary */
     if ((create_options & FILE_DIRECTORY_FILE) && (flags & O_CREAT)) {
 
@@ -487,6 +494,7 @@ int guac_rdp_fs_rename(guac_rdp_fs* fs, int file_id,
         return guac_rdp_fs_get_errorcode(errno);
     }
 
+    guac_common_listing_cache_invalidate(fs->listing_cache);
     return 0;
 
 }
@@ -517,6 +525,7 @@ int guac_rdp_fs_delete(guac_rdp_fs* fs, int file_id) {
         return guac_rdp_fs_get_errorcode(errno);
     }
 
+    guac_common_listing_cache_invalidate(fs->listing_cache);
     return 0;
 
 }
@@ -608,6 +617,100 @@ const char* guac_rdp_fs_read_dir(guac_rdp_fs* fs, int file_id) {
 
 }
 
+/**
+ * Determines the mimetype which should be used to represent the directory
+ * entry most recently read from the given directory, as returned by
+ * guac_rdp_fs_read_dir(). If the type of the entry is known from the
+ * directory entry itself, no further system calls are made. Otherwise, the
+ * entry is stat'd relative to the open directory, following symbolic links.
+ *
+ * @param dir
+ *     The directory from which the entry was read.
+ *
+ * @param filename
+ *     The name of the entry, relative to the given directory.
+ *
+ * @return
+ *     The mimetype of the entry, or NULL if the entry cannot be stat'd and
+ *     should be omitted from the listing.
+ */
+static const char* guac_rdp_fs_entry_mimetype(guac_rdp_fs_file* dir,
+        const char* filename) {
+
+    struct stat file_stat;
+
+#ifdef DT_DIR
+    /* Use type provided with directory entry, if known */
+    switch (dir->__dirent.d_type) {
+
+        case DT_DIR:
+            return GUAC_USER_STREAM_INDEX_MIMETYPE;
+
+        case DT_REG:
+            return "application/octet-stream";
+
+    }
+#endif
+
+    /* Otherwise, stat file to determine type */
+    if (fstatat(dirfd(dir->dir), filename, &file_stat, 0))
+        return NULL;
+
+    if (S_ISDIR(file_stat.st_mode))
+        return GUAC_USER_STREAM_INDEX_MIMETYPE;
+
+    return "application/octet-stream";
+
+}
+
+guac_common_listing* guac_rdp_fs_read_listing(guac_rdp_fs* fs, int file_id,
+        const char* path) {
+
+    const char* filename;
+
+    /* Use cached listing if available */
+    guac_common_listing* listing =
+        guac_common_listing_cache_get(fs->listing_cache, path);
+    if (listing != NULL)
+        return listing;
+
+    listing = guac_common_listing_alloc(path);
+
+    guac_rdp_fs_file* dir = guac_rdp_fs_get_file(fs, file_id);
+    if (dir == NULL)
+        return listing;
+
+    /* Read all directory entries at once */
+    while ((filename = guac_rdp_fs_read_dir(fs, file_id)) != NULL) {
+
+        char absolute_path[GUAC_RDP_FS_MAX_PATH];
+
+        /* Skip current and parent directory entries */
+        if (strcmp(filename, ".") == 0 || strcmp(filename, "..") == 0)
+            continue;
+
+        /* Concatenate into absolute path - skip if invalid */
+        if (!guac_rdp_fs_append_filename(absolute_path, path, filename)) {
+
+            guac_client_log(fs->client, GUAC_LOG_DEBUG,
+                    "Skipping filename \"%s\" - filename is invalid or "
+                    "resulting path is too long", filename);
+
+            continue;
+        }
+
+        /* Add entry only if type can be determined */
+        const char* mimetype = guac_rdp_fs_entry_mimetype(dir, filename);
+        if (mimetype != NULL)
+            guac_common_listing_add(listing, absolute_path, mimetype);
+
+    }
+
+    guac_common_listing_cache_put(fs->listing_cache, listing);
+    return listing;
+
+}
+
 int guac_rdp_fs_normalize_path(const char* path, char* abs_path) {
 
     int i;
@@ -33,6 +33,7 @@
  */
 
 #include "config.h"
+#include "guac_listing.h"
 
 #include <guacamole/client.h>
 #include <guacamole/pool.h>
@@ -289,6 +290,13 @@ typedef struct guac_rdp_fs {
      */
     guac_rdp_fs_file files[GUAC_RDP_FS_MAX_FILES];
 
+    /**
+     * Recently-read directory listings, as exposed to users via the
+     * filesystem object. This cache is invalidated whenever a file or
+     * directory is created, renamed, or deleted.
+     */
+    guac_common_listing_cache* listing_cache;
+
 } guac_rdp_fs;
 
 /**
@@ -648,6 +656,30 @@ int guac_rdp_fs_convert_path(const char* parent, const char* rel_path,
  */
 const char* guac_rdp_fs_read_dir(guac_rdp_fs* fs, int file_id);
 
+/**
+ * Returns the complete listing of the directory having the given ID, as
+ * exposed to users via the filesystem object. Each entry is typed using the
+ * type information returned along with the directory entry itself, and the
+ * entry is opened only if that information is unavailable. Recently-read
+ * listings are served from the listing cache of the filesystem. The
+ * directory is read in full only if no valid cached listing exists.
+ *
+ * @param fs
+ *     The filesystem containing the directory.
+ *
+ * @param file_id
+ *     The ID of the directory, as returned by guac_rdp_fs_open().
+ *
+ * @param path
+ *     The absolute path of the directory.
+ *
+ * @return
+ *     A new reference to the listing of the given directory, which must be
+ *     released with guac_common_listing_release().
+ */
+guac_common_listing* guac_rdp_fs_read_listing(guac_rdp_fs* fs, int file_id,
+        const char* path);
+
 /**
  * Returns the file having the given ID, or NULL if no such file exists.
  *
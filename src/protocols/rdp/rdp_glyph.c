@@ -20,6 +20,8 @@
 #include "config.h"
 
 #include "client.h"
+#include "guac_display.h"
+#include "guac_rect.h"
 #include "guac_surface.h"
 #include "rdp.h"
 #include "rdp_color.h"
@@ -56,7 +58,7 @@ void guac_rdp_glyph_new(rdpContext* context, rdpGlyph* glyph) {
     int height = glyph->cy;
 
     /* Init Cairo buffer */
-    stride = cairo_format_stride_for_width(CAIRO_FORMAT_ARGB32, width);
+    stride = cairo_format_stride_for_width(CAIRO_FORMAT_RGB24, width);
     image_buffer = malloc(height*stride);
     image_buffer_row = image_buffer;
 
@@ -77,11 +79,11 @@ void guac_rdp_glyph_new(rdpContext* context, rdpGlyph* glyph) {
             /* Read bits, write pixels */
             for (i = 0; i<8 && x<width; i++, x++) {
 
-                /* Output RGB */
+                /* Output white where set, black otherwise */
                 if (v & 0x80)
-                    *(image_buffer_current++) = 0xFF000000;
+                    *(image_buffer_current++) = 0xFFFFFFFF;
                 else
-                    *(image_buffer_current++) = 0x00000000;
+                    *(image_buffer_current++) = 0xFF000000;
 
                 /* Next bit */
                 v <<= 1;
@@ -93,7 +95,10 @@ void guac_rdp_glyph_new(rdpContext* context, rdpGlyph* glyph) {
 
     /* Store glyph surface */
     ((guac_rdp_glyph*) glyph)->surface = cairo_image_surface_create_for_data(
-            image_buffer, CAIRO_FORMAT_ARGB32, width, height, stride);
+            image_buffer, CAIRO_FORMAT_RGB24, width, height, stride);
+
+    /* No corresponding buffer yet - caching is deferred until drawn */
+    ((guac_rdp_glyph*) glyph)->layer = NULL;
 
 }
 
@@ -101,22 +106,36 @@ void guac_rdp_glyph_draw(rdpContext* context, rdpGlyph* glyph, int x, int y) {
 
     guac_client* client = ((rdp_freerdp_context*) context)->client;
     guac_rdp_client* rdp_client = (guac_rdp_client*) client->data;
-    guac_common_surface* current_surface = rdp_client->current_surface;
-    uint32_t fgcolor = rdp_client->glyph_color;
+    guac_rdp_glyph_run* run = &rdp_client->glyph_run;
 
-    /* Paint with glyph as mask */
-    guac_common_surface_paint(current_surface, x, y, ((guac_rdp_glyph*) glyph)->surface,
-                               (fgcolor & 0xFF0000) >> 16,
-                               (fgcolor & 0x00FF00) >> 8,
-                                fgcolor & 0x0000FF);
+    /* Grow list of glyphs if full */
+    if (run->count == run->size) {
+        run->size = run->size ? run->size * 2 : GUAC_RDP_GLYPH_RUN_INITIAL_SIZE;
+        run->glyphs = realloc(run->glyphs,
+                run->size * sizeof(guac_rdp_glyph_position));
+    }
+
+    /* Defer rendering until end of run */
+    guac_rdp_glyph_position* position = &run->glyphs[run->count++];
+    position->glyph = (guac_rdp_glyph*) glyph;
+    position->x = x;
+    position->y = y;
 
 }
 
 void guac_rdp_glyph_free(rdpContext* context, rdpGlyph* glyph) {
 
+    guac_client* client = ((rdp_freerdp_context*) context)->client;
+    guac_rdp_client* rdp_client = (guac_rdp_client*) client->data;
+    guac_common_display_layer* buffer = ((guac_rdp_glyph*) glyph)->layer;
+
     unsigned char* image_buffer = cairo_image_surface_get_data(
             ((guac_rdp_glyph*) glyph)->surface);
 
+    /* If cached, free buffer */
+    if (buffer != NULL)
+        guac_common_display_free_buffer(rdp_client->display, buffer);
+
     /* Free surface */
     cairo_surface_destroy(((guac_rdp_glyph*) glyph)->surface);
     free(image_buffer);
@@ -146,10 +165,169 @@ void guac_rdp_glyph_begindraw(rdpContext* context,
     /* Convert foreground color */
     rdp_client->glyph_color = guac_rdp_convert_color(context, fgcolor);
 
+    /* Begin new run of glyphs */
+    rdp_client->glyph_run.count = 0;
+
+}
+
+/**
+ * Ensures the given buffer exists and is at least the given size, allocating
+ * or growing the buffer as necessary.
+ *
+ * @param display
+ *     The display from which the buffer should be allocated.
+ *
+ * @param buffer
+ *     A pointer to the buffer to check, which may point to NULL if the buffer
+ *     has not yet been allocated.
+ *
+ * @param width
+ *     The minimum width of the buffer, in pixels.
+ *
+ * @param height
+ *     The minimum height of the buffer, in pixels.
+ */
+static void guac_rdp_glyph_require_buffer(guac_common_display* display,
+        guac_common_display_layer** buffer, int width, int height) {
+
+    guac_common_surface* surface;
+
+    /* Allocate buffer if not yet allocated */
+    if (*buffer == NULL) {
+        *buffer = guac_common_display_alloc_buffer(display, width, height);
+        return;
+    }
+
+    /* Grow existing buffer only if too small */
+    surface = (*buffer)->surface;
+    if (surface->width < width || surface->height < height) {
+
+        if (width < surface->width)
+            width = surface->width;
+
+        if (height < surface->height)
+            height = surface->height;
+
+        guac_common_surface_resize(surface, width, height);
+
+    }
+
 }
 
 void guac_rdp_glyph_enddraw(rdpContext* context,
         int x, int y, int width, int height, UINT32 fgcolor, UINT32 bgcolor) {
-    /* IGNORE */
+
+    guac_client* client = ((rdp_freerdp_context*) context)->client;
+    guac_rdp_client* rdp_client = (guac_rdp_client*) client->data;
+    guac_common_display* display = rdp_client->display;
+    guac_common_surface* current_surface = rdp_client->current_surface;
+    guac_rdp_glyph_run* run = &rdp_client->glyph_run;
+    uint32_t color = rdp_client->glyph_color;
+
+    guac_common_surface* mask;
+    guac_common_surface* fill;
+    guac_common_rect bounds;
+    int i;
+
+    /* Calculate bounds of all non-empty glyphs in run */
+    guac_common_rect_init(&bounds, 0, 0, 0, 0);
+    for (i = 0; i < run->count; i++) {
+
+        guac_rdp_glyph_position* position = &run->glyphs[i];
+        rdpGlyph* glyph = (rdpGlyph*) position->glyph;
+
+        guac_common_rect glyph_rect;
+        guac_common_rect_init(&glyph_rect, position->x, position->y,
+                glyph->cx, glyph->cy);
+
+        if (glyph_rect.width <= 0 || glyph_rect.height <= 0)
+            continue;
+
+        if (bounds.width == 0)
+            bounds = glyph_rect;
+        else
+            guac_common_rect_extend(&bounds, &glyph_rect);
+
+    }
+
+    /* Nothing to render if no non-empty glyphs were drawn */
+    if (bounds.width == 0) {
+        run->count = 0;
+        return;
+    }
+
+    guac_rdp_glyph_require_buffer(display, &run->mask,
+            bounds.width, bounds.height);
+    guac_rdp_glyph_require_buffer(display, &run->fill,
+            bounds.width, bounds.height);
+
+    mask = run->mask->surface;
+    fill = run->fill->surface;
+
+    /* Combine shapes of all glyphs within mask, white on black */
+    guac_common_surface_rect(mask, 0, 0, bounds.width, bounds.height,
+            0x00, 0x00, 0x00);
+
+    for (i = 0; i < run->count; i++) {
+
+        guac_rdp_glyph_position* position = &run->glyphs[i];
+        guac_rdp_glyph* glyph = position->glyph;
+        int glyph_width  = ((rdpGlyph*) glyph)->cx;
+        int glyph_height = ((rdpGlyph*) glyph)->cy;
+
+        /* Skip empty glyphs */
+        if (glyph_width <= 0 || glyph_height <= 0)
+            continue;
+
+        /* Send glyph to client upon first use */
+        if (glyph->layer == NULL) {
+            glyph->layer = guac_common_display_alloc_buffer(display,
+                    glyph_width, glyph_height);
+            guac_common_surface_draw(glyph->layer->surface, 0, 0,
+                    glyph->surface);
+        }
+
+        guac_common_surface_transfer(glyph->layer->surface,
+                0, 0, glyph_width, glyph_height,
+                GUAC_TRANSFER_BINARY_OR, mask,
+                position->x - bounds.x, position->y - bounds.y);
+
+    }
+
+    /* Color glyph shapes with foreground color */
+    guac_common_surface_rect(fill, 0, 0, bounds.width, bounds.height,
+            (color & 0xFF0000) >> 16,
+            (color & 0x00FF00) >> 8,
+             color & 0x0000FF);
+
+    guac_common_surface_transfer(mask, 0, 0, bounds.width, bounds.height,
+            GUAC_TRANSFER_BINARY_AND, fill, 0, 0);
+
+    /* Clear glyph shapes within destination, then fill with color */
+    guac_common_surface_transfer(mask, 0, 0, bounds.width, bounds.height,
+            GUAC_TRANSFER_BINARY_NSRC_AND, current_surface,
+            bounds.x, bounds.y);
+
+    guac_common_surface_transfer(fill, 0, 0, bounds.width, bounds.height,
+            GUAC_TRANSFER_BINARY_OR, current_surface,
+            bounds.x, bounds.y);
+
+    /* Run is complete */
+    run->count = 0;
+
+}
+
+void guac_rdp_glyph_run_reset(guac_rdp_glyph_run* run) {
+
+    free(run->glyphs);
+
+    run->glyphs = NULL;
+    run->count = 0;
+    run->size = 0;
+
+    /* Buffers are freed with the display */
+    run->mask = NULL;
+    run->fill = NULL;
+
 }
 
@@ -23,6 +23,8 @@
 
 #include "config.h"
 
+#include "guac_display.h"
+
 #include <cairo/cairo.h>
 #include <freerdp/freerdp.h>
 
@@ -32,6 +34,11 @@
 #include "compat/winpr-wtypes.h"
 #endif
 
+/**
+ * The number of glyph positions initially allocated for each run of glyphs.
+ */
+#define GUAC_RDP_GLYPH_RUN_INITIAL_SIZE 64
+
 /**
  * Guacamole-specific rdpGlyph data.
  */
@@ -43,15 +50,84 @@ typedef struct guac_rdp_glyph {
     rdpGlyph glyph;
 
     /**
-     * Cairo surface layer containing cached image data.
+     * Cairo surface containing the shape of the glyph, with opaque white
+     * pixels where the glyph is set and opaque black pixels elsewhere.
      */
     cairo_surface_t* surface;
 
+    /**
+     * The Guacamole buffer containing the same image data as the Cairo
+     * surface, or NULL if the glyph has not yet been drawn and thus not yet
+     * sent to the client.
+     */
+    guac_common_display_layer* layer;
+
 } guac_rdp_glyph;
 
 /**
- * Caches the given glyph. Note that this caching currently only occurs server-
- * side, as it is more efficient to transmit the text as PNG.
+ * The position of a single glyph drawn as part of a run of text.
+ */
+typedef struct guac_rdp_glyph_position {
+
+    /**
+     * The glyph drawn.
+     */
+    guac_rdp_glyph* glyph;
+
+    /**
+     * The destination X coordinate of the upper-left corner of the glyph.
+     */
+    int x;
+
+    /**
+     * The destination Y coordinate of the upper-left corner of the glyph.
+     */
+    int y;
+
+} guac_rdp_glyph_position;
+
+/**
+ * The glyphs drawn between calls to guac_rdp_glyph_begindraw() and
+ * guac_rdp_glyph_enddraw(), along with the off-screen buffers used to render
+ * those glyphs together. Glyphs are rendered entirely with raster operations
+ * on Guacamole buffers, such that each glyph is sent to the client only once,
+ * regardless of how many times it is drawn.
+ */
+typedef struct guac_rdp_glyph_run {
+
+    /**
+     * All glyphs drawn since the run began.
+     */
+    guac_rdp_glyph_position* glyphs;
+
+    /**
+     * The number of glyphs drawn since the run began.
+     */
+    int count;
+
+    /**
+     * The number of glyph positions which can be stored within the glyphs
+     * array before it must be grown.
+     */
+    int size;
+
+    /**
+     * Off-screen buffer into which the shapes of all glyphs in the run are
+     * combined, white on black, or NULL if not yet allocated.
+     */
+    guac_common_display_layer* mask;
+
+    /**
+     * Off-screen buffer in which the combined glyph shapes are colored with
+     * the foreground color, or NULL if not yet allocated.
+     */
+    guac_common_display_layer* fill;
+
+} guac_rdp_glyph_run;
+
+/**
+ * Caches the given glyph. The glyph is sent to the client as an off-screen
+ * buffer only when it is first drawn.
  *
  * @param context
  *     The rdpContext associated with the current RDP session.
@@ -63,7 +139,8 @@ void guac_rdp_glyph_new(rdpContext* context, rdpGlyph* glyph);
 
 /**
  * Draws a previously-cached glyph at the given coordinates within the current
- * drawing surface.
+ * drawing surface. The glyph is not actually rendered until the run of text
+ * containing the glyph ends with guac_rdp_glyph_enddraw().
  *
  * @param context
  *     The rdpContext associated with the current RDP session.
@@ -132,8 +209,9 @@ void guac_rdp_glyph_begindraw(rdpContext* context,
 /**
  * Called immediately after rendering a series of glyphs. Unlike
  * guac_rdp_glyph_begindraw(), there is no way to detect through any invocation
- * of this function whether the background color is opaque or transparent. We
- * currently do NOT implement this function.
+ * of this function whether the background color is opaque or transparent.
+ * All glyphs drawn since guac_rdp_glyph_begindraw() are rendered here, using
+ * the foreground color provided to guac_rdp_glyph_begindraw().
  *
  * @param context
  *     The rdpContext associated with the current RDP session.
@@ -166,4 +244,14 @@ void guac_rdp_glyph_begindraw(rdpContext* context,
 void guac_rdp_glyph_enddraw(rdpContext* context,
         int x, int y, int width, int height, UINT32 fgcolor, UINT32 bgcolor);
 
+/**
+ * Frees all memory associated with the given glyph run, other than its
+ * off-screen buffers, which are freed along with the display that allocated
+ * them. The run is reset such that it can be used again with a new display.
+ *
+ * @param run
+ *     The glyph run to reset.
+ */
+void guac_rdp_glyph_run_reset(guac_rdp_glyph_run* run);
+
 #endif
@@ -21,11 +21,9 @@
 
 #include "client.h"
 #include "guac_cursor.h"
-#include "guac_display.h"
 #include "rdp.h"
 #include "rdp_pointer.h"
 
-#include <cairo/cairo.h>
 #include <freerdp/freerdp.h>
 #include <guacamole/client.h>
 
@@ -33,19 +31,10 @@
 
 void guac_rdp_pointer_new(rdpContext* context, rdpPointer* pointer) {
 
-    guac_client* client = ((rdp_freerdp_context*) context)->client;
-    guac_rdp_client* rdp_client = (guac_rdp_client*) client->data;
-
-    /* Allocate buffer */
-    guac_common_display_layer* buffer = guac_common_display_alloc_buffer(
-            rdp_client->display, pointer->width, pointer->height);
-
     /* Allocate data for image */
     unsigned char* data =
         (unsigned char*) malloc(pointer->width * pointer->height * 4);
 
-    cairo_surface_t* surface;
-
     /* Convert to alpha cursor if mask data present */
     if (pointer->andMaskData && pointer->xorMaskData)
         freerdp_alpha_cursor_convert(data,
@@ -53,20 +42,8 @@ void guac_rdp_pointer_new(rdpContext* context, rdpPointer* pointer) {
                 pointer->width, pointer->height, pointer->xorBpp,
                 ((rdp_freerdp_context*) context)->clrconv);
 
-    /* Create surface from image data */
-    surface = cairo_image_surface_create_for_data(
-        data, CAIRO_FORMAT_ARGB32,
-        pointer->width, pointer->height, 4*pointer->width);
-
-    /* Send surface to buffer */
-    guac_common_surface_draw(buffer->surface, 0, 0, surface);
-
-    /* Free surface */
-    cairo_surface_destroy(surface);
-    free(data);
-
-    /* Remember buffer */
-    ((guac_rdp_pointer*) pointer)->layer = buffer;
+    /* Remember image data */
+    ((guac_rdp_pointer*) pointer)->image = data;
 
 }
 
@@ -75,21 +52,18 @@ void guac_rdp_pointer_set(rdpContext* context, rdpPointer* pointer) {
     guac_client* client = ((rdp_freerdp_context*) context)->client;
     guac_rdp_client* rdp_client = (guac_rdp_client*) client->data;
 
-    /* Set cursor */
-    guac_common_cursor_set_surface(rdp_client->display->cursor,
+    /* Set cursor, reusing any identical image already sent */
+    guac_common_cursor_set_argb(rdp_client->display->cursor,
             pointer->xPos, pointer->yPos,
-            ((guac_rdp_pointer*) pointer)->layer->surface);
+            ((guac_rdp_pointer*) pointer)->image,
+            pointer->width, pointer->height, 4*pointer->width);
 
 }
 
 void guac_rdp_pointer_free(rdpContext* context, rdpPointer* pointer) {
 
-    guac_client* client = ((rdp_freerdp_context*) context)->client;
-    guac_rdp_client* rdp_client = (guac_rdp_client*) client->data;
-    guac_common_display_layer* buffer = ((guac_rdp_pointer*) pointer)->layer;
-
-    /* Free buffer */
-    guac_common_display_free_buffer(rdp_client->display, buffer);
+    /* Free image data */
+    free(((guac_rdp_pointer*) pointer)->image);
 
 }
 
@@ -22,7 +22,6 @@
 #define _GUAC_RDP_RDP_POINTER_H
 
 #include "config.h"
-#include "guac_display.h"
 
 #include <freerdp/freerdp.h>
 
@@ -37,9 +36,12 @@ typedef struct guac_rdp_pointer {
     rdpPointer pointer;
 
     /**
-     * The display layer containing cached image data.
+     * The image data of this pointer, in CAIRO_FORMAT_ARGB32, with a stride
+     * of exactly four times the width of the pointer. The image is sent to
+     * connected users only when the pointer is set, and only if an identical
+     * image is not already cached by the shared cursor.
      */
-    guac_common_display_layer* layer;
+    unsigned char* image;
 
 } guac_rdp_pointer;
 
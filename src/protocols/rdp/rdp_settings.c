@@ -65,6 +65,7 @@ const char* GUAC_RDP_CLIENT_ARGS[] = {
     "remote-app-dir",
     "remote-app-args",
     "static-channels",
+    "static-channels-coalesce",
     "client-name",
     "enable-wallpaper",
     "enable-theming",
@@ -244,6 +245,14 @@ enum RDP_ARGS_IDX {
      */
     IDX_STATIC_CHANNELS,
 
+    /**
+     * Comma-separated list of the names of the static virtual channels,
+     * among those listed in IDX_STATIC_CHANNELS, whose data may be buffered
+     * and coalesced without regard for message boundaries, or blank if the
+     * data of all static virtual channels should be passed through as-is.
+     */
+    IDX_STATIC_CHANNELS_COALESCE,
+
     /**
      * The name of the client to submit to the RDP server upon connection.
      */
@@ -558,6 +567,12 @@ guac_rdp_settings* guac_rdp_parse_args(guac_user* user,
     if (argv[IDX_STATIC_CHANNELS][0] != '\0')
         settings->svc_names = guac_split(argv[IDX_STATIC_CHANNELS], ',');
 
+    /* Static virtual channels which may be coalesced */
+    settings->svc_coalesce_names = NULL;
+    if (argv[IDX_STATIC_CHANNELS_COALESCE][0] != '\0')
+        settings->svc_coalesce_names =
+            guac_split(argv[IDX_STATIC_CHANNELS_COALESCE], ',');
+
     /*
      * Performance flags
      */
@@ -788,6 +803,21 @@ void guac_rdp_settings_free(guac_rdp_settings* settings) {
 
     }
 
+    /* Free coalesced channel name array */
+    if (settings->svc_coalesce_names != NULL) {
+
+        /* Free all elements of array */
+        char** current = &(settings->svc_coalesce_names[0]);
+        while (*current != NULL) {
+            free(*current);
+            current++;
+        }
+
+        /* Free array itself */
+        free(settings->svc_coalesce_names);
+
+    }
+
 #ifdef ENABLE_COMMON_SSH
     /* Free SFTP settings */
     free(settings->sftp_directory);
@@ -253,6 +253,12 @@ typedef struct guac_rdp_settings {
      */
     char** svc_names;
 
+    /**
+     * NULL-terminated list of the names of all static virtual channels whose
+     * data may be coalesced, or NULL if no channels may be coalesced.
+     */
+    char** svc_coalesce_names;
+
     /**
      * Whether the desktop wallpaper should be visible. If unset, the desktop
      * wallpaper will be hidden, reducing the amount of bandwidth required.
@@ -231,7 +231,10 @@ int guac_rdp_svc_blob_handler(guac_user* user, guac_stream* stream,
 
     guac_rdp_stream* rdp_stream = (guac_rdp_stream*) stream->data;
 
-    /* Write blob data to SVC directly */
+    /* Write blob data to SVC (possibly buffered, if coalescing is enabled
+     * for the channel). Note that the ack below does not reflect whether
+     * the RDP server has actually received the data, as FreeRDP queues
+     * channel writes without reporting their completion. */
     guac_rdp_svc_write(rdp_stream->svc, data, length);
 
     guac_protocol_send_ack(user->socket, stream, "OK (DATA RECEIVED)",
@@ -375,94 +378,21 @@ int guac_rdp_download_ack_handler(guac_user* user, guac_stream* stream,
 int guac_rdp_ls_ack_handler(guac_user* user, guac_stream* stream,
         char* message, guac_protocol_status status) {
 
-    int blob_written = 0;
-    const char* filename;
-
     guac_rdp_stream* rdp_stream = (guac_rdp_stream*) stream->data;
 
     /* If unsuccessful, free stream and abort */
     if (status != GUAC_PROTOCOL_STATUS_SUCCESS) {
-        guac_rdp_fs_close(rdp_stream->ls_status.fs,
-                rdp_stream->ls_status.file_id);
-        guac_user_free_stream(user, stream);
+        guac_common_listing_stream_abort(&rdp_stream->ls_status.listing,
+                user, stream);
         free(rdp_stream);
         return 0;
     }
 
-    /* While directory entries remain */
-    while ((filename = guac_rdp_fs_read_dir(rdp_stream->ls_status.fs,
-                    rdp_stream->ls_status.file_id)) != NULL
-            && !blob_written) {
-
-        char absolute_path[GUAC_RDP_FS_MAX_PATH];
-
-        /* Skip current and parent directory entries */
-        if (strcmp(filename, ".") == 0 || strcmp(filename, "..") == 0)
-            continue;
-
-        /* Concatenate into absolute path - skip if invalid */
-        if (!guac_rdp_fs_append_filename(absolute_path,
-                    rdp_stream->ls_status.directory_name, filename)) {
-
-            guac_user_log(user, GUAC_LOG_DEBUG,
-                    "Skipping filename \"%s\" - filename is invalid or "
-                    "resulting path is too long", filename);
-
-            continue;
-        }
-
-        /* Attempt to open file to determine type */
-        int file_id = guac_rdp_fs_open(rdp_stream->ls_status.fs, absolute_path,
-                ACCESS_GENERIC_READ, 0, DISP_FILE_OPEN, 0);
-        if (file_id < 0)
-            continue;
-
-        /* Get opened file */
-        guac_rdp_fs_file* file = guac_rdp_fs_get_file(rdp_stream->ls_status.fs,
-                file_id);
-        if (file == NULL) {
-            guac_client_log(rdp_stream->ls_status.fs->client, GUAC_LOG_DEBUG,
-                    "%s: Successful open produced bad file_id: %i",
-                    __func__, file_id);
-            return 0;
-        }
-
-        /* Determine mimetype */
-        const char* mimetype;
-        if (file->attributes & FILE_ATTRIBUTE_DIRECTORY)
-            mimetype = GUAC_USER_STREAM_INDEX_MIMETYPE;
-        else
-            mimetype = "application/octet-stream";
-
-        /* Write entry */
-        blob_written |= guac_common_json_write_property(user, stream,
-                &rdp_stream->ls_status.json_state, absolute_path, mimetype);
-
-        guac_rdp_fs_close(rdp_stream->ls_status.fs, file_id);
-
-    }
-
-    /* Complete JSON and cleanup at end of directory */
-    if (filename == NULL) {
-
-        /* Complete JSON object */
-        guac_common_json_end_object(user, stream,
-                &rdp_stream->ls_status.json_state);
-        guac_common_json_flush(user, stream,
-                &rdp_stream->ls_status.json_state);
-
-        /* Clean up resources */
-        guac_rdp_fs_close(rdp_stream->ls_status.fs,
-                rdp_stream->ls_status.file_id);
+    /* Send further entries, cleaning up once the listing is complete */
+    if (guac_common_listing_stream_ack(&rdp_stream->ls_status.listing,
+                user, stream))
         free(rdp_stream);
 
-        /* Signal of stream */
-        guac_protocol_send_end(user->socket, stream);
-        guac_user_free_stream(user, stream);
-
-    }
-
-    guac_socket_flush(user->socket);
     return 0;
 
 }
@@ -499,22 +429,24 @@ int guac_rdp_download_get_handler(guac_user* user, guac_object* object,
     /* If directory, send contents of directory */
     if (file->attributes & FILE_ATTRIBUTE_DIRECTORY) {
 
+        /* Read entire directory (or use cached listing) */
+        guac_common_listing* listing = guac_rdp_fs_read_listing(fs,
+                file_id, name);
+        guac_rdp_fs_close(fs, file_id);
+
         /* Create stream data */
         guac_rdp_stream* rdp_stream = malloc(sizeof(guac_rdp_stream));
         rdp_stream->type = GUAC_RDP_LS_STREAM;
         rdp_stream->ls_status.fs = fs;
-        rdp_stream->ls_status.file_id = file_id;
-        strncpy(rdp_stream->ls_status.directory_name, name,
-                sizeof(rdp_stream->ls_status.directory_name) - 1);
 
         /* Allocate stream for body */
         guac_stream* stream = guac_user_alloc_stream(user);
         stream->ack_handler = guac_rdp_ls_ack_handler;
         stream->data = rdp_stream;
 
-        /* Init JSON object state */
-        guac_common_json_begin_object(user, stream,
-                &rdp_stream->ls_status.json_state);
+        /* Init listing stream state */
+        guac_common_listing_stream_init(&rdp_stream->ls_status.listing,
+                user, stream, fs->listing_cache, listing);
 
         /* Associate new stream with get request */
         guac_protocol_send_body(user->socket, object, stream,
@@ -23,6 +23,7 @@
 
 #include "config.h"
 #include "guac_json.h"
+#include "guac_listing.h"
 #include "rdp_svc.h"
 
 #include <guacamole/user.h>
@@ -77,19 +78,9 @@ typedef struct guac_rdp_ls_status {
     guac_rdp_fs* fs;
 
     /**
-     * The file ID of the directory being listed.
+     * The state of the directory listing being streamed.
      */
-    int file_id;
-
-    /**
-     * The absolute path of the directory being listed.
-     */
-    char directory_name[GUAC_RDP_FS_MAX_PATH];
-
-    /**
-     * The current state of the JSON directory object being written.
-     */
-    guac_common_json_state json_state;
+    guac_common_listing_stream listing;
 
 } guac_rdp_ls_status;
 
@@ -25,6 +25,7 @@
 
 #include <freerdp/utils/svc_plugin.h>
 #include <guacamole/client.h>
+#include <guacamole/protocol.h>
 
 #ifdef ENABLE_WINPR
 #include <winpr/stream.h>
@@ -32,6 +33,7 @@
 #include "compat/winpr-stream.h"
 #endif
 
+#include <pthread.h>
 #include <stdlib.h>
 #include <string.h>
 
@@ -43,6 +45,10 @@ guac_rdp_svc* guac_rdp_alloc_svc(guac_client* client, char* name) {
     svc->client = client;
     svc->plugin = NULL;
     svc->output_pipe = NULL;
+    svc->coalesce = 0;
+    svc->write_length = 0;
+    svc->blob_length = 0;
+    pthread_mutex_init(&(svc->lock), NULL);
 
     /* Warn about name length */
     if (strnlen(name, GUAC_RDP_SVC_MAX_LENGTH+1) > GUAC_RDP_SVC_MAX_LENGTH)
@@ -59,6 +65,7 @@ guac_rdp_svc* guac_rdp_alloc_svc(guac_client* client, char* name) {
 }
 
 void guac_rdp_free_svc(guac_rdp_svc* svc) {
+    pthread_mutex_destroy(&(svc->lock));
     free(svc);
 }
 
@@ -93,9 +100,11 @@ void guac_rdp_add_svc(guac_client* client, guac_rdp_svc* svc) {
     guac_rdp_client* rdp_client = (guac_rdp_client*) client->data;
 
     /* Add to list of available SVC */
+    pthread_mutex_lock(&(rdp_client->svc_flush_lock));
     guac_common_list_lock(rdp_client->available_svc);
     guac_common_list_add(rdp_client->available_svc, svc);
     guac_common_list_unlock(rdp_client->available_svc);
+    pthread_mutex_unlock(&(rdp_client->svc_flush_lock));
 
 }
 
@@ -132,6 +141,9 @@ guac_rdp_svc* guac_rdp_remove_svc(guac_client* client, const char* name) {
     guac_common_list_element* current;
     guac_rdp_svc* found = NULL;
 
+    /* Wait for any in-progress flush, which may be using the SVC */
+    pthread_mutex_lock(&(rdp_client->svc_flush_lock));
+
     /* For each available SVC */
     guac_common_list_lock(rdp_client->available_svc);
     current = rdp_client->available_svc->head;
@@ -149,17 +161,32 @@ guac_rdp_svc* guac_rdp_remove_svc(guac_client* client, const char* name) {
 
     }
     guac_common_list_unlock(rdp_client->available_svc);
+    pthread_mutex_unlock(&(rdp_client->svc_flush_lock));
 
     /* Return removed entry, if any */
     return found;
 
 }
 
-void guac_rdp_svc_write(guac_rdp_svc* svc, void* data, int length) {
+/**
+ * Writes the given data to the virtual channel as a single PDU. The SVC must
+ * be locked by the current thread.
+ *
+ * @param svc
+ *     The static virtual channel to write data to.
+ *
+ * @param data
+ *     The data to write.
+ *
+ * @param length
+ *     The number of bytes to write.
+ */
+static void __guac_rdp_svc_send_pdu(guac_rdp_svc* svc, void* data,
+        int length) {
 
     wStream* output_stream;
 
-    /* Do not write of plugin not associated */
+    /* Do not write if plugin not associated */
     if (svc->plugin == NULL) {
         guac_client_log(svc->client, GUAC_LOG_ERROR,
                 "Channel \"%s\" output dropped.",
@@ -176,3 +203,155 @@ void guac_rdp_svc_write(guac_rdp_svc* svc, void* data, int length) {
 
 }
 
+/**
+ * Writes all data within the write buffer of the given SVC to the virtual
+ * channel as a single PDU. The SVC must be locked by the current thread.
+ *
+ * @param svc
+ *     The static virtual channel to write buffered data to.
+ */
+static void __guac_rdp_svc_flush_write(guac_rdp_svc* svc) {
+
+    /* Nothing to do if no data is buffered */
+    if (svc->write_length == 0)
+        return;
+
+    __guac_rdp_svc_send_pdu(svc, svc->write_buffer, svc->write_length);
+    svc->write_length = 0;
+
+}
+
+/**
+ * Sends all data within the blob buffer of the given SVC along its output
+ * pipe as a single blob. The SVC must be locked by the current thread.
+ *
+ * @param svc
+ *     The static virtual channel to send buffered data for.
+ */
+static void __guac_rdp_svc_flush_blob(guac_rdp_svc* svc) {
+
+    /* Nothing to do if no data is buffered */
+    if (svc->blob_length == 0)
+        return;
+
+    guac_protocol_send_blob(svc->client->socket, svc->output_pipe,
+            svc->blob_buffer, svc->blob_length);
+
+    svc->blob_length = 0;
+
+}
+
+void guac_rdp_svc_write(guac_rdp_svc* svc, void* data, int length) {
+
+    char* current = (char*) data;
+    int original_length = length;
+
+    pthread_mutex_lock(&(svc->lock));
+
+    /* Without coalescing, each blob is written as its own PDU, preserving
+     * the boundaries of the data as sent by the user */
+    if (!svc->coalesce) {
+        __guac_rdp_svc_send_pdu(svc, data, length);
+        pthread_mutex_unlock(&(svc->lock));
+        return;
+    }
+
+    while (length > 0) {
+
+        /* Write buffer to channel once full */
+        int remaining = GUAC_RDP_SVC_WRITE_BUFFER_SIZE - svc->write_length;
+        if (remaining == 0) {
+            __guac_rdp_svc_flush_write(svc);
+            remaining = GUAC_RDP_SVC_WRITE_BUFFER_SIZE;
+        }
+
+        /* Append as much data as possible */
+        if (remaining > length)
+            remaining = length;
+
+        memcpy(svc->write_buffer + svc->write_length, current, remaining);
+        svc->write_length += remaining;
+
+        current += remaining;
+        length -= remaining;
+
+    }
+
+    /* A blob shorter than the maximum typically ends a burst of data, and
+     * should not wait for the end of the frame */
+    if (original_length < GUAC_RDP_SVC_BLOB_SIZE)
+        __guac_rdp_svc_flush_write(svc);
+
+    pthread_mutex_unlock(&(svc->lock));
+
+}
+
+void guac_rdp_svc_receive(guac_rdp_svc* svc, void* data, int length) {
+
+    char* current = (char*) data;
+
+    /* Without coalescing, each received PDU is sent immediately as its own
+     * blob, preserving the boundaries of the data as sent by the server */
+    if (!svc->coalesce) {
+        guac_protocol_send_blob(svc->client->socket, svc->output_pipe,
+                data, length);
+        guac_socket_flush(svc->client->socket);
+        return;
+    }
+
+    pthread_mutex_lock(&(svc->lock));
+
+    while (length > 0) {
+
+        /* Send blob once buffer is full */
+        int remaining = GUAC_RDP_SVC_BLOB_SIZE - svc->blob_length;
+        if (remaining == 0) {
+            __guac_rdp_svc_flush_blob(svc);
+            remaining = GUAC_RDP_SVC_BLOB_SIZE;
+        }
+
+        /* Append as much data as possible */
+        if (remaining > length)
+            remaining = length;
+
+        memcpy(svc->blob_buffer + svc->blob_length, current, remaining);
+        svc->blob_length += remaining;
+
+        current += remaining;
+        length -= remaining;
+
+    }
+
+    pthread_mutex_unlock(&(svc->lock));
+
+}
+
+void guac_rdp_svc_flush(guac_rdp_svc* svc) {
+
+    pthread_mutex_lock(&(svc->lock));
+    __guac_rdp_svc_flush_write(svc);
+    __guac_rdp_svc_flush_blob(svc);
+    pthread_mutex_unlock(&(svc->lock));
+
+}
+
+void guac_rdp_svc_flush_all(guac_client* client) {
+
+    guac_rdp_client* rdp_client = (guac_rdp_client*) client->data;
+
+    /* The list of SVCs cannot change while the flush lock is held. The lock
+     * of the list itself is NOT held while flushing, as flushing sends data
+     * to connected users, and that lock is also acquired by users joining
+     * the connection (see guac_rdp_svc_send_pipes()). */
+    pthread_mutex_lock(&(rdp_client->svc_flush_lock));
+
+    /* Flush each allocated SVC */
+    guac_common_list_element* current = rdp_client->available_svc->head;
+    while (current != NULL) {
+        guac_rdp_svc_flush((guac_rdp_svc*) current->data);
+        current = current->next;
+    }
+
+    pthread_mutex_unlock(&(rdp_client->svc_flush_lock));
+
+}
@@ -26,11 +26,35 @@
 #include <guacamole/client.h>
 #include <guacamole/stream.h>
 
+#include <pthread.h>
+
 /**
  * The maximum number of characters to allow for each channel name.
  */
 #define GUAC_RDP_SVC_MAX_LENGTH 7
 
+/**
+ * The size of each chunk of a static virtual channel PDU, in bytes, as
+ * defined by the RDP specification (CHANNEL_CHUNK_LENGTH). Data written to a
+ * channel is split into chunks of this size by FreeRDP.
+ */
+#define GUAC_RDP_SVC_CHUNK_LENGTH 1600
+
+/**
+ * The maximum number of bytes of data received from Guacamole users to
+ * buffer before writing that data to the static virtual channel as a single
+ * PDU. This is a whole number of channel chunks, such that each write fills
+ * every chunk.
+ */
+#define GUAC_RDP_SVC_WRITE_BUFFER_SIZE (16 * GUAC_RDP_SVC_CHUNK_LENGTH)
+
+/**
+ * The maximum number of bytes of data received from the static virtual
+ * channel to send within a single blob along the SVC's output pipe. This is
+ * also the size of the largest blobs typically sent by Guacamole clients.
+ */
+#define GUAC_RDP_SVC_BLOB_SIZE 6048
+
 /**
  * Structure describing a static virtual channel, and the corresponding
  * Guacamole pipes.
@@ -58,6 +82,44 @@ typedef struct guac_rdp_svc {
      */
     guac_stream* output_pipe;
 
+    /**
+     * Non-zero if data passing through this SVC may be coalesced, zero if
+     * each blob received from Guacamole users must be written to the
+     * channel as its own PDU and each PDU received from the channel must be
+     * sent immediately as its own blob. Coalescing does not preserve message
+     * boundaries, and must only be enabled for channels whose protocol does
+     * not depend on them.
+     */
+    int coalesce;
+
+    /**
+     * Lock which guards the write and blob buffers of this SVC, which may be
+     * appended to and flushed by different threads.
+     */
+    pthread_mutex_t lock;
+
+    /**
+     * Data received from Guacamole users which has not yet been written to
+     * the static virtual channel.
+     */
+    char write_buffer[GUAC_RDP_SVC_WRITE_BUFFER_SIZE];
+
+    /**
+     * The number of bytes currently stored within write_buffer.
+     */
+    int write_length;
+
+    /**
+     * Data received from the static virtual channel which has not yet been
+     * sent along the output pipe.
+     */
+    char blob_buffer[GUAC_RDP_SVC_BLOB_SIZE];
+
+    /**
+     * The number of bytes currently stored within blob_buffer.
+     */
+    int blob_length;
+
 } guac_rdp_svc;
 
 /**
@@ -150,7 +212,10 @@ guac_rdp_svc* guac_rdp_get_svc(guac_client* client, const char* name);
 guac_rdp_svc* guac_rdp_remove_svc(guac_client* client, const char* name);
 
 /**
- * Write the given blob of data to the virtual channel.
+ * Write the given blob of data to the virtual channel. If coalescing is
+ * enabled for the SVC, the data may be buffered and combined with other
+ * blobs, and will be written no later than the next call to
+ * guac_rdp_svc_flush(). Otherwise, the blob is written as a single PDU.
  *
  * @param svc
  *     The static virtual channel to write data to.
@@ -163,5 +228,40 @@ guac_rdp_svc* guac_rdp_remove_svc(guac_client* client, const char* name);
  */
 void guac_rdp_svc_write(guac_rdp_svc* svc, void* data, int length);
 
+/**
+ * Sends the given data, received from the virtual channel, along the SVC's
+ * output pipe. If coalescing is enabled for the SVC, the data may be
+ * buffered and combined with other received data, and will be sent no later
+ * than the next call to guac_rdp_svc_flush().
+ *
+ * @param svc
+ *     The static virtual channel that the data was received from.
+ *
+ * @param data
+ *     The data received.
+ *
+ * @param length
+ *     The number of bytes received.
+ */
+void guac_rdp_svc_receive(guac_rdp_svc* svc, void* data, int length);
+
+/**
+ * Writes any data buffered for the given SVC to the virtual channel, and
+ * sends any data buffered for the SVC's output pipe.
+ *
+ * @param svc
+ *     The static virtual channel to flush.
+ */
+void guac_rdp_svc_flush(guac_rdp_svc* svc);
+
+/**
+ * Flushes all static virtual channels available to the given client, as
+ * with guac_rdp_svc_flush().
+ *
+ * @param client
+ *     The guac_client associated with the current RDP session.
+ */
+void guac_rdp_svc_flush_all(guac_client* client);
+
 #endif
 
@@ -71,17 +71,36 @@ int guac_ssh_user_size_handler(guac_user* user, int width, int height) {
     if (terminal == NULL)
         return 0;
 
-    /* Resize terminal */
-    guac_terminal_resize(terminal, width, height);
+    /* Resize terminal at next frame boundary (the SSH pty size is updated
+     * by guac_ssh_terminal_resize_handler() once applied) */
+    guac_terminal_request_resize(terminal, width, height);
+
+    return 0;
+}
+
+void guac_ssh_terminal_resize_handler(guac_client* client,
+        int columns, int rows) {
+
+    guac_ssh_client* ssh_client = (guac_ssh_client*) client->data;
 
     /* Update SSH pty size if connected */
     if (ssh_client->term_channel != NULL) {
-        pthread_mutex_lock(&(ssh_client->term_channel_lock));
-        libssh2_channel_request_pty_size(ssh_client->term_channel,
-                terminal->term_width, terminal->term_height);
-        pthread_mutex_unlock(&(ssh_client->term_channel_lock));
+
+        int result;
+        do {
+
+            pthread_mutex_lock(&(ssh_client->term_channel_lock));
+            result = libssh2_channel_request_pty_size(
+                    ssh_client->term_channel, columns, rows);
+            pthread_mutex_unlock(&(ssh_client->term_channel_lock));
+
+            /* The session is non-blocking; retry once the socket is ready */
+        } while (result == LIBSSH2_ERROR_EAGAIN
+                && client->state == GUAC_CLIENT_RUNNING
+                && guac_ssh_wait_socket(ssh_client,
+                    GUAC_SSH_WRITE_WAIT_TIMEOUT) >= 0);
+
     }
 
-    return 0;
 }
 
@@ -21,6 +21,7 @@
 #define GUAC_SSH_INPUT_H
 
 #include "config.h"
+#include "terminal.h"
 
 #include <guacamole/user.h>
 
@@ -39,5 +40,11 @@ guac_user_key_handler guac_ssh_user_key_handler;
  */
 guac_user_size_handler guac_ssh_user_size_handler;
 
+/**
+ * Handler for terminal resizes, updating the size of the SSH pty to match
+ * the new dimensions of the terminal.
+ */
+guac_terminal_resize_handler guac_ssh_terminal_resize_handler;
+
 #endif
 
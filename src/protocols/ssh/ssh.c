@@ -22,6 +22,7 @@
 #include "guac_recording.h"
 #include "guac_sftp.h"
 #include "guac_ssh.h"
+#include "input.h"
 #include "settings.h"
 #include "sftp.h"
 #include "ssh.h"
@@ -148,6 +149,90 @@ static guac_common_ssh_user* guac_ssh_get_user(guac_client* client) {
 
 }
 
+int guac_ssh_wait_socket(guac_ssh_client* ssh_client, int msec_timeout) {
+
+    int fd = ssh_client->session->fd;
+    int directions = libssh2_session_block_directions(
+            ssh_client->session->session);
+
+    /* Wait for inbound data if libssh2 is not waiting on anything specific */
+    if (directions == 0)
+        directions = LIBSSH2_SESSION_BLOCK_INBOUND;
+
+    /* Build fd_sets for each direction libssh2 is blocked on */
+    fd_set read_fds;
+    fd_set write_fds;
+    FD_ZERO(&read_fds);
+    FD_ZERO(&write_fds);
+
+    if (directions & LIBSSH2_SESSION_BLOCK_INBOUND)
+        FD_SET(fd, &read_fds);
+
+    if (directions & LIBSSH2_SESSION_BLOCK_OUTBOUND)
+        FD_SET(fd, &write_fds);
+
+    /* Split millisecond timeout into seconds and microseconds */
+    struct timeval timeout = {
+        .tv_sec  =  msec_timeout / 1000,
+        .tv_usec = (msec_timeout % 1000) * 1000
+    };
+
+    return select(fd + 1, &read_fds, &write_fds, NULL, &timeout);
+
+}
+
+/**
+ * Writes the entirety of the given data to the SSH terminal channel. As the
+ * SSH session is non-blocking, partial writes are continued, and writes which
+ * would block are retried once the session socket is ready, until the client
+ * stops.
+ *
+ * @param client
+ *     The guac_client associated with the SSH session whose terminal channel
+ *     should be written to.
+ *
+ * @param buffer
+ *     The data to write.
+ *
+ * @param length
+ *     The number of bytes of data to write.
+ *
+ * @return
+ *     Zero if all data was written successfully, non-zero otherwise.
+ */
+static int guac_ssh_write_all(guac_client* client,
+        const char* buffer, int length) {
+
+    guac_ssh_client* ssh_client = (guac_ssh_client*) client->data;
+
+    while (length > 0 && client->state == GUAC_CLIENT_RUNNING) {
+
+        pthread_mutex_lock(&(ssh_client->term_channel_lock));
+        int written = libssh2_channel_write(ssh_client->term_channel,
+                buffer, length);
+        pthread_mutex_unlock(&(ssh_client->term_channel_lock));
+
+        /* Retry once the socket is ready if the write would block */
+        if (written == LIBSSH2_ERROR_EAGAIN) {
+            if (guac_ssh_wait_socket(ssh_client,
+                        GUAC_SSH_WRITE_WAIT_TIMEOUT) < 0)
+                return 1;
+            continue;
+        }
+
+        /* Abort on any other error */
+        if (written < 0)
+            return 1;
+
+        buffer += written;
+        length -= written;
+
+    }
+
+    return 0;
+
+}
+
 void* ssh_input_thread(void* data) {
 
     guac_client* client = (guac_client*) data;
@@ -158,9 +243,8 @@ void* ssh_input_thread(void* data) {
 
     /* Write all data read */
     while ((bytes_read = guac_terminal_read_stdin(ssh_client->term, buffer, sizeof(buffer))) > 0) {
-        pthread_mutex_lock(&(ssh_client->term_channel_lock));
-        libssh2_channel_write(ssh_client->term_channel, buffer, bytes_read);
-        pthread_mutex_unlock(&(ssh_client->term_channel_lock));
+        if (guac_ssh_write_all(client, buffer, bytes_read))
+            break;
     }
 
     return NULL;
@@ -173,7 +257,7 @@ void* ssh_client_thread(void* data) {
     guac_ssh_client* ssh_client = (guac_ssh_client*) client->data;
     guac_ssh_settings* settings = ssh_client->settings;
 
-    char buffer[8192];
+    char buffer[GUAC_SSH_READ_BUFFER_SIZE];
 
     pthread_t input_thread;
 
@@ -205,6 +289,9 @@ void* ssh_client_thread(void* data) {
         return NULL;
     }
 
+    /* Inform remote side of terminal size changes */
+    ssh_client->term->resize_handler = guac_ssh_terminal_resize_handler;
+
     /* Set up typescript, if requested */
     if (settings->typescript_path != NULL) {
         guac_terminal_create_typescript(ssh_client->term,
@@ -360,20 +447,9 @@ void* ssh_client_thread(void* data) {
         }
 #endif
 
-        /* Wait for more data if reads turn up empty */
+        /* Wait for the session socket if reads turn up empty */
         if (total_read == 0) {
-            fd_set fds;
-            struct timeval timeout;
-
-            FD_ZERO(&fds);
-            FD_SET(ssh_client->session->fd, &fds);
-
-            /* Wait for one second */
-            timeout.tv_sec = 1;
-            timeout.tv_usec = 0;
-
-            if (select(ssh_client->session->fd + 1, &fds,
-                        NULL, NULL, &timeout) < 0)
+            if (guac_ssh_wait_socket(ssh_client, GUAC_SSH_WAIT_TIMEOUT) < 0)
                 break;
         }
 
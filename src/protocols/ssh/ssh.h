@@ -36,6 +36,29 @@
 
 #include <pthread.h>
 
+/**
+ * The size of the buffer used when reading terminal output from the SSH
+ * channel, in bytes. This is the maximum SSH packet payload accepted by
+ * libssh2, allowing each read to consume an entire packet.
+ */
+#define GUAC_SSH_READ_BUFFER_SIZE 32768
+
+/**
+ * The maximum amount of time to wait for the SSH session socket to become
+ * ready while no data is arriving, in milliseconds. This value must be kept
+ * reasonably small such that the stop signal from guac_client_stop() is
+ * noticed promptly.
+ */
+#define GUAC_SSH_WAIT_TIMEOUT 1000
+
+/**
+ * The maximum amount of time to wait for the SSH session socket to become
+ * ready when a write or request could not be completed without blocking, in
+ * milliseconds. As the main SSH client thread may consume the readiness being
+ * waited for, this value is kept small.
+ */
+#define GUAC_SSH_WRITE_WAIT_TIMEOUT 10
+
 /**
  * SSH-specific client data.
  */
@@ -108,5 +131,23 @@ typedef struct guac_ssh_client {
  */
 void* ssh_client_thread(void* data);
 
+/**
+ * Waits for the socket of the SSH session used by the SSH client thread to
+ * become ready in whichever directions libssh2 most recently reported as
+ * blocked (see libssh2_session_block_directions()). If libssh2 is not
+ * blocked in any direction, this function waits for inbound data.
+ *
+ * @param ssh_client
+ *     The SSH client whose session socket should be waited upon.
+ *
+ * @param msec_timeout
+ *     The maximum amount of time to wait, in milliseconds.
+ *
+ * @return
+ *     A positive value if the socket is ready, zero if the timeout elapsed,
+ *     or negative if an error occurred.
+ */
+int guac_ssh_wait_socket(guac_ssh_client* ssh_client, int msec_timeout);
+
 #endif
 
@@ -116,14 +116,21 @@ int guac_telnet_user_size_handler(guac_user* user, int width, int height) {
     if (terminal == NULL)
         return 0;
 
-    /* Resize terminal */
-    guac_terminal_resize(terminal, width, height);
+    /* Resize terminal at next frame boundary (NAWS is sent by
+     * guac_telnet_terminal_resize_handler() once applied) */
+    guac_terminal_request_resize(terminal, width, height);
+
+    return 0;
+}
+
+void guac_telnet_terminal_resize_handler(guac_client* client,
+        int columns, int rows) {
+
+    guac_telnet_client* telnet_client = (guac_telnet_client*) client->data;
 
     /* Update terminal window size if connected */
     if (telnet_client->telnet != NULL && telnet_client->naws_enabled)
-        guac_telnet_send_naws(telnet_client->telnet, terminal->term_width,
-                terminal->term_height);
+        guac_telnet_send_naws(telnet_client->telnet, columns, rows);
 
-    return 0;
 }
 
@@ -21,6 +21,7 @@
 #define GUAC_TELNET_INPUT_H
 
 #include "config.h"
+#include "terminal.h"
 
 #include <guacamole/user.h>
 
@@ -42,5 +43,12 @@ guac_user_mouse_handler guac_telnet_user_mouse_handler;
  */
 guac_user_size_handler guac_telnet_user_size_handler;
 
+/**
+ * Handler for terminal resizes. Called by the terminal once a requested
+ * resize has been applied, sending the new dimensions to the telnet server
+ * via NAWS if the server has enabled that option.
+ */
+guac_terminal_resize_handler guac_telnet_terminal_resize_handler;
+
 #endif
 
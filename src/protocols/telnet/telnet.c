@@ -19,6 +19,7 @@
 
 #include "config.h"
 #include "guac_recording.h"
+#include "input.h"
 #include "telnet.h"
 #include "terminal.h"
 
@@ -487,6 +488,9 @@ void* guac_telnet_client_thread(void* data) {
         return NULL;
     }
 
+    /* Inform remote side of terminal size changes */
+    telnet_client->term->resize_handler = guac_telnet_terminal_resize_handler;
+
     /* Set up typescript, if requested */
     if (settings->typescript_path != NULL) {
         guac_terminal_create_typescript(telnet_client->term,
@@ -71,7 +71,8 @@ int guac_vnc_client_free_handler(guac_client* client) {
         pthread_join(vnc_client->client_thread, NULL);
 
         /* Free memory not free'd by libvncclient's rfbClientCleanup() */
-        if (rfb_client->frameBuffer != NULL) free(rfb_client->frameBuffer);
+        if (rfb_client->frameBuffer != NULL && !vnc_client->shared_framebuffer)
+            free(rfb_client->frameBuffer);
         if (rfb_client->raw_buffer != NULL) free(rfb_client->raw_buffer);
         if (rfb_client->rcSource != NULL) free(rfb_client->rcSource);
 
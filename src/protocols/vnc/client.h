@@ -44,6 +44,15 @@
  */
 #define GUAC_VNC_FRAME_START_TIMEOUT 1000000
 
+/**
+ * The maximum amount of time to sleep at once while waiting for connected
+ * users to catch up before reading the next update from the VNC server, in
+ * milliseconds. This value must be kept reasonably small such that external
+ * events (such as the stop signal from guac_client_stop()) are still handled
+ * promptly while waiting.
+ */
+#define GUAC_VNC_LAG_WAIT_INTERVAL 40
+
 /**
  * The number of milliseconds to wait between connection attempts.
  */
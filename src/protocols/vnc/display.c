@@ -25,6 +25,7 @@
 #include "vnc.h"
 
 #include <cairo/cairo.h>
+#include <guacamole/arena.h>
 #include <guacamole/client.h>
 #include <guacamole/layer.h>
 #include <guacamole/protocol.h>
@@ -67,9 +68,20 @@ void guac_vnc_update(rfbClient* client, int x, int y, int w, int h) {
         return;
     }
 
-    /* Init Cairo buffer */
+    /* Update was decoded directly into the surface if shared */
+    if (vnc_client->shared_framebuffer) {
+        guac_common_surface_invalidate(vnc_client->display->default_surface,
+                x, y, w, h);
+        return;
+    }
+
+    /* Init Cairo buffer within temporary storage */
+    guac_arena_mark mark = guac_arena_get_mark();
     stride = cairo_format_stride_for_width(CAIRO_FORMAT_RGB24, w);
-    buffer = malloc(h*stride);
+    buffer = guac_arena_alloc(h*stride);
+    if (buffer == NULL)
+        return;
+
     buffer_row_current = buffer;
 
     bpp = client->format.bitsPerPixel/8;
@@ -134,7 +146,7 @@ void guac_vnc_update(rfbClient* client, int x, int y, int w, int h) {
 
     /* Free surface */
     cairo_surface_destroy(surface);
-    free(buffer);
+    guac_arena_release(mark);
 
 }
 
@@ -190,17 +202,84 @@ void guac_vnc_set_pixel_format(rfbClient* client, int color_depth) {
     }
 }
 
+/**
+ * Returns whether libvncclient can decode updates directly into the default
+ * surface of the display associated with the given VNC client. This is only
+ * possible if the display exists and the VNC pixel format is byte-for-byte
+ * identical to the Cairo RGB24 format of that surface.
+ *
+ * @param rfb_client
+ *     The rfbClient whose pixel format should be checked.
+ *
+ * @param vnc_client
+ *     The VNC client associated with the given rfbClient.
+ *
+ * @return
+ *     Non-zero if the framebuffer can be shared with the display, zero
+ *     otherwise.
+ */
+static int guac_vnc_can_share_framebuffer(rfbClient* rfb_client,
+        guac_vnc_client* vnc_client) {
+
+    rfbPixelFormat* format = &rfb_client->format;
+
+    /* Display must exist */
+    if (vnc_client->display == NULL)
+        return 0;
+
+    /* Red and blue cannot be swapped during a straight copy */
+    if (vnc_client->settings->swap_red_blue)
+        return 0;
+
+    /* Rows must be packed identically */
+    if (vnc_client->display->default_surface->stride != rfb_client->width * 4)
+        return 0;
+
+    /* Format must match Cairo's CAIRO_FORMAT_RGB24 */
+    return format->bitsPerPixel == 32
+        && format->trueColour
+        && !format->bigEndian
+        && format->redShift   == 16 && format->redMax   == 0xff
+        && format->greenShift == 8  && format->greenMax == 0xff
+        && format->blueShift  == 0  && format->blueMax  == 0xff;
+
+}
+
 rfbBool guac_vnc_malloc_framebuffer(rfbClient* rfb_client) {
 
     guac_client* gc = rfbClientGetClientData(rfb_client, GUAC_VNC_CLIENT_KEY);
     guac_vnc_client* vnc_client = (guac_vnc_client*) gc->data;
 
-    /* Resize surface */
-    if (vnc_client->display != NULL)
-        guac_common_surface_resize(vnc_client->display->default_surface,
-                rfb_client->width, rfb_client->height);
+    /* Resize surface if dimensions have changed */
+    if (vnc_client->display != NULL) {
+
+        guac_common_surface* surface = vnc_client->display->default_surface;
+
+        if (surface->width != rfb_client->width
+                || surface->height != rfb_client->height)
+            guac_common_surface_resize(surface,
+                    rfb_client->width, rfb_client->height);
+
+    }
+
+    /* Decode directly into the surface if pixel formats are identical */
+    if (guac_vnc_can_share_framebuffer(rfb_client, vnc_client)) {
+
+        if (!vnc_client->shared_framebuffer)
+            free(rfb_client->frameBuffer);
+
+        rfb_client->frameBuffer = vnc_client->display->default_surface->buffer;
+        vnc_client->shared_framebuffer = 1;
+        return TRUE;
+
+    }
+
+    /* Never allow libvncclient to free the surface's buffer */
+    if (vnc_client->shared_framebuffer) {
+        rfb_client->frameBuffer = NULL;
+        vnc_client->shared_framebuffer = 0;
+    }
 
     /* Use original, wrapped proc */
     return vnc_client->rfb_MallocFrameBuffer(rfb_client);
 }
-
@@ -103,13 +103,18 @@ void guac_vnc_set_pixel_format(rfbClient* client, int color_depth);
 /**
  * Overridden implementation of the rfb_MallocFrameBuffer function invoked by
  * libVNCServer when the display is being resized (or initially allocated).
+ * If the display has been allocated and the pixel format of the VNC session
+ * is identical to that of the display, the buffer of the display's default
+ * surface is used as the framebuffer, and libvncclient's own framebuffer
+ * allocation is skipped entirely.
  *
  * @param client
  *     The VNC client associated with the VNC session whose display needs to be
  *     allocated or reallocated.
  *
  * @return
- *     The original value returned by rfb_MallocFrameBuffer().
+ *     TRUE if the display's surface is being used as the framebuffer,
+ *     otherwise the original value returned by rfb_MallocFrameBuffer().
  */
 rfbBool guac_vnc_malloc_framebuffer(rfbClient* rfb_client);
 
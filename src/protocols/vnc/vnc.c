@@ -163,6 +163,44 @@ static int guac_vnc_wait_for_messages(rfbClient* rfb_client, int timeout) {
 
 }
 
+/**
+ * Waits until all users of the given client have had time to process the
+ * previous frame, as measured by their reported processing lag. The VNC
+ * server is not read from while waiting. As libvncclient requests each new
+ * framebuffer update only after handling the previous one, this paces the
+ * updates requested from the VNC server to the slowest connected user,
+ * rather than pulling frames that those users cannot keep up with.
+ *
+ * @param client
+ *     The guac_client whose users should be waited for.
+ *
+ * @param last_frame_end
+ *     The time that the previous frame was flushed, in milliseconds.
+ */
+static void guac_vnc_wait_for_users(guac_client* client,
+        guac_timestamp last_frame_end) {
+
+    while (client->state == GUAC_CLIENT_RUNNING) {
+
+        /* Calculate time that client needs to catch up */
+        int processing_lag = guac_client_get_processing_lag(client);
+        int time_elapsed = guac_timestamp_current() - last_frame_end;
+        int required_wait = processing_lag - time_elapsed;
+
+        /* Done once client has had time to process the previous frame */
+        if (required_wait <= GUAC_VNC_FRAME_TIMEOUT)
+            break;
+
+        /* Wait in small increments, as lag may decrease while waiting */
+        if (required_wait > GUAC_VNC_LAG_WAIT_INTERVAL)
+            required_wait = GUAC_VNC_LAG_WAIT_INTERVAL;
+
+        guac_timestamp_msleep(required_wait);
+
+    }
+
+}
+
 void* guac_vnc_client_thread(void* data) {
 
     guac_client* client = (guac_client*) data;
@@ -217,7 +255,10 @@ void* guac_vnc_client_thread(void* data) {
 
         /* If successful, init audio system */
         if (vnc_client->audio != NULL) {
-            
+
+            /* Skip silence, flushing any audio which preceded it */
+            vnc_client->audio->suppress_silence = 1;
+
             guac_client_log(client, GUAC_LOG_INFO,
                     "Audio will be encoded as %s",
                     vnc_client->audio->encoder->mimetype);
@@ -341,6 +382,9 @@ void* guac_vnc_client_thread(void* data) {
     vnc_client->display = guac_common_display_alloc(client,
             rfb_client->width, rfb_client->height);
 
+    /* Decode directly into the display from now on, if possible */
+    guac_vnc_malloc_framebuffer(rfb_client);
+
     /* If not read-only, set an appropriate cursor */
     if (settings->read_only == 0) {
         if (settings->remote_cursor)
@@ -357,12 +401,14 @@ void* guac_vnc_client_thread(void* data) {
     /* Handle messages from VNC server while client is running */
     while (client->state == GUAC_CLIENT_RUNNING) {
 
+        /* Do not request further updates until users have caught up */
+        guac_vnc_wait_for_users(client, last_frame_end);
+
         /* Wait for start of frame */
         int wait_result = guac_vnc_wait_for_messages(rfb_client,
                 GUAC_VNC_FRAME_START_TIMEOUT);
         if (wait_result > 0) {
 
-            int processing_lag = guac_client_get_processing_lag(client);
             guac_timestamp frame_start = guac_timestamp_current();
 
             /* Read server messages until frame is built */
@@ -384,17 +430,8 @@ void* guac_vnc_client_thread(void* data) {
                 frame_remaining = frame_start + GUAC_VNC_FRAME_DURATION
                                 - frame_end;
 
-                /* Calculate time that client needs to catch up */
-                int time_elapsed = frame_end - last_frame_end;
-                int required_wait = processing_lag - time_elapsed;
-
-                /* Increase the duration of this frame if client is lagging */
-                if (required_wait > GUAC_VNC_FRAME_TIMEOUT)
-                    wait_result = guac_vnc_wait_for_messages(rfb_client,
-                            required_wait*1000);
-
                 /* Wait again if frame remaining */
-                else if (frame_remaining > 0)
+                if (frame_remaining > 0)
                     wait_result = guac_vnc_wait_for_messages(rfb_client,
                             GUAC_VNC_FRAME_TIMEOUT*1000);
                 else
@@ -409,7 +446,7 @@ void* guac_vnc_client_thread(void* data) {
             guac_client_abort(client, GUAC_PROTOCOL_STATUS_UPSTREAM_ERROR, "Connection closed.");
 
         /* Flush frame */
-        guac_common_surface_flush(vnc_client->display->default_surface);
+        guac_common_display_flush(vnc_client->display);
         guac_client_end_frame(client);
         guac_socket_flush(client->socket);
 
@@ -66,6 +66,15 @@ typedef struct guac_vnc_client {
      */
     MallocFrameBufferProc rfb_MallocFrameBuffer;
 
+    /**
+     * Non-zero if the frameBuffer of the rfbClient is the buffer of the
+     * default surface of the display, such that libvncclient decodes updates
+     * directly into that surface, zero if libvncclient allocated its own
+     * framebuffer. A shared framebuffer is owned by the surface and must never
+     * be freed by libvncclient or by the VNC client itself.
+     */
+    int shared_framebuffer;
+
     /**
      * Whether copyrect  was used to produce the latest update received
      * by the VNC server.
@@ -51,6 +51,11 @@ guac_terminal_buffer* guac_terminal_buffer_alloc(int rows, guac_terminal_char* d
         row->length = 0;
         row->characters = malloc(sizeof(guac_terminal_char) * row->available);
 
+        /* Text cache is allocated when the row first enters scrollback */
+        row->text = NULL;
+        row->text_length = 0;
+        row->text_available = 0;
+
         /* Next row */
         row++;
 
@@ -68,6 +73,7 @@ void guac_terminal_buffer_free(guac_terminal_buffer* buffer) {
     /* Free all rows */
     for (i=0; i<buffer->available; i++) {
         free(row->characters);
+        free(row->text);
         row++;
     }
 
@@ -209,3 +215,79 @@ void guac_terminal_buffer_set_columns(guac_terminal_buffer* buffer, int row,
 
 }
 
+
+int guac_terminal_buffer_row_string(guac_terminal_buffer_row* row,
+        int start, int end, char* string) {
+
+    int length = 0;
+    int i;
+
+    guac_terminal_char* current = &(row->characters[start]);
+    for (i=start; i<=end; i++, current++) {
+
+        int codepoint = current->value;
+
+        /* Store ASCII directly, without the overhead of a general encode */
+        if (codepoint > 0 && codepoint < 0x80)
+            string[length++] = codepoint;
+
+        /* If not null (blank), add to string */
+        else if (codepoint != 0 && codepoint != GUAC_CHAR_CONTINUATION)
+            length += guac_terminal_encode_utf8(codepoint, string + length);
+
+    }
+
+    return length;
+
+}
+
+void guac_terminal_buffer_cache_row(guac_terminal_buffer* buffer, int row) {
+
+    guac_terminal_buffer_row* buffer_row =
+        guac_terminal_buffer_get_row(buffer, row, 0);
+
+    /* Each character requires at most four bytes of UTF-8 */
+    int required = buffer_row->length * 4;
+    if (required > buffer_row->text_available) {
+
+        /* Leave the row without cached text if it cannot be resized */
+        char* text = realloc(buffer_row->text, required);
+        if (text == NULL) {
+            buffer_row->text_length = 0;
+            return;
+        }
+
+        buffer_row->text = text;
+        buffer_row->text_available = required;
+
+    }
+
+    buffer_row->text_length = guac_terminal_buffer_row_string(buffer_row,
+            0, buffer_row->length - 1, buffer_row->text);
+
+}
+
+void guac_terminal_buffer_shift_up(guac_terminal_buffer* buffer, int amount) {
+
+    int row;
+
+    /* Cache text of rows entering scrollback */
+    for (row = 0; row < amount; row++)
+        guac_terminal_buffer_cache_row(buffer, row);
+
+    /* Advance top of visible area, wrapping around end of buffer */
+    buffer->top += amount;
+    if (buffer->top >= buffer->available)
+        buffer->top -= buffer->available;
+
+}
+
+void guac_terminal_buffer_shift_down(guac_terminal_buffer* buffer,
+        int amount) {
+
+    /* Move top of visible area back, wrapping around start of buffer */
+    buffer->top -= amount;
+    if (buffer->top < 0)
+        buffer->top += buffer->available;
+
+}
@@ -48,6 +48,26 @@ typedef struct guac_terminal_buffer_row {
      */
     int available;
 
+    /**
+     * The contents of this row as packed UTF-8, as of the time this row was
+     * last scrolled out of the visible area of the terminal. This text is
+     * maintained by guac_terminal_buffer_cache_row() and is only meaningful
+     * for rows within the scrollback (rows having negative indices), which
+     * are never modified. It is NOT null-terminated.
+     */
+    char* text;
+
+    /**
+     * The number of bytes of UTF-8 stored within text.
+     */
+    int text_length;
+
+    /**
+     * The number of bytes allocated for text. After text_length would exceed
+     * this value, the text must be resized.
+     */
+    int text_available;
+
 } guac_terminal_buffer_row;
 
 /**
@@ -125,5 +145,77 @@ void guac_terminal_buffer_copy_rows(guac_terminal_buffer* buffer,
 void guac_terminal_buffer_set_columns(guac_terminal_buffer* buffer, int row,
         int start_column, int end_column, guac_terminal_char* character);
 
+/**
+ * Encodes the given range of characters from the given row as UTF-8, storing
+ * the result within the provided buffer. Blank cells and the continuation
+ * cells of multi-column characters are skipped. The provided buffer must
+ * have space for at least four bytes per character in the range. The result
+ * is not null-terminated.
+ *
+ * @param row
+ *     The row containing the characters to encode.
+ *
+ * @param start
+ *     The first column of the range to encode, inclusive.
+ *
+ * @param end
+ *     The last column of the range to encode, inclusive.
+ *
+ * @param string
+ *     The buffer which should receive the UTF-8.
+ *
+ * @return
+ *     The number of bytes written to the provided buffer.
+ */
+int guac_terminal_buffer_row_string(guac_terminal_buffer_row* row,
+        int start, int end, char* string);
+
+/**
+ * Updates the packed UTF-8 cache of the given row (the text member of
+ * guac_terminal_buffer_row) to match the current contents of that row. This
+ * function must be invoked for each row immediately before that row leaves
+ * the visible area of the terminal and enters the scrollback, such that
+ * scrollback can later be extracted without re-encoding each character.
+ *
+ * @param buffer
+ *     The buffer containing the row.
+ *
+ * @param row
+ *     The index of the row to cache, relative to the top of the visible area
+ *     of the terminal.
+ */
+void guac_terminal_buffer_cache_row(guac_terminal_buffer* buffer, int row);
+
+/**
+ * Moves the visible area of the given buffer down by the given number of
+ * rows, such that the given number of rows at the top of the visible area
+ * enter the scrollback. The text of each such row is cached with
+ * guac_terminal_buffer_cache_row(). The length of the buffer is not
+ * modified.
+ *
+ * @param buffer
+ *     The buffer whose visible area should be moved.
+ *
+ * @param amount
+ *     The number of rows which should enter the scrollback.
+ */
+void guac_terminal_buffer_shift_up(guac_terminal_buffer* buffer, int amount);
+
+/**
+ * Moves the visible area of the given buffer up by the given number of rows,
+ * such that the given number of the most recent rows of scrollback become
+ * visible again. Those rows may then be modified, and are cached again if
+ * they later return to the scrollback. The length of the buffer is not
+ * modified.
+ *
+ * @param buffer
+ *     The buffer whose visible area should be moved.
+ *
+ * @param amount
+ *     The number of rows which should leave the scrollback.
+ */
+void guac_terminal_buffer_shift_down(guac_terminal_buffer* buffer,
+        int amount);
+
 #endif
 
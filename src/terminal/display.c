@@ -31,11 +31,17 @@
 
 #include <cairo/cairo.h>
 #include <glib-object.h>
+#include <guacamole/arena.h>
 #include <guacamole/client.h>
 #include <guacamole/protocol.h>
 #include <guacamole/socket.h>
 #include <pango/pangocairo.h>
 
+/* Define cairo_format_stride_for_width() if missing */
+#ifndef HAVE_CAIRO_FORMAT_STRIDE_FOR_WIDTH
+#define cairo_format_stride_for_width(format, width) (width*4)
+#endif
+
 const guac_terminal_color guac_terminal_palette[16] = {
 
     /* Normal colors */
@@ -173,6 +179,9 @@ int __guac_terminal_set(guac_terminal_display* display, int row, int col, int co
     cairo_surface_t* surface;
     cairo_t* cairo;
     int surface_width, surface_height;
+    int surface_stride;
+    unsigned char* surface_data;
+    guac_arena_mark mark;
    
     PangoLayout* layout;
     int layout_width, layout_height;
@@ -196,9 +205,17 @@ int __guac_terminal_set(guac_terminal_display* display, int row, int col, int co
     ideal_layout_width = surface_width * PANGO_SCALE;
     ideal_layout_height = surface_height * PANGO_SCALE;
 
-    /* Prepare surface */
-    surface = cairo_image_surface_create(CAIRO_FORMAT_RGB24,
-                                         surface_width, surface_height);
+    /* Prepare surface within temporary storage */
+    mark = guac_arena_get_mark();
+    surface_stride = cairo_format_stride_for_width(CAIRO_FORMAT_RGB24,
+            surface_width);
+    surface_data = guac_arena_alloc(surface_stride * surface_height);
+    if (surface_data == NULL)
+        return 1;
+
+    surface = cairo_image_surface_create_for_data(surface_data,
+            CAIRO_FORMAT_RGB24, surface_width, surface_height,
+            surface_stride);
     cairo = cairo_create(surface);
 
     /* Fill background */
@@ -252,6 +269,7 @@ int __guac_terminal_set(guac_terminal_display* display, int row, int col, int co
     g_object_unref(layout);
     cairo_destroy(cairo);
     cairo_surface_destroy(surface);
+    guac_arena_release(mark);
 
     return 0;
 
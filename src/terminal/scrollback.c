@@ -0,0 +1,290 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "config.h"
+
+#include "buffer.h"
+#include "scrollback.h"
+#include "terminal.h"
+
+#include <guacamole/client.h>
+#include <guacamole/protocol.h>
+#include <guacamole/socket.h>
+#include <guacamole/stream.h>
+#include <guacamole/user.h>
+
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * The state of an in-progress snapshot download.
+ */
+typedef struct guac_terminal_snapshot_transfer {
+
+    /**
+     * The snapshot being downloaded.
+     */
+    guac_terminal_snapshot* snapshot;
+
+    /**
+     * The byte offset within the snapshot text of the next blob to send.
+     */
+    int offset;
+
+} guac_terminal_snapshot_transfer;
+
+/**
+ * The data required to export a snapshot to the owner of a connection via
+ * guac_client_for_owner().
+ */
+typedef struct guac_terminal_snapshot_export {
+
+    /**
+     * The snapshot to export.
+     */
+    guac_terminal_snapshot* snapshot;
+
+    /**
+     * The name of the file to send to the owner.
+     */
+    const char* filename;
+
+} guac_terminal_snapshot_export;
+
+guac_terminal_snapshot* guac_terminal_snapshot_alloc(guac_terminal* terminal) {
+
+    guac_terminal_buffer* buffer = terminal->buffer;
+
+    /* Determine range of rows containing data, including scrollback */
+    int first_row = terminal->term_height - buffer->length;
+    if (first_row > 0)
+        first_row = 0;
+
+    int last_row = buffer->length;
+    if (last_row > terminal->term_height)
+        last_row = terminal->term_height;
+    last_row--;
+
+    int row;
+    int line_count = last_row - first_row + 1;
+    if (line_count < 0)
+        line_count = 0;
+
+    /* Calculate space required, allowing one separator (or null terminator)
+     * per line and four bytes per visible character */
+    int size = line_count + 1;
+    for (row = first_row; row <= last_row; row++) {
+
+        guac_terminal_buffer_row* buffer_row =
+            guac_terminal_buffer_get_row(buffer, row, 0);
+
+        if (row < 0)
+            size += buffer_row->text_length;
+        else
+            size += buffer_row->length * 4;
+
+    }
+
+    guac_terminal_snapshot* snapshot = malloc(sizeof(guac_terminal_snapshot));
+    if (snapshot == NULL)
+        return NULL;
+
+    snapshot->text = malloc(size);
+    if (snapshot->text == NULL) {
+        free(snapshot);
+        return NULL;
+    }
+
+    snapshot->line_count = line_count;
+
+    char* current = snapshot->text;
+
+    for (row = first_row; row <= last_row; row++) {
+
+        guac_terminal_buffer_row* buffer_row =
+            guac_terminal_buffer_get_row(buffer, row, 0);
+
+        /* Separate from previous line */
+        if (row != first_row)
+            *(current++) = '\n';
+
+        /* Copy cached text of rows within scrollback */
+        if (row < 0) {
+            memcpy(current, buffer_row->text, buffer_row->text_length);
+            current += buffer_row->text_length;
+        }
+
+        /* Encode visible rows, which may still change */
+        else
+            current += guac_terminal_buffer_row_string(buffer_row,
+                    0, buffer_row->length - 1, current);
+
+    }
+
+    /* Null terminator */
+    *current = '\0';
+    snapshot->length = current - snapshot->text;
+
+    return snapshot;
+
+}
+
+void guac_terminal_snapshot_free(guac_terminal_snapshot* snapshot) {
+    free(snapshot->text);
+    free(snapshot);
+}
+
+/**
+ * Handler for ack messages which continue a snapshot download, sending the
+ * next blob of snapshot text or ending the stream once all text has been
+ * sent. The data associated with the given stream is expected to be a
+ * pointer to a guac_terminal_snapshot_transfer.
+ *
+ * @param user
+ *     The user receiving the ack message.
+ *
+ * @param stream
+ *     The Guacamole protocol stream associated with the received ack message.
+ *
+ * @param message
+ *     An arbitrary human-readable message describing the nature of the
+ *     success or failure denoted by the ack message.
+ *
+ * @param status
+ *     The status code associated with the ack message, which may indicate
+ *     success or an error.
+ *
+ * @return
+ *     Always zero.
+ */
+static int guac_terminal_snapshot_ack_handler(guac_user* user,
+        guac_stream* stream, char* message, guac_protocol_status status) {
+
+    guac_terminal_snapshot_transfer* transfer =
+        (guac_terminal_snapshot_transfer*) stream->data;
+
+    guac_terminal_snapshot* snapshot = transfer->snapshot;
+
+    /* If successful and data remains, send next blob */
+    if (status == GUAC_PROTOCOL_STATUS_SUCCESS
+            && transfer->offset < snapshot->length) {
+
+        int length = snapshot->length - transfer->offset;
+        if (length > GUAC_TERMINAL_SNAPSHOT_BLOB_SIZE)
+            length = GUAC_TERMINAL_SNAPSHOT_BLOB_SIZE;
+
+        guac_protocol_send_blob(user->socket, stream,
+                snapshot->text + transfer->offset, length);
+
+        transfer->offset += length;
+        guac_socket_flush(user->socket);
+        return 0;
+
+    }
+
+    /* End stream if all data has been sent */
+    if (status == GUAC_PROTOCOL_STATUS_SUCCESS) {
+        guac_user_log(user, GUAC_LOG_DEBUG, "Terminal text sent");
+        guac_protocol_send_end(user->socket, stream);
+        guac_socket_flush(user->socket);
+    }
+
+    /* Transfer is complete or has been aborted */
+    guac_terminal_snapshot_free(snapshot);
+    free(transfer);
+    guac_user_free_stream(user, stream);
+
+    return 0;
+
+}
+
+guac_stream* guac_terminal_snapshot_download(guac_terminal_snapshot* snapshot,
+        guac_user* user, const char* filename) {
+
+    guac_terminal_snapshot_transfer* transfer =
+        malloc(sizeof(guac_terminal_snapshot_transfer));
+    transfer->snapshot = snapshot;
+    transfer->offset = 0;
+
+    /* Allocate stream */
+    guac_stream* stream = guac_user_alloc_stream(user);
+    stream->ack_handler = guac_terminal_snapshot_ack_handler;
+    stream->data = transfer;
+
+    /* Send stream start */
+    guac_protocol_send_file(user->socket, stream,
+            "text/plain", filename);
+    guac_socket_flush(user->socket);
+
+    guac_user_log(user, GUAC_LOG_DEBUG, "Sending terminal text as \"%s\" "
+            "(%i lines)", filename, snapshot->line_count);
+    return stream;
+
+}
+
+/**
+ * Callback invoked on the current connection owner (if any) when terminal
+ * text is being exported.
+ *
+ * @param owner
+ *     The guac_user that is the owner of the connection, or NULL if the
+ *     connection owner has left.
+ *
+ * @param data
+ *     A pointer to the guac_terminal_snapshot_export describing the export.
+ *
+ * @return
+ *     The stream allocated for the download, or NULL if the owner has left.
+ */
+static void* guac_terminal_export_to_owner(guac_user* owner, void* data) {
+
+    guac_terminal_snapshot_export* export =
+        (guac_terminal_snapshot_export*) data;
+
+    /* Do not bother exporting if the owner has left */
+    if (owner == NULL) {
+        guac_terminal_snapshot_free(export->snapshot);
+        return NULL;
+    }
+
+    return guac_terminal_snapshot_download(export->snapshot, owner,
+            export->filename);
+
+}
+
+void guac_terminal_export_scrollback(guac_terminal* terminal,
+        const char* filename) {
+
+    /* Only the snapshot itself requires the terminal lock */
+    guac_terminal_snapshot_export export = {
+        .snapshot = guac_terminal_snapshot_alloc(terminal),
+        .filename = filename
+    };
+
+    if (export.snapshot == NULL) {
+        guac_client_log(terminal->client, GUAC_LOG_WARNING, "Unable to "
+                "allocate memory for terminal text. Export aborted.");
+        return;
+    }
+
+    guac_client_for_owner(terminal->client, guac_terminal_export_to_owner,
+            &export);
+
+}
+
@@ -0,0 +1,125 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef GUAC_TERMINAL_SCROLLBACK_H
+#define GUAC_TERMINAL_SCROLLBACK_H
+
+#include "config.h"
+#include "terminal.h"
+
+#include <guacamole/stream.h>
+#include <guacamole/user.h>
+
+/**
+ * The maximum number of bytes of snapshot text to send within a single blob
+ * when a snapshot is downloaded.
+ */
+#define GUAC_TERMINAL_SNAPSHOT_BLOB_SIZE 6048
+
+/**
+ * A point-in-time copy of the text within a terminal, including all
+ * scrollback, stored as packed UTF-8. As a snapshot does not reference the
+ * terminal from which it was created, it may be exported without holding the
+ * terminal lock.
+ */
+typedef struct guac_terminal_snapshot {
+
+    /**
+     * The text of every line of the terminal, oldest line first, encoded as
+     * UTF-8. Each line is followed by a newline character except for the
+     * last, and the text as a whole is null-terminated.
+     */
+    char* text;
+
+    /**
+     * The length of text in bytes, not including the null terminator.
+     */
+    int length;
+
+    /**
+     * The number of lines within the snapshot.
+     */
+    int line_count;
+
+} guac_terminal_snapshot;
+
+/**
+ * Creates a new snapshot of the text within the given terminal, including
+ * all scrollback. Rows within scrollback are copied from the packed UTF-8
+ * cached as each row scrolled out of view, such that only the rows currently
+ * visible need be encoded. The terminal must be locked by the current thread.
+ *
+ * @param terminal
+ *     The terminal to snapshot.
+ *
+ * @return
+ *     A newly-allocated snapshot of the text within the given terminal, which
+ *     must eventually be freed with guac_terminal_snapshot_free(), or NULL if
+ *     the snapshot could not be allocated.
+ */
+guac_terminal_snapshot* guac_terminal_snapshot_alloc(guac_terminal* terminal);
+
+/**
+ * Frees the given snapshot and all associated text.
+ *
+ * @param snapshot
+ *     The snapshot to free.
+ */
+void guac_terminal_snapshot_free(guac_terminal_snapshot* snapshot);
+
+/**
+ * Begins streaming the text of the given snapshot to the given user as a
+ * file download having the given name. Blobs of text are sent as the user
+ * acknowledges the previous blob, independently of the terminal. Ownership of
+ * the snapshot is transferred to the stream, which will free the snapshot
+ * once the download ends.
+ *
+ * @param snapshot
+ *     The snapshot to download.
+ *
+ * @param user
+ *     The user that should receive the download.
+ *
+ * @param filename
+ *     The name of the file to send to the user.
+ *
+ * @return
+ *     The stream allocated for the download.
+ */
+guac_stream* guac_terminal_snapshot_download(guac_terminal_snapshot* snapshot,
+        guac_user* user, const char* filename);
+
+/**
+ * Snapshots the text within the given terminal, including all scrollback,
+ * and begins streaming that text to the owner of the connection as a file
+ * download having the given name. The terminal must be locked by the current
+ * thread, but is not used after this function returns. If the owner has left
+ * the connection, this function has no effect.
+ *
+ * @param terminal
+ *     The terminal whose text should be exported.
+ *
+ * @param filename
+ *     The name of the file to send to the connection owner.
+ */
+void guac_terminal_export_scrollback(guac_terminal* terminal,
+        const char* filename);
+
+#endif
+
@@ -244,6 +244,9 @@ void* guac_terminal_thread(void* data) {
         if (guac_terminal_render_frame(terminal))
             break;
 
+        /* Send any pending cursor motion along with the frame */
+        guac_common_cursor_flush(terminal->cursor);
+
         /* Signal end of frame */
         guac_client_end_frame(client);
         guac_socket_flush(client->socket);
@@ -317,6 +320,8 @@ guac_terminal* guac_terminal_create(guac_client* client,
     term->client = client;
     term->upload_path_handler = NULL;
     term->file_download_handler = NULL;
+    term->resize_handler = NULL;
+    term->resize_pending = false;
 
     /* Init buffer */
     term->buffer = guac_terminal_buffer_alloc(1000, &default_char);
@@ -448,6 +453,27 @@ void guac_terminal_free(guac_terminal* term) {
 
 }
 
+/**
+ * Resizes the given terminal to the given pixel dimensions, resizing the
+ * terminal itself only if the corresponding number of rows or columns has
+ * changed. The terminal must already be locked by the current thread.
+ *
+ * @param terminal
+ *     The terminal to resize.
+ *
+ * @param width
+ *     The new width of the display, in pixels.
+ *
+ * @param height
+ *     The new height of the display, in pixels.
+ *
+ * @return
+ *     Non-zero if the number of rows or columns within the terminal has
+ *     changed, zero otherwise.
+ */
+static int __guac_terminal_resize_display(guac_terminal* terminal,
+        int width, int height);
+
 /**
  * Waits for data to become available on the given file descriptor.
  *
@@ -537,10 +563,25 @@ int guac_terminal_render_frame(guac_terminal* terminal) {
 
         } while (wait_result > 0);
 
+        /* Apply final requested size, if any, at end of frame */
+        int resized = 0;
+        if (terminal->resize_pending) {
+            terminal->resize_pending = false;
+            resized = __guac_terminal_resize_display(terminal,
+                    terminal->requested_width, terminal->requested_height);
+        }
+
+        int columns = terminal->term_width;
+        int rows = terminal->term_height;
+
         /* Flush terminal */
         guac_terminal_flush(terminal);
         guac_terminal_unlock(terminal);
 
+        /* Inform remote side of new size only after releasing terminal */
+        if (resized && terminal->resize_handler != NULL)
+            terminal->resize_handler(client, columns, rows);
+
     }
 
     /* Notify of any errors */
@@ -744,9 +785,7 @@ int guac_terminal_scroll_up(guac_terminal* term,
         guac_terminal_display_copy_rows(term->display, start_row + amount, end_row, -amount);
 
         /* Advance by scroll amount */
-        term->buffer->top += amount;
-        if (term->buffer->top >= term->buffer->available)
-            term->buffer->top -= term->buffer->available;
+        guac_terminal_buffer_shift_up(term->buffer, amount);
 
         term->buffer->length += amount;
         if (term->buffer->length > term->buffer->available)
@@ -1058,27 +1097,6 @@ void guac_terminal_select_update(guac_terminal* terminal, int row, int column) {
 
 }
 
-int __guac_terminal_buffer_string(guac_terminal_buffer_row* row, int start, int end, char* string) {
-
-    int length = 0;
-    int i;
-    for (i=start; i<=end; i++) {
-
-        int codepoint = row->characters[i].value;
-
-        /* If not null (blank), add to string */
-        if (codepoint != 0 && codepoint != GUAC_CHAR_CONTINUATION) {
-            int bytes = guac_terminal_encode_utf8(codepoint, string);
-            string += bytes;
-            length += bytes;
-        }
-
-    }
-
-    return length;
-
-}
-
 void guac_terminal_select_end(guac_terminal* terminal, char* string) {
 
     /* Deselect */
@@ -1115,14 +1133,14 @@ void guac_terminal_select_end(guac_terminal* terminal, char* string) {
     if (end_row == start_row) {
         if (buffer_row->length - 1 < end_col)
             end_col = buffer_row->length - 1;
-        string += __guac_terminal_buffer_string(buffer_row, start_col, end_col, string);
+        string += guac_terminal_buffer_row_string(buffer_row, start_col, end_col, string);
     }
 
     /* Otherwise, copy multiple rows */
     else {
 
         /* Store first row */
-        string += __guac_terminal_buffer_string(buffer_row, start_col, buffer_row->length - 1, string);
+        string += guac_terminal_buffer_row_string(buffer_row, start_col, buffer_row->length - 1, string);
 
         /* Store all middle rows */
         for (row=start_row+1; row<end_row; row++) {
@@ -1130,7 +1148,7 @@ void guac_terminal_select_end(guac_terminal* terminal, char* string) {
             buffer_row = guac_terminal_buffer_get_row(terminal->buffer, row, 0);
 
             *(string++) = '\n';
-            string += __guac_terminal_buffer_string(buffer_row, 0, buffer_row->length - 1, string);
+            string += guac_terminal_buffer_row_string(buffer_row, 0, buffer_row->length - 1, string);
 
         }
 
@@ -1140,7 +1158,7 @@ void guac_terminal_select_end(guac_terminal* terminal, char* string) {
             end_col = buffer_row->length - 1;
 
         *(string++) = '\n';
-        string += __guac_terminal_buffer_string(buffer_row, 0, end_col, string);
+        string += guac_terminal_buffer_row_string(buffer_row, 0, end_col, string);
 
     }
 
@@ -1264,7 +1282,7 @@ static void __guac_terminal_resize(guac_terminal* term, int width, int height) {
                     shift_amount, term->display->height - 1, -shift_amount);
 
             /* Update buffer top and cursor row based on shift */
-            term->buffer->top += shift_amount;
+            guac_terminal_buffer_shift_up(term->buffer, shift_amount);
             term->cursor_row  -= shift_amount;
             term->visible_cursor_row  -= shift_amount;
 
@@ -1299,7 +1317,7 @@ static void __guac_terminal_resize(guac_terminal* term, int width, int height) {
                 shift_amount = max_shift;
 
             /* Update buffer top and cursor row based on shift */
-            term->buffer->top -= shift_amount;
+            guac_terminal_buffer_shift_down(term->buffer, shift_amount);
             term->cursor_row  += shift_amount;
             term->visible_cursor_row  += shift_amount;
 
@@ -1354,14 +1372,12 @@ static void __guac_terminal_resize(guac_terminal* term, int width, int height) {
 
 }
 
-int guac_terminal_resize(guac_terminal* terminal, int width, int height) {
+static int __guac_terminal_resize_display(guac_terminal* terminal,
+        int width, int height) {
 
     guac_terminal_display* display = terminal->display;
     guac_client* client = display->client;
 
-    /* Acquire exclusive access to terminal */
-    guac_terminal_lock(terminal);
-
     /* Calculate available display area */
     int available_width = width - GUAC_TERMINAL_SCROLLBAR_WIDTH;
     if (available_width < 0)
@@ -1394,8 +1410,23 @@ int guac_terminal_resize(guac_terminal* terminal, int width, int height) {
         /* Reset scroll region */
         terminal->scroll_end = rows - 1;
 
+        return 1;
+
     }
 
+    return 0;
+
+}
+
+int guac_terminal_resize(guac_terminal* terminal, int width, int height) {
+
+    /* Acquire exclusive access to terminal */
+    guac_terminal_lock(terminal);
+
+    /* Resize immediately, superseding any pending request */
+    terminal->resize_pending = false;
+    __guac_terminal_resize_display(terminal, width, height);
+
     /* Release terminal */
     guac_terminal_unlock(terminal);
 
@@ -1404,6 +1435,21 @@ int guac_terminal_resize(guac_terminal* terminal, int width, int height) {
 
 }
 
+void guac_terminal_request_resize(guac_terminal* terminal,
+        int width, int height) {
+
+    /* Record requested size, replacing any previous unapplied request */
+    guac_terminal_lock(terminal);
+    terminal->requested_width = width;
+    terminal->requested_height = height;
+    terminal->resize_pending = true;
+    guac_terminal_unlock(terminal);
+
+    /* Wake render thread such that the resize is applied promptly */
+    guac_terminal_notify(terminal);
+
+}
+
 void guac_terminal_flush(guac_terminal* terminal) {
 
     /* Flush typescript if in use */
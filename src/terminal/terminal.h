@@ -124,6 +124,13 @@ typedef void guac_terminal_upload_path_handler(guac_client* client, char* path);
  */
 typedef guac_stream* guac_terminal_file_download_handler(guac_client* client, char* filename);
 
+/**
+ * Handler invoked after the terminal has been resized, such that the remote
+ * side of the connection can be informed of the new dimensions. This handler
+ * is invoked from the terminal render thread, without the terminal lock held.
+ */
+typedef void guac_terminal_resize_handler(guac_client* client, int columns, int rows);
+
 /**
  * Represents a terminal emulator which uses a given Guacamole client to
  * render itself.
@@ -152,6 +159,13 @@ struct guac_terminal {
      */
     guac_terminal_file_download_handler* file_download_handler;
 
+    /**
+     * Called whenever the terminal has been resized in response to a call to
+     * guac_terminal_request_resize(), receiving the new dimensions of the
+     * terminal in characters. If NULL, no handler is invoked.
+     */
+    guac_terminal_resize_handler* resize_handler;
+
     /**
      * Lock which restricts simultaneous access to this terminal via the root
      * guac_terminal_* functions.
@@ -414,6 +428,26 @@ struct guac_terminal {
      */
     guac_common_clipboard* clipboard;
 
+    /**
+     * Whether a resize has been requested via guac_terminal_request_resize()
+     * but not yet applied. Pending resizes are applied at the end of the next
+     * frame, such that only the final size of a rapid series of resizes is
+     * actually rendered.
+     */
+    bool resize_pending;
+
+    /**
+     * The width of the display, in pixels, most recently requested via
+     * guac_terminal_request_resize().
+     */
+    int requested_width;
+
+    /**
+     * The height of the display, in pixels, most recently requested via
+     * guac_terminal_request_resize().
+     */
+    int requested_height;
+
 };
 
 /**
@@ -701,6 +735,24 @@ void guac_terminal_set_columns(guac_terminal* terminal, int row,
  */
 int guac_terminal_resize(guac_terminal* term, int width, int height);
 
+/**
+ * Requests that the terminal be resized to the given dimensions, in pixels.
+ * Rather than resizing immediately, the requested size is recorded and
+ * applied at the next frame boundary by the terminal render thread, replacing
+ * any previously-requested size which has not yet been applied. Once the
+ * resize has been applied, the terminal's resize_handler, if any, is invoked.
+ *
+ * @param term
+ *     The terminal to resize.
+ *
+ * @param width
+ *     The requested width of the display, in pixels.
+ *
+ * @param height
+ *     The requested height of the display, in pixels.
+ */
+void guac_terminal_request_resize(guac_terminal* term, int width, int height);
+
 /**
  * Flushes all pending operations within the given guac_terminal.
  */
@@ -20,6 +20,7 @@
 #include "config.h"
 
 #include "char_mappings.h"
+#include "scrollback.h"
 #include "terminal.h"
 #include "terminal_handlers.h"
 #include "types.h"
@@ -987,6 +988,27 @@ int guac_terminal_close_pipe_stream(guac_terminal* term, unsigned char c) {
 
 }
 
+int guac_terminal_export(guac_terminal* term, unsigned char c) {
+
+    static char filename[2048];
+    static int length = 0;
+
+    /* Export on ECMA-48 ST (String Terminator) */
+    if (c == 0x9C || c == 0x5C || c == 0x07) {
+        filename[length++] = '\0';
+        term->char_handler = guac_terminal_echo;
+        guac_terminal_export_scrollback(term, filename);
+        length = 0;
+    }
+
+    /* Otherwise, store character */
+    else if (length < sizeof(filename)-1)
+        filename[length++] = c;
+
+    return 0;
+
+}
+
 int guac_terminal_osc(guac_terminal* term, unsigned char c) {
 
     static int operation = 0;
@@ -1014,6 +1036,10 @@ int guac_terminal_osc(guac_terminal* term, unsigned char c) {
         else if (operation == 482203)
             term->char_handler = guac_terminal_close_pipe_stream;
 
+        /* Export terminal text and scrollback OSC */
+        else if (operation == 482204)
+            term->char_handler = guac_terminal_export;
+
         /* Reset parameter for next OSC */
         operation = 0;
 
@@ -138,6 +138,20 @@ int guac_terminal_open_pipe_stream(guac_terminal* term, unsigned char c);
  */
 int guac_terminal_close_pipe_stream(guac_terminal* term, unsigned char c);
 
+/**
+ * Parses the remainder of the export OSC specific to the Guacamole terminal
+ * emulator. Once the OSC sequence is complete, the text of the terminal,
+ * including all scrollback, will be sent to the owner of the connection as a
+ * file download having the specified name.
+ *
+ * @param term
+ *     The terminal that received the given character of data.
+ *
+ * @param c
+ *     The character that was received by the given terminal.
+ */
+int guac_terminal_export(guac_terminal* term, unsigned char c);
+
 /**
  * Handles the remaining characters of an Operating System Code (OSC) sequence,
  * typically initiated with "ESC ]".
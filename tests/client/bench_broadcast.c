@@ -0,0 +1,180 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*
+ * Microbenchmark measuring the throughput of instructions written to the
+ * broadcast socket of a guac_client, and the cost of iterating its users,
+ * for varying numbers of connected users. This benchmark is not run as part
+ * of "make check", and must be built explicitly with "make bench_broadcast".
+ */
+
+#include "config.h"
+
+#include <guacamole/client.h>
+#include <guacamole/protocol.h>
+#include <guacamole/socket.h>
+#include <guacamole/user.h>
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <time.h>
+#include <unistd.h>
+
+/**
+ * The number of instructions to write to the broadcast socket for each
+ * measurement.
+ */
+#define BENCH_INSTRUCTIONS 1000000
+
+/**
+ * The number of instructions to write between each flush of the broadcast
+ * socket, approximating the number of instructions within a typical frame.
+ */
+#define BENCH_FLUSH_INTERVAL 64
+
+/**
+ * The number of times guac_client_foreach_user() should be invoked for each
+ * measurement.
+ */
+#define BENCH_ITERATIONS 5000000
+
+/**
+ * Returns the current value of the monotonic clock, in seconds.
+ *
+ * @return
+ *     The current value of the monotonic clock, in seconds.
+ */
+static double bench_now() {
+
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return now.tv_sec + now.tv_nsec / 1000000000.0;
+
+}
+
+/**
+ * Callback for guac_client_foreach_user() which does nothing more than count
+ * the users iterated.
+ *
+ * @param user
+ *     The user being iterated.
+ *
+ * @param data
+ *     Pointer to the long counter to increment.
+ *
+ * @return
+ *     Always NULL.
+ */
+static void* bench_count_user(guac_user* user, void* data) {
+
+    long* count = (long*) data;
+    (*count)++;
+
+    return NULL;
+
+}
+
+/**
+ * Measures broadcast instruction throughput and user iteration cost for a
+ * client having the given number of users, each of which writes to
+ * /dev/null, printing the results to STDOUT.
+ *
+ * @param user_count
+ *     The number of users to add to the client being measured.
+ *
+ * @return
+ *     Zero if the measurement was performed, non-zero if the client or its
+ *     users could not be created.
+ */
+static int bench_broadcast(int user_count) {
+
+    int i;
+    long count = 0;
+    double start;
+
+    guac_client* client = guac_client_alloc();
+    if (client == NULL)
+        return 1;
+
+    /* Join all users, each of which discards all received data */
+    guac_user* users[user_count];
+    for (i = 0; i < user_count; i++) {
+
+        int fd = open("/dev/null", O_WRONLY);
+        if (fd < 0)
+            return 1;
+
+        users[i] = guac_user_alloc();
+        users[i]->client = client;
+        users[i]->owner = (i == 0);
+        users[i]->socket = guac_socket_open(fd);
+
+        guac_client_add_user(client, users[i], 0, NULL);
+
+    }
+
+    /* Measure throughput of instructions written to all users */
+    start = bench_now();
+    for (i = 0; i < BENCH_INSTRUCTIONS; i++) {
+
+        guac_protocol_send_rect(client->socket, GUAC_DEFAULT_LAYER,
+                i % 1024, 0, 64, 64);
+
+        if (i % BENCH_FLUSH_INTERVAL == BENCH_FLUSH_INTERVAL - 1)
+            guac_socket_flush(client->socket);
+
+    }
+
+    guac_socket_flush(client->socket);
+
+    printf("%2i user(s): %8.0f instructions/second, ", user_count,
+            BENCH_INSTRUCTIONS / (bench_now() - start));
+
+    /* Measure cost of iterating all users */
+    start = bench_now();
+    for (i = 0; i < BENCH_ITERATIONS; i++)
+        guac_client_foreach_user(client, bench_count_user, &count);
+
+    printf("%5.1f ns per guac_client_foreach_user()\n",
+            (bench_now() - start) * 1000000000.0 / BENCH_ITERATIONS);
+
+    /* Clean up */
+    for (i = 0; i < user_count; i++) {
+        guac_client_remove_user(client, users[i]);
+        guac_socket_free(users[i]->socket);
+        guac_user_free(users[i]);
+    }
+
+    guac_client_free(client);
+    return 0;
+
+}
+
+int main() {
+
+    if (bench_broadcast(1)
+            || bench_broadcast(5)
+            || bench_broadcast(20))
+        return 1;
+
+    return 0;
+
+}
+
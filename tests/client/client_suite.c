@@ -45,6 +45,8 @@ int register_client_suite() {
     if (
         CU_add_test(suite, "layer-pool", test_layer_pool) == NULL
      || CU_add_test(suite, "buffer-pool", test_buffer_pool) == NULL
+     || CU_add_test(suite, "user-list", test_user_list) == NULL
+     || CU_add_test(suite, "user-join", test_user_join) == NULL
        ) {
         CU_cleanup_registry();
         return CU_get_error();
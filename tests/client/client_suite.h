@@ -27,6 +27,8 @@ int register_client_suite();
 
 void test_layer_pool();
 void test_buffer_pool();
+void test_user_list();
+void test_user_join();
 
 #endif
 
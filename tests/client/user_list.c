@@ -0,0 +1,326 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "config.h"
+
+#include "client_suite.h"
+
+#include <CUnit/Basic.h>
+#include <guacamole/client.h>
+#include <guacamole/protocol.h>
+#include <guacamole/socket.h>
+#include <guacamole/timestamp.h>
+#include <guacamole/user.h>
+
+#include <pthread.h>
+#include <string.h>
+
+/**
+ * The number of users to add to the test client.
+ */
+#define TEST_USER_COUNT 20
+
+/**
+ * Callback for guac_client_foreach_user() which counts the number of users
+ * iterated.
+ *
+ * @param user
+ *     The user being iterated.
+ *
+ * @param data
+ *     Pointer to the int counter to increment.
+ *
+ * @return
+ *     Always NULL.
+ */
+static void* count_user(guac_user* user, void* data) {
+
+    int* count = (int*) data;
+    (*count)++;
+
+    return NULL;
+
+}
+
+/**
+ * Callback for guac_client_for_owner() and guac_client_for_user() which
+ * simply returns the user given.
+ *
+ * @param user
+ *     The user given, which may be NULL.
+ *
+ * @param data
+ *     Unused.
+ *
+ * @return
+ *     The user given.
+ */
+static void* return_user(guac_user* user, void* data) {
+    return user;
+}
+
+/**
+ * Returns the number of users currently iterated by
+ * guac_client_foreach_user() for the given client.
+ *
+ * @param client
+ *     The client whose users should be counted.
+ *
+ * @return
+ *     The number of users iterated.
+ */
+static int count_users(guac_client* client) {
+
+    int count = 0;
+    guac_client_foreach_user(client, count_user, &count);
+
+    return count;
+
+}
+
+void test_user_list() {
+
+    int i;
+    guac_user* users[TEST_USER_COUNT];
+
+    /* Get client */
+    guac_client* client = guac_client_alloc();
+    CU_ASSERT_PTR_NOT_NULL_FATAL(client);
+
+    /* No users initially */
+    CU_ASSERT_EQUAL(count_users(client), 0);
+    CU_ASSERT_PTR_NULL(guac_client_for_owner(client, return_user, NULL));
+
+    /* Join all users, the first being the owner */
+    for (i=0; i<TEST_USER_COUNT; i++) {
+
+        users[i] = guac_user_alloc();
+        CU_ASSERT_PTR_NOT_NULL_FATAL(users[i]);
+
+        users[i]->client = client;
+        users[i]->owner = (i == 0);
+
+        CU_ASSERT_EQUAL(guac_client_add_user(client, users[i], 0, NULL), 0);
+        CU_ASSERT_EQUAL(count_users(client), i+1);
+
+    }
+
+    CU_ASSERT_EQUAL(client->connected_users, TEST_USER_COUNT);
+    CU_ASSERT_PTR_EQUAL(guac_client_for_owner(client, return_user, NULL),
+            users[0]);
+
+    /* Remove every other user, including the owner */
+    for (i=0; i<TEST_USER_COUNT; i+=2) {
+        guac_client_remove_user(client, users[i]);
+        CU_ASSERT_PTR_NULL(guac_client_for_user(client, users[i],
+                    return_user, NULL));
+    }
+
+    CU_ASSERT_EQUAL(count_users(client), TEST_USER_COUNT / 2);
+    CU_ASSERT_PTR_NULL(guac_client_for_owner(client, return_user, NULL));
+
+    /* Remaining users should still be present */
+    for (i=1; i<TEST_USER_COUNT; i+=2)
+        CU_ASSERT_PTR_EQUAL(guac_client_for_user(client, users[i],
+                    return_user, NULL), users[i]);
+
+    /* Remove remaining users */
+    for (i=1; i<TEST_USER_COUNT; i+=2)
+        guac_client_remove_user(client, users[i]);
+
+    CU_ASSERT_EQUAL(count_users(client), 0);
+    CU_ASSERT_EQUAL(client->connected_users, 0);
+
+    for (i=0; i<TEST_USER_COUNT; i++)
+        guac_user_free(users[i]);
+
+    /* Free client */
+    guac_client_free(client);
+
+}
+
+
+/**
+ * All data written to the socket of the user joining within
+ * test_user_join().
+ */
+static char test_output[1024];
+
+/**
+ * The number of bytes currently stored within test_output.
+ */
+static int test_output_length = 0;
+
+/**
+ * Socket write handler which appends all data written to test_output.
+ *
+ * @param socket
+ *     The socket being written to.
+ *
+ * @param buf
+ *     The data to write.
+ *
+ * @param count
+ *     The number of bytes to write.
+ *
+ * @return
+ *     The number of bytes written, which is always count.
+ */
+static ssize_t test_write_handler(guac_socket* socket,
+        const void* buf, size_t count) {
+
+    CU_ASSERT_FATAL(test_output_length + count <= sizeof(test_output));
+
+    memcpy(test_output + test_output_length, buf, count);
+    test_output_length += count;
+
+    return count;
+
+}
+
+/**
+ * The thread started within test_join_handler().
+ */
+static pthread_t joined_thread;
+
+/**
+ * The number of users counted by the thread started within
+ * test_join_handler().
+ */
+static int joined_count = -1;
+
+/**
+ * Non-zero if the thread started within test_join_handler() has finished
+ * writing to the broadcast socket, zero otherwise.
+ */
+static int joined_sent = 0;
+
+/**
+ * Thread which counts the users of the given client, storing the result
+ * within joined_count, and then writes a "sync" instruction to the broadcast
+ * socket of that client.
+ *
+ * @param data
+ *     The guac_client whose users should be counted.
+ *
+ * @return
+ *     Always NULL.
+ */
+static void* count_users_thread(void* data) {
+
+    guac_client* client = (guac_client*) data;
+
+    __atomic_store_n(&joined_count, count_users(client), __ATOMIC_SEQ_CST);
+
+    guac_protocol_send_sync(client->socket, 1234);
+    guac_socket_flush(client->socket);
+
+    __atomic_store_n(&joined_sent, 1, __ATOMIC_SEQ_CST);
+    return NULL;
+
+}
+
+/**
+ * Join handler which starts a thread iterating all users of the client and
+ * writing to the broadcast socket, verifying that this thread need not wait
+ * for the join to complete. The join succeeds only if the user is the owner.
+ *
+ * @param user
+ *     The user joining.
+ *
+ * @param argc
+ *     The number of arguments given. Unused.
+ *
+ * @param argv
+ *     The arguments given. Unused.
+ *
+ * @return
+ *     Zero if the user is the owner, non-zero otherwise.
+ */
+static int test_join_handler(guac_user* user, int argc, char** argv) {
+
+    int i;
+
+    __atomic_store_n(&joined_count, -1, __ATOMIC_SEQ_CST);
+    __atomic_store_n(&joined_sent, 0, __ATOMIC_SEQ_CST);
+    pthread_create(&joined_thread, NULL, count_users_thread, user->client);
+
+    /* Output by other threads must not wait for the join to complete */
+    for (i = 0; i < 100; i++) {
+        if (__atomic_load_n(&joined_sent, __ATOMIC_SEQ_CST))
+            break;
+        guac_timestamp_msleep(10);
+    }
+
+    CU_ASSERT_FATAL(__atomic_load_n(&joined_sent, __ATOMIC_SEQ_CST));
+
+    /* Iteration must not yet include the joining user */
+    CU_ASSERT_EQUAL(joined_count, 0);
+
+    /* Output sent during the join must reach the joining user */
+    CU_ASSERT_EQUAL(test_output_length, 14);
+    CU_ASSERT_NSTRING_EQUAL(test_output, "4.sync,4.1234;", 14);
+
+    /* Iteration by the joining thread also excludes the joining user */
+    CU_ASSERT_EQUAL(count_users(user->client), 0);
+
+    return !user->owner;
+
+}
+
+void test_user_join() {
+
+    /* Get client */
+    guac_client* client = guac_client_alloc();
+    CU_ASSERT_PTR_NOT_NULL_FATAL(client);
+    client->join_handler = test_join_handler;
+
+    /* Failed join must not add the user */
+    guac_user* user = guac_user_alloc();
+    CU_ASSERT_PTR_NOT_NULL_FATAL(user);
+    user->client = client;
+    user->socket = guac_socket_alloc();
+    user->socket->write_handler = test_write_handler;
+
+    CU_ASSERT_NOT_EQUAL(guac_client_add_user(client, user, 0, NULL), 0);
+    pthread_join(joined_thread, NULL);
+    CU_ASSERT_EQUAL(count_users(client), 0);
+
+    /* Output after a failed join must not reach the user */
+    test_output_length = 0;
+    guac_protocol_send_sync(client->socket, 1234);
+    guac_socket_flush(client->socket);
+    CU_ASSERT_EQUAL(test_output_length, 0);
+
+    /* Successful join must add the user */
+    user->owner = 1;
+    CU_ASSERT_EQUAL(guac_client_add_user(client, user, 0, NULL), 0);
+    pthread_join(joined_thread, NULL);
+    CU_ASSERT_EQUAL(count_users(client), 1);
+    CU_ASSERT_PTR_EQUAL(guac_client_for_owner(client, return_user, NULL),
+            user);
+
+    guac_client_remove_user(client, user);
+    guac_socket_free(user->socket);
+    guac_user_free(user);
+
+    /* Free client */
+    guac_client_free(client);
+
+}
@@ -46,6 +46,9 @@ int register_common_suite() {
         CU_add_test(suite, "guac-iconv", test_guac_iconv)  == NULL
      || CU_add_test(suite, "guac-string", test_guac_string) == NULL
      || CU_add_test(suite, "guac-rect", test_guac_rect) == NULL
+     || CU_add_test(suite, "guac-json", test_guac_json) == NULL
+     || CU_add_test(suite, "guac-listing", test_guac_listing) == NULL
+     || CU_add_test(suite, "guac-listing-stream", test_guac_listing_stream) == NULL
        ) {
         CU_cleanup_registry();
         return CU_get_error();
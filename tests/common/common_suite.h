@@ -51,5 +51,20 @@ void test_guac_iconv();
  */
 void test_guac_rect();
 
+/**
+ * Unit test for JSON string escaping.
+ */
+void test_guac_json();
+
+/**
+ * Unit test for directory listing cache functions.
+ */
+void test_guac_listing();
+
+/**
+ * Unit test for the flow control of directory listing streams.
+ */
+void test_guac_listing_stream();
+
 #endif
 
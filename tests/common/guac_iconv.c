@@ -50,6 +50,78 @@ static void test_conversion(
 
 }
 
+/**
+ * Builds the UTF-8, UTF-16 and ISO-8859-1 representations of a long string
+ * consisting of runs of ASCII of varying length separated by "à", verifying
+ * that conversions of runs long enough to be handled in bulk are identical
+ * to conversions performed character by character.
+ */
+static void test_long_conversion() {
+
+    unsigned char utf8[2048];
+    unsigned char utf16[4096];
+    unsigned char iso8859_1[2048];
+
+    int utf8_length = 0;
+    int utf16_length = 0;
+    int iso8859_1_length = 0;
+
+    int run;
+    int i;
+
+    for (run = 0; run < 40; run++) {
+
+        /* Run of ASCII of increasing length */
+        for (i = 0; i < run; i++) {
+            char c = 'a' + (run + i) % 26;
+            utf8[utf8_length++] = c;
+            utf16[utf16_length++] = c;
+            utf16[utf16_length++] = 0x00;
+            iso8859_1[iso8859_1_length++] = c;
+        }
+
+        /* Followed by a single non-ASCII character ("à") */
+        utf8[utf8_length++] = 0xC3;
+        utf8[utf8_length++] = 0xA0;
+        utf16[utf16_length++] = 0xE0;
+        utf16[utf16_length++] = 0x00;
+        iso8859_1[iso8859_1_length++] = 0xE0;
+
+    }
+
+    /* Null terminator */
+    utf8[utf8_length++] = 0x00;
+    utf16[utf16_length++] = 0x00;
+    utf16[utf16_length++] = 0x00;
+    iso8859_1[iso8859_1_length++] = 0x00;
+
+    /* UTF8 to UTF16 */
+    test_conversion(
+            GUAC_READ_UTF8,   utf8,  utf8_length,
+            GUAC_WRITE_UTF16, utf16, utf16_length);
+
+    /* UTF16 to UTF8 */
+    test_conversion(
+            GUAC_READ_UTF16, utf16, utf16_length,
+            GUAC_WRITE_UTF8, utf8,  utf8_length);
+
+    /* UTF8 to ISO-8859-1 */
+    test_conversion(
+            GUAC_READ_UTF8,       utf8,      utf8_length,
+            GUAC_WRITE_ISO8859_1, iso8859_1, iso8859_1_length);
+
+    /* UTF16 to CP1252 */
+    test_conversion(
+            GUAC_READ_UTF16,   utf16,     utf16_length,
+            GUAC_WRITE_CP1252, iso8859_1, iso8859_1_length);
+
+    /* ISO-8859-1 to UTF16 */
+    test_conversion(
+            GUAC_READ_ISO8859_1, iso8859_1, iso8859_1_length,
+            GUAC_WRITE_UTF16,    utf16,     utf16_length);
+
+}
+
 void test_guac_iconv() {
 
     /* UTF8 for "papà è bello" */
@@ -124,5 +196,8 @@ void test_guac_iconv() {
             GUAC_READ_ISO8859_1, test_string_iso8859_1, sizeof(test_string_iso8859_1),
             GUAC_WRITE_UTF8,     test_string_utf8,      sizeof(test_string_utf8));
 
+    /* Long strings mixing ASCII runs with other characters */
+    test_long_conversion();
+
 }
 
@@ -0,0 +1,110 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "config.h"
+
+#include "common_suite.h"
+#include "guac_json.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <CUnit/Basic.h>
+
+/**
+ * Escapes the given null-terminated string with guac_common_json_escape(),
+ * returning the result as a null-terminated string within a static buffer.
+ *
+ * @param str
+ *     The string to escape.
+ *
+ * @return
+ *     The escaped string.
+ */
+static const char* escape(const char* str) {
+
+    static char buffer[1024];
+
+    int length = guac_common_json_escape(buffer, str, strlen(str));
+    buffer[length] = '\0';
+
+    return buffer;
+
+}
+
+void test_guac_json() {
+
+    char input[32];
+    char escaped[8];
+    char expected[64];
+    int c;
+
+    /* Strings requiring no escaping are copied verbatim */
+    CU_ASSERT_STRING_EQUAL("", escape(""));
+    CU_ASSERT_STRING_EQUAL("a", escape("a"));
+    CU_ASSERT_STRING_EQUAL("/path/to/some file.txt",
+            escape("/path/to/some file.txt"));
+    CU_ASSERT_STRING_EQUAL("\xE2\x82\xAC and \xC3\xA9",
+            escape("\xE2\x82\xAC and \xC3\xA9"));
+
+    /* Quotes and backslashes */
+    CU_ASSERT_STRING_EQUAL("\\\"", escape("\""));
+    CU_ASSERT_STRING_EQUAL("\\\\", escape("\\"));
+    CU_ASSERT_STRING_EQUAL("C:\\\\Users\\\\\\\"quoted\\\" name",
+            escape("C:\\Users\\\"quoted\" name"));
+
+    /* Control characters */
+    CU_ASSERT_STRING_EQUAL("\\b\\f\\n\\r\\t", escape("\b\f\n\r\t"));
+    CU_ASSERT_STRING_EQUAL("\\u0001\\u001f", escape("\x01\x1F"));
+    CU_ASSERT_STRING_EQUAL("\x7F", escape("\x7F"));
+
+    /* Every byte value, at every position relative to word boundaries */
+    for (c = 1; c < 256; c++) {
+
+        int position;
+        for (position = 0; position < 20; position++) {
+
+            memset(input, 'x', 20);
+            input[20] = '\0';
+            input[position] = c;
+
+            /* Build expected result */
+            if (c == '"' || c == '\\')
+                snprintf(escaped, sizeof(escaped), "\\%c", c);
+            else if (c == '\b') strcpy(escaped, "\\b");
+            else if (c == '\f') strcpy(escaped, "\\f");
+            else if (c == '\n') strcpy(escaped, "\\n");
+            else if (c == '\r') strcpy(escaped, "\\r");
+            else if (c == '\t') strcpy(escaped, "\\t");
+            else if (c < 0x20)
+                snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+            else
+                snprintf(escaped, sizeof(escaped), "%c", c);
+
+            snprintf(expected, sizeof(expected), "%.*s%s%.*s",
+                    position, input, escaped,
+                    19 - position, input + position + 1);
+
+            CU_ASSERT_STRING_EQUAL(expected, escape(input));
+
+        }
+
+    }
+
+}
+
@@ -0,0 +1,254 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "config.h"
+
+#include "common_suite.h"
+#include "guac_listing.h"
+
+#include <guacamole/socket.h>
+#include <guacamole/stream.h>
+#include <guacamole/user.h>
+
+#include <stdlib.h>
+#include <string.h>
+#include <CUnit/Basic.h>
+
+/**
+ * The length of the path of each long entry within the listing sent by
+ * test_guac_listing_stream(), which is long enough that a single entry
+ * requires several blobs.
+ */
+#define TEST_LONG_PATH_LENGTH 20000
+
+/**
+ * All data written to the socket created by test_guac_listing_stream() which
+ * has not yet been inspected.
+ */
+static char test_output[1048576];
+
+/**
+ * The number of bytes currently stored within test_output.
+ */
+static int test_output_length = 0;
+
+/**
+ * Socket write handler which appends all data written to test_output.
+ *
+ * @param socket
+ *     The socket being written to.
+ *
+ * @param buf
+ *     The data to write.
+ *
+ * @param count
+ *     The number of bytes to write.
+ *
+ * @return
+ *     The number of bytes written, which is always count.
+ */
+static ssize_t test_write_handler(guac_socket* socket,
+        const void* buf, size_t count) {
+
+    CU_ASSERT_FATAL(test_output_length + count <= sizeof(test_output));
+
+    memcpy(test_output + test_output_length, buf, count);
+    test_output_length += count;
+
+    return count;
+
+}
+
+/**
+ * Counts the number of instructions having the given opcode within all data
+ * written since the last call to this function, discarding that data.
+ *
+ * @param opcode
+ *     The opcode of the instructions to count, in Guacamole protocol form,
+ *     including the length prefix and trailing comma (ie: "4.blob,").
+ *
+ * @param other_opcode
+ *     The opcode of any other instructions to count within the same data,
+ *     in the same form as opcode.
+ *
+ * @param other_count
+ *     Pointer to an int which will receive the number of instructions
+ *     having the other opcode.
+ *
+ * @return
+ *     The number of instructions having the given opcode.
+ */
+static int test_count_instructions(const char* opcode,
+        const char* other_opcode, int* other_count) {
+
+    int i;
+    int count = 0;
+
+    *other_count = 0;
+
+    /* Instructions begin at the start of output or after a semicolon */
+    for (i = 0; i < test_output_length; i++) {
+
+        if (i != 0 && test_output[i - 1] != ';')
+            continue;
+
+        if (strncmp(test_output + i, opcode, strlen(opcode)) == 0)
+            count++;
+
+        else if (strncmp(test_output + i, other_opcode,
+                    strlen(other_opcode)) == 0)
+            (*other_count)++;
+
+    }
+
+    test_output_length = 0;
+    return count;
+
+}
+
+void test_guac_listing() {
+
+    guac_common_listing_cache* cache = guac_common_listing_cache_alloc();
+    guac_common_listing* listing;
+    guac_common_listing* cached;
+    int i;
+
+    /* Nothing cached initially */
+    CU_ASSERT_PTR_NULL(guac_common_listing_cache_get(cache, "/"));
+
+    /* Build listing large enough to require growth */
+    listing = guac_common_listing_alloc("/");
+    for (i = 0; i < GUAC_COMMON_LISTING_INITIAL_SIZE * 3; i++)
+        guac_common_listing_add(listing, "/file", "application/octet-stream");
+
+    guac_common_listing_add(listing, "/dir", GUAC_USER_STREAM_INDEX_MIMETYPE);
+
+    CU_ASSERT_EQUAL(GUAC_COMMON_LISTING_INITIAL_SIZE * 3 + 1, listing->count);
+    CU_ASSERT_STRING_EQUAL("/dir", listing->entries[listing->count - 1].path);
+
+    /* Cached listing is shared, with a reference held by the cache */
+    guac_common_listing_cache_put(cache, listing);
+    CU_ASSERT_EQUAL(2, listing->refcount);
+
+    cached = guac_common_listing_cache_get(cache, "/");
+    CU_ASSERT_PTR_EQUAL(listing, cached);
+    CU_ASSERT_EQUAL(3, listing->refcount);
+    guac_common_listing_release(cache, cached);
+
+    /* Other directories are not cached */
+    CU_ASSERT_PTR_NULL(guac_common_listing_cache_get(cache, "/dir"));
+
+    /* Invalidation releases only the reference held by the cache */
+    guac_common_listing_cache_invalidate(cache);
+    CU_ASSERT_PTR_NULL(guac_common_listing_cache_get(cache, "/"));
+    CU_ASSERT_EQUAL(1, listing->refcount);
+    guac_common_listing_release(cache, listing);
+
+    /* Filling the cache replaces existing listings */
+    for (i = 0; i < GUAC_COMMON_LISTING_CACHE_SIZE + 1; i++) {
+        listing = guac_common_listing_alloc(i % 2 ? "/odd" : "/even");
+        guac_common_listing_cache_put(cache, listing);
+        guac_common_listing_release(cache, listing);
+    }
+
+    cached = guac_common_listing_cache_get(cache, "/even");
+    CU_ASSERT_PTR_EQUAL(listing, cached);
+    CU_ASSERT_EQUAL(2, cached->refcount);
+    guac_common_listing_release(cache, cached);
+
+    guac_common_listing_cache_free(cache);
+
+}
+
+
+void test_guac_listing_stream() {
+
+    guac_common_listing_cache* cache = guac_common_listing_cache_alloc();
+    guac_common_listing* listing = guac_common_listing_alloc("/");
+    guac_common_listing_stream state;
+    char long_path[TEST_LONG_PATH_LENGTH + 1];
+    int i;
+
+    int sent = 0;
+    int acked = 0;
+    int ended = 0;
+    int new_ended;
+    int done = 0;
+
+    /* Mix short entries with entries requiring several blobs each */
+    memset(long_path, 'x', TEST_LONG_PATH_LENGTH);
+    long_path[TEST_LONG_PATH_LENGTH] = '\0';
+
+    for (i = 0; i < 200; i++) {
+        guac_common_listing_add(listing, i % 50 ? "/file" : long_path,
+                "application/octet-stream");
+    }
+
+    /* Cache listing, such that a reference remains after the stream ends */
+    guac_common_listing_cache_put(cache, listing);
+
+    /* Send listing to user whose output is captured */
+    guac_user* user = guac_user_alloc();
+    CU_ASSERT_PTR_NOT_NULL_FATAL(user);
+
+    user->socket = guac_socket_alloc();
+    user->socket->write_handler = test_write_handler;
+
+    guac_stream* stream = guac_user_alloc_stream(user);
+    CU_ASSERT_PTR_NOT_NULL_FATAL(stream);
+
+    guac_common_listing_stream_init(&state, user, stream, cache, listing);
+
+    /* Acknowledge one instruction at a time, starting with the "body" */
+    while (!done) {
+
+        done = guac_common_listing_stream_ack(&state, user, stream);
+        acked++;
+
+        sent += test_count_instructions("4.blob,", "3.end,", &new_ended);
+        ended += new_ended;
+
+        /* Never more unacknowledged blobs than the window allows, plus the
+         * blobs of the single entry which crossed the window */
+        CU_ASSERT(sent - (acked - 1) <= GUAC_COMMON_LISTING_WINDOW
+                + TEST_LONG_PATH_LENGTH / GUAC_COMMON_JSON_BLOB_SIZE + 1);
+
+        /* Stream must end only once every blob is acknowledged */
+        if (done) {
+            CU_ASSERT_EQUAL(sent, acked - 1);
+            CU_ASSERT_EQUAL(ended, 1);
+        }
+        else
+            CU_ASSERT_EQUAL(ended, 0);
+
+        CU_ASSERT_FATAL(acked <= 1000);
+
+    }
+
+    /* All entries, including those requiring several blobs, were sent */
+    CU_ASSERT(sent > 4 * (TEST_LONG_PATH_LENGTH / GUAC_COMMON_JSON_BLOB_SIZE));
+
+    /* The reference held by the stream is released once the stream ends */
+    CU_ASSERT_EQUAL(1, listing->refcount);
+
+    guac_socket_free(user->socket);
+    guac_user_free(user);
+    guac_common_listing_cache_free(cache);
+
+}
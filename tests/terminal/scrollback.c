@@ -0,0 +1,267 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "config.h"
+
+#include "buffer.h"
+#include "scrollback.h"
+#include "terminal.h"
+#include "terminal_suite.h"
+#include "types.h"
+
+#include <CUnit/Basic.h>
+
+#include <stdio.h>
+#include <string.h>
+
+/**
+ * The character used for blank cells within each test buffer.
+ */
+static guac_terminal_char test_blank_char = {
+    .value = 0,
+    .width = 1
+};
+
+/**
+ * Replaces the contents of the given row with the given characters, each of
+ * which occupies the given number of columns.
+ *
+ * @param buffer
+ *     The buffer containing the row.
+ *
+ * @param row
+ *     The index of the row to replace, relative to the top of the visible
+ *     area of the buffer.
+ *
+ * @param codepoints
+ *     The Unicode codepoints of the characters to store, terminated by zero.
+ *
+ * @param width
+ *     The number of columns occupied by each character.
+ */
+static void test_terminal_set_row(guac_terminal_buffer* buffer, int row,
+        const int* codepoints, int width) {
+
+    guac_terminal_char character = test_blank_char;
+    int column = 0;
+
+    /* Clear row */
+    guac_terminal_buffer_get_row(buffer, row, 0)->length = 0;
+
+    /* Store each character */
+    character.width = width;
+    while (*codepoints != 0) {
+        character.value = *(codepoints++);
+        guac_terminal_buffer_set_columns(buffer, row, column,
+                column + width - 1, &character);
+        column += width;
+    }
+
+}
+
+/**
+ * Replaces the contents of the given row with the given ASCII text.
+ *
+ * @param buffer
+ *     The buffer containing the row.
+ *
+ * @param row
+ *     The index of the row to replace, relative to the top of the visible
+ *     area of the buffer.
+ *
+ * @param text
+ *     The ASCII text to store.
+ */
+static void test_terminal_set_text(guac_terminal_buffer* buffer, int row,
+        const char* text) {
+
+    int codepoints[64];
+    int i = 0;
+
+    while (text[i] != '\0') {
+        codepoints[i] = (unsigned char) text[i];
+        i++;
+    }
+
+    codepoints[i] = 0;
+    test_terminal_set_row(buffer, row, codepoints, 1);
+
+}
+
+/**
+ * Scrolls the entire visible area of the given buffer up by one row, as is
+ * done by guac_terminal_scroll_up(), leaving the new bottom row blank.
+ *
+ * @param buffer
+ *     The buffer to scroll.
+ *
+ * @param height
+ *     The height of the visible area of the buffer, in rows.
+ */
+static void test_terminal_scroll(guac_terminal_buffer* buffer, int height) {
+
+    guac_terminal_buffer_shift_up(buffer, 1);
+
+    buffer->length++;
+    if (buffer->length > buffer->available)
+        buffer->length = buffer->available;
+
+    guac_terminal_buffer_get_row(buffer, height - 1, 0)->length = 0;
+
+}
+
+/**
+ * Returns a new snapshot of the given buffer, as would be produced for a
+ * terminal having the given height.
+ *
+ * @param buffer
+ *     The buffer to snapshot.
+ *
+ * @param height
+ *     The height of the visible area of the buffer, in rows.
+ *
+ * @return
+ *     A newly-allocated snapshot of the given buffer.
+ */
+static guac_terminal_snapshot* test_terminal_snapshot_alloc(
+        guac_terminal_buffer* buffer, int height) {
+
+    guac_terminal terminal;
+    memset(&terminal, 0, sizeof(terminal));
+
+    terminal.buffer = buffer;
+    terminal.term_height = height;
+
+    return guac_terminal_snapshot_alloc(&terminal);
+
+}
+
+void test_terminal_snapshot() {
+
+    guac_terminal_buffer* buffer;
+    guac_terminal_snapshot* snapshot;
+    char line[16];
+    int i;
+
+    /* Three visible rows within a buffer of eight rows */
+    buffer = guac_terminal_buffer_alloc(8, &test_blank_char);
+    CU_ASSERT_PTR_NOT_NULL_FATAL(buffer);
+
+    for (i = 0; i < 3; i++) {
+        sprintf(line, "line %i", i);
+        test_terminal_set_text(buffer, i, line);
+    }
+
+    /* Without scrollback, only the visible rows are included */
+    snapshot = test_terminal_snapshot_alloc(buffer, 3);
+    CU_ASSERT_PTR_NOT_NULL_FATAL(snapshot);
+    CU_ASSERT_EQUAL(3, snapshot->line_count);
+    CU_ASSERT_STRING_EQUAL("line 0\nline 1\nline 2", snapshot->text);
+    CU_ASSERT_EQUAL(strlen(snapshot->text), snapshot->length);
+    guac_terminal_snapshot_free(snapshot);
+
+    /* Scroll well past the end of the buffer, such that it wraps around
+     * and the oldest rows are reused */
+    for (i = 3; i < 20; i++) {
+        test_terminal_scroll(buffer, 3);
+        sprintf(line, "line %i", i);
+        test_terminal_set_text(buffer, 2, line);
+    }
+
+    /* Only the most recent eight rows remain, oldest first */
+    snapshot = test_terminal_snapshot_alloc(buffer, 3);
+    CU_ASSERT_PTR_NOT_NULL_FATAL(snapshot);
+    CU_ASSERT_EQUAL(8, snapshot->line_count);
+    CU_ASSERT_STRING_EQUAL(
+            "line 12\nline 13\nline 14\nline 15\n"
+            "line 16\nline 17\nline 18\nline 19", snapshot->text);
+    CU_ASSERT_EQUAL(strlen(snapshot->text), snapshot->length);
+    guac_terminal_snapshot_free(snapshot);
+
+    /* Visible rows reflect their current contents */
+    test_terminal_set_text(buffer, 2, "changed");
+    snapshot = test_terminal_snapshot_alloc(buffer, 3);
+    CU_ASSERT_PTR_NOT_NULL_FATAL(snapshot);
+    CU_ASSERT_STRING_EQUAL(
+            "line 12\nline 13\nline 14\nline 15\n"
+            "line 16\nline 17\nline 18\nchanged", snapshot->text);
+    guac_terminal_snapshot_free(snapshot);
+
+    guac_terminal_buffer_free(buffer);
+
+}
+
+void test_terminal_scrollback_cache() {
+
+    guac_terminal_buffer* buffer;
+    guac_terminal_snapshot* snapshot;
+    char line[16];
+    int i;
+
+    /* "café", and the double-width "中" */
+    const int narrow[] = { 'c', 'a', 'f', 0xE9, 0 };
+    const int wide[] = { 0x4E2D, 0 };
+
+    buffer = guac_terminal_buffer_alloc(16, &test_blank_char);
+    CU_ASSERT_PTR_NOT_NULL_FATAL(buffer);
+
+    /* Fill five visible rows */
+    for (i = 0; i < 5; i++) {
+        sprintf(line, "line %i", i);
+        test_terminal_set_text(buffer, i, line);
+    }
+
+    /* Shrink terminal to three rows, moving two rows into scrollback */
+    guac_terminal_buffer_shift_up(buffer, 2);
+
+    snapshot = test_terminal_snapshot_alloc(buffer, 3);
+    CU_ASSERT_PTR_NOT_NULL_FATAL(snapshot);
+    CU_ASSERT_EQUAL(5, snapshot->line_count);
+    CU_ASSERT_STRING_EQUAL("line 0\nline 1\nline 2\nline 3\nline 4",
+            snapshot->text);
+    guac_terminal_snapshot_free(snapshot);
+
+    /* Grow terminal back to five rows, and modify the rows which were
+     * previously within scrollback */
+    guac_terminal_buffer_shift_down(buffer, 2);
+    test_terminal_set_row(buffer, 0, narrow, 1);
+    test_terminal_set_row(buffer, 1, wide, 2);
+
+    snapshot = test_terminal_snapshot_alloc(buffer, 5);
+    CU_ASSERT_PTR_NOT_NULL_FATAL(snapshot);
+    CU_ASSERT_EQUAL(5, snapshot->line_count);
+    CU_ASSERT_STRING_EQUAL("caf\xC3\xA9\n\xE4\xB8\xAD\nline 2\nline 3\nline 4",
+            snapshot->text);
+    guac_terminal_snapshot_free(snapshot);
+
+    /* Shrink again; the modified rows must be cached again */
+    guac_terminal_buffer_shift_up(buffer, 2);
+
+    snapshot = test_terminal_snapshot_alloc(buffer, 3);
+    CU_ASSERT_PTR_NOT_NULL_FATAL(snapshot);
+    CU_ASSERT_EQUAL(5, snapshot->line_count);
+    CU_ASSERT_STRING_EQUAL("caf\xC3\xA9\n\xE4\xB8\xAD\nline 2\nline 3\nline 4",
+            snapshot->text);
+    CU_ASSERT_EQUAL(strlen(snapshot->text), snapshot->length);
+    guac_terminal_snapshot_free(snapshot);
+
+    guac_terminal_buffer_free(buffer);
+
+}
+
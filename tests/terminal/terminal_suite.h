@@ -0,0 +1,54 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef _GUAC_TEST_TERMINAL_SUITE_H
+#define _GUAC_TEST_TERMINAL_SUITE_H
+
+/**
+ * Test suite containing unit tests for the terminal emulator shared by the
+ * SSH and telnet protocol support. These tests are built only if terminal
+ * support is enabled.
+ *
+ * @file terminal_suite.h
+ */
+
+#include "config.h"
+
+/**
+ * Registers the terminal test suite with CUnit.
+ */
+int register_terminal_suite();
+
+/**
+ * Unit test for terminal snapshots, which verifies that the text of the
+ * visible rows and of the cached scrollback is assembled in order as rows
+ * scroll through a buffer which wraps around.
+ */
+void test_terminal_snapshot();
+
+/**
+ * Unit test for the scrollback text cache, which verifies that rows which
+ * return to view when the terminal grows, and which are then modified, are
+ * cached again when the terminal shrinks, and that multibyte and multi-column
+ * characters are cached correctly.
+ */
+void test_terminal_scrollback_cache();
+
+#endif
+
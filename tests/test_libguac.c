@@ -35,6 +35,7 @@ int main() {
     /* Register suites */
     register_protocol_suite();
     register_client_suite();
+    register_common_suite();
     register_util_suite();
 
     /* Run tests */
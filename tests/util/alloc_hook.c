@@ -0,0 +1,104 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "config.h"
+
+#include "util_suite.h"
+
+#include <guacamole/arena.h>
+
+#include <stdlib.h>
+
+#if defined(ENABLE_ARENA_STATS)
+
+/*
+ * libguac itself counts allocations if built with --enable-arena-stats, and
+ * those counts are reset along with the arena of the calling thread.
+ */
+
+void test_alloc_hook_reset() {
+    guac_arena_reset();
+}
+
+int test_alloc_hook_count() {
+    return guac_arena_malloc_count() + guac_arena_free_count();
+}
+
+#elif defined(__GLIBC__)
+
+/* Allocator functions exported by glibc, used by the counting wrappers */
+void* __libc_malloc(size_t size);
+void* __libc_calloc(size_t nmemb, size_t size);
+void* __libc_realloc(void* ptr, size_t size);
+void __libc_free(void* ptr);
+
+/**
+ * The number of calls to malloc(), calloc(), realloc() and free() made by the
+ * calling thread since test_alloc_hook_reset() was last invoked.
+ */
+static __thread int test_alloc_hook_calls
+    __attribute__((tls_model("initial-exec"))) = 0;
+
+/*
+ * The allocator functions below replace those of the C library for the
+ * entire test binary, including libguac, counting each call made by the
+ * calling thread.
+ */
+
+void* malloc(size_t size) {
+    test_alloc_hook_calls++;
+    return __libc_malloc(size);
+}
+
+void* calloc(size_t nmemb, size_t size) {
+    test_alloc_hook_calls++;
+    return __libc_calloc(nmemb, size);
+}
+
+void* realloc(void* ptr, size_t size) {
+    test_alloc_hook_calls++;
+    return __libc_realloc(ptr, size);
+}
+
+void free(void* ptr) {
+    if (ptr != NULL)
+        test_alloc_hook_calls++;
+    __libc_free(ptr);
+}
+
+void test_alloc_hook_reset() {
+    test_alloc_hook_calls = 0;
+}
+
+int test_alloc_hook_count() {
+    return test_alloc_hook_calls;
+}
+
+#else
+
+/* Allocations cannot be counted without glibc */
+
+void test_alloc_hook_reset() {
+}
+
+int test_alloc_hook_count() {
+    return -1;
+}
+
+#endif
@@ -0,0 +1,157 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "config.h"
+
+#include "util_suite.h"
+
+#include <CUnit/Basic.h>
+#include <guacamole/arena.h>
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+void test_guac_arena() {
+
+    int i;
+    unsigned char* first;
+    unsigned char* second;
+    unsigned char* large;
+    guac_arena_mark mark;
+
+    /* Start with an empty arena */
+    guac_arena_reset();
+
+    /* Allocations should be aligned and distinct */
+    first = guac_arena_alloc(10);
+    second = guac_arena_alloc(10);
+    CU_ASSERT_PTR_NOT_NULL_FATAL(first);
+    CU_ASSERT_PTR_NOT_NULL_FATAL(second);
+    CU_ASSERT_EQUAL(0, (uintptr_t) first % GUAC_ARENA_ALIGNMENT);
+    CU_ASSERT_EQUAL(0, (uintptr_t) second % GUAC_ARENA_ALIGNMENT);
+    CU_ASSERT_TRUE(second >= first + 10);
+
+    /* Allocations larger than a block should succeed */
+    mark = guac_arena_get_mark();
+    large = guac_arena_alloc(GUAC_ARENA_BLOCK_SIZE * 2);
+    CU_ASSERT_PTR_NOT_NULL_FATAL(large);
+    memset(large, 0xAA, GUAC_ARENA_BLOCK_SIZE * 2);
+
+    /* Releasing to a mark should reclaim everything after that mark */
+    guac_arena_release(mark);
+    CU_ASSERT_PTR_EQUAL(large, guac_arena_alloc(GUAC_ARENA_BLOCK_SIZE * 2));
+
+    /* Resetting should reclaim everything */
+    guac_arena_reset();
+    CU_ASSERT_PTR_EQUAL(first, guac_arena_alloc(10));
+
+    /* Once grown, repeating the same allocations should not touch the
+     * heap */
+    for (i=0; i<16; i++) {
+
+        guac_arena_reset();
+
+        mark = guac_arena_get_mark();
+        CU_ASSERT_PTR_NOT_NULL(guac_arena_alloc(GUAC_ARENA_BLOCK_SIZE / 2));
+        CU_ASSERT_PTR_NOT_NULL(guac_arena_alloc(GUAC_ARENA_BLOCK_SIZE));
+        guac_arena_release(mark);
+
+        CU_ASSERT_PTR_NOT_NULL(guac_arena_alloc(GUAC_ARENA_BLOCK_SIZE * 2));
+
+        CU_ASSERT_EQUAL(0, guac_arena_heap_allocations());
+
+    }
+
+    guac_arena_reset();
+
+}
+
+
+void test_guac_arena_trim() {
+
+    int i;
+    unsigned char* small;
+    unsigned char* large;
+
+    /* Grow arena with a block far larger than typically needed */
+    guac_arena_reset();
+    small = guac_arena_alloc(10);
+    large = guac_arena_alloc(GUAC_ARENA_BLOCK_SIZE * 16);
+    CU_ASSERT_PTR_NOT_NULL_FATAL(small);
+    CU_ASSERT_PTR_NOT_NULL_FATAL(large);
+    memset(large, 0xAA, GUAC_ARENA_BLOCK_SIZE * 16);
+
+    /* Blocks which are periodically needed at full size must be kept */
+    for (i = 0; i < GUAC_ARENA_TRIM_INTERVAL * 2; i++) {
+
+        guac_arena_reset();
+        CU_ASSERT_PTR_EQUAL(small, guac_arena_alloc(10));
+
+        if (i % 100 == 0)
+            CU_ASSERT_PTR_EQUAL(large,
+                    guac_arena_alloc(GUAC_ARENA_BLOCK_SIZE * 16));
+
+        CU_ASSERT_EQUAL(0, guac_arena_heap_allocations());
+
+    }
+
+    /* Blocks which are not needed for an entire interval must be freed */
+    for (i = 0; i < GUAC_ARENA_TRIM_INTERVAL * 2; i++) {
+        guac_arena_reset();
+        CU_ASSERT_PTR_EQUAL(small, guac_arena_alloc(10));
+    }
+
+    /* The large block must then be allocated again if needed */
+    CU_ASSERT_EQUAL(0, guac_arena_heap_allocations());
+    CU_ASSERT_PTR_NOT_NULL(guac_arena_alloc(GUAC_ARENA_BLOCK_SIZE * 16));
+    CU_ASSERT_EQUAL(1, guac_arena_heap_allocations());
+
+    guac_arena_reset();
+
+}
+
+void test_guac_arena_stats() {
+
+    /* Volatile, such that the allocations below cannot be optimized away */
+    char* volatile allocated;
+
+    guac_arena_reset();
+
+    allocated = malloc(10);
+    CU_ASSERT_PTR_NOT_NULL_FATAL(allocated);
+    allocated = realloc(allocated, 20);
+    CU_ASSERT_PTR_NOT_NULL_FATAL(allocated);
+    free(allocated);
+
+#ifdef ENABLE_ARENA_STATS
+    /* Each call must be counted until the arena is reset */
+    CU_ASSERT_EQUAL(2, guac_arena_malloc_count());
+    CU_ASSERT_EQUAL(2, guac_arena_free_count());
+#else
+    /* Nothing is counted unless built with --enable-arena-stats */
+    CU_ASSERT_EQUAL(0, guac_arena_malloc_count());
+    CU_ASSERT_EQUAL(0, guac_arena_free_count());
+#endif
+
+    guac_arena_reset();
+    CU_ASSERT_EQUAL(0, guac_arena_malloc_count());
+    CU_ASSERT_EQUAL(0, guac_arena_free_count());
+
+}
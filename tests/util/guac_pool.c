@@ -87,3 +87,46 @@ void test_guac_pool() {
 
 }
 
+void test_guac_pool_churn() {
+
+    guac_pool* pool;
+
+    int i;
+    int value;
+
+    /* Get pool */
+    pool = guac_pool_alloc(0);
+    CU_ASSERT_PTR_NOT_NULL_FATAL(pool);
+
+    /* Allocate a number of integers */
+    for (i=0; i<POOL_SIZE; i++)
+        CU_ASSERT_EQUAL(i, guac_pool_next_int(pool));
+
+    /* Free every other integer, from highest to lowest */
+    for (i=POOL_SIZE - 1; i>=0; i-=2)
+        guac_pool_free_int(pool, i);
+
+    CU_ASSERT_EQUAL(POOL_SIZE / 2, pool->active);
+
+    /* Freed integers should be reused in the order they were freed */
+    for (i=POOL_SIZE - 1; i>=0; i-=2)
+        CU_ASSERT_EQUAL(i, guac_pool_next_int(pool));
+
+    /* With no freed integers remaining, new integers are returned */
+    CU_ASSERT_EQUAL(POOL_SIZE, guac_pool_next_int(pool));
+
+    /* A freed integer should not be reused while older freed integers
+     * remain, even if repeatedly allocated and freed */
+    guac_pool_free_int(pool, 42);
+    guac_pool_free_int(pool, 43);
+    for (i=0; i<POOL_SIZE; i++) {
+        value = guac_pool_next_int(pool);
+        CU_ASSERT_EQUAL(i % 2 == 0 ? 42 : 43, value);
+        guac_pool_free_int(pool, value);
+    }
+
+    /* Free pool */
+    guac_pool_free(pool);
+
+}
+
@@ -0,0 +1,117 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "config.h"
+
+#include "util_suite.h"
+
+#include <CUnit/Basic.h>
+#include <guacamole/resampler.h>
+
+#include <stdint.h>
+#include <string.h>
+
+void test_guac_resampler() {
+
+    int i;
+    int length;
+    int split_length;
+    guac_resampler* resampler;
+
+    int16_t stereo[4] = { 1000, -1000, 3000, 1000 };
+    int16_t mono[4];
+    int8_t narrow[4];
+    int16_t upsampled[16];
+    int16_t input[256];
+    int16_t whole[512];
+    int16_t split[512];
+
+    /* Stereo to mono should average channels */
+    resampler = guac_resampler_alloc(8000, 2, 16, 8000, 1, 16);
+    CU_ASSERT_PTR_NOT_NULL_FATAL(resampler);
+    length = guac_resampler_convert(resampler,
+            (unsigned char*) stereo, sizeof(stereo), (unsigned char*) mono);
+    CU_ASSERT_EQUAL(4, length);
+    CU_ASSERT_EQUAL(0, mono[0]);
+    CU_ASSERT_EQUAL(2000, mono[1]);
+    guac_resampler_free(resampler);
+
+    /* 16-bit to 8-bit should keep the most significant byte */
+    resampler = guac_resampler_alloc(8000, 2, 16, 8000, 2, 8);
+    CU_ASSERT_PTR_NOT_NULL_FATAL(resampler);
+    length = guac_resampler_convert(resampler,
+            (unsigned char*) stereo, sizeof(stereo), (unsigned char*) narrow);
+    CU_ASSERT_EQUAL(4, length);
+    CU_ASSERT_EQUAL(1000 >> 8, narrow[0]);
+    CU_ASSERT_EQUAL(-1000 >> 8, narrow[1]);
+    guac_resampler_free(resampler);
+
+    /* Doubling the rate should interpolate between frames */
+    resampler = guac_resampler_alloc(8000, 1, 16, 16000, 1, 16);
+    CU_ASSERT_PTR_NOT_NULL_FATAL(resampler);
+    CU_ASSERT_TRUE(guac_resampler_max_output(resampler, 4) >= 8);
+    mono[0] = 1000;
+    mono[1] = 2000;
+    length = guac_resampler_convert(resampler,
+            (unsigned char*) mono, 4, (unsigned char*) upsampled);
+    CU_ASSERT_EQUAL(8, length);
+    CU_ASSERT_EQUAL(0,    upsampled[0]);
+    CU_ASSERT_EQUAL(500,  upsampled[1]);
+    CU_ASSERT_EQUAL(1000, upsampled[2]);
+    CU_ASSERT_EQUAL(1500, upsampled[3]);
+    guac_resampler_free(resampler);
+
+    /* Unsupported formats should be refused */
+    CU_ASSERT_PTR_NULL(guac_resampler_alloc(8000, 3, 16, 8000, 2, 16));
+    CU_ASSERT_PTR_NULL(guac_resampler_alloc(8000, 2, 24, 8000, 2, 16));
+
+    for (i = 0; i < 256; i++)
+        input[i] = i * 100 - 12800;
+
+    /* Convert all input at once */
+    resampler = guac_resampler_alloc(44100, 2, 16, 22050, 1, 16);
+    CU_ASSERT_PTR_NOT_NULL_FATAL(resampler);
+    length = guac_resampler_convert(resampler,
+            (unsigned char*) input, sizeof(input), (unsigned char*) whole);
+    CU_ASSERT_EQUAL(64 * sizeof(int16_t), length);
+    guac_resampler_free(resampler);
+
+    /* Convert the same input in odd-sized pieces, splitting samples */
+    resampler = guac_resampler_alloc(44100, 2, 16, 22050, 1, 16);
+    CU_ASSERT_PTR_NOT_NULL_FATAL(resampler);
+    split_length = 0;
+    for (i = 0; i < (int) sizeof(input); i += 7) {
+
+        int piece = sizeof(input) - i;
+        if (piece > 7)
+            piece = 7;
+
+        split_length += guac_resampler_convert(resampler,
+                (unsigned char*) input + i, piece,
+                (unsigned char*) split + split_length);
+
+    }
+    guac_resampler_free(resampler);
+
+    /* Output should be identical */
+    CU_ASSERT_EQUAL(length, split_length);
+    CU_ASSERT_EQUAL(0, memcmp(whole, split, length));
+
+}
+
@@ -0,0 +1,153 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "config.h"
+
+#include "palette.h"
+#include "scratch.h"
+#include "util_suite.h"
+
+#include <CUnit/Basic.h>
+
+#include <stdint.h>
+#include <string.h>
+
+void test_guac_scratch() {
+
+    unsigned char* palette;
+    unsigned char* rows;
+
+    /* Get initial scratch buffers */
+    palette = guac_scratch_get(GUAC_SCRATCH_PNG_PALETTE, 1024);
+    rows = guac_scratch_get(GUAC_SCRATCH_PNG_ROWS, 1024);
+    CU_ASSERT_PTR_NOT_NULL_FATAL(palette);
+    CU_ASSERT_PTR_NOT_NULL_FATAL(rows);
+
+    /* Each slot should have its own buffer */
+    CU_ASSERT_TRUE(palette != rows);
+
+    /* Buffers should be writable across their full size */
+    memset(palette, 0xAA, 1024);
+    memset(rows, 0x55, 1024);
+
+    /* Requests not exceeding the current size should reuse the buffer */
+    CU_ASSERT_PTR_EQUAL(palette,
+            guac_scratch_get(GUAC_SCRATCH_PNG_PALETTE, 1024));
+    CU_ASSERT_PTR_EQUAL(palette,
+            guac_scratch_get(GUAC_SCRATCH_PNG_PALETTE, 16));
+    CU_ASSERT_PTR_EQUAL(rows,
+            guac_scratch_get(GUAC_SCRATCH_PNG_ROWS, 512));
+
+    /* Larger requests should provide a buffer of at least that size */
+    rows = guac_scratch_get(GUAC_SCRATCH_PNG_ROWS, 65536);
+    CU_ASSERT_PTR_NOT_NULL_FATAL(rows);
+    memset(rows, 0x55, 65536);
+
+    /* Growing one slot should not affect others */
+    CU_ASSERT_PTR_EQUAL(palette,
+            guac_scratch_get(GUAC_SCRATCH_PNG_PALETTE, 1024));
+
+    /* The grown buffer should then be reused */
+    CU_ASSERT_PTR_EQUAL(rows,
+            guac_scratch_get(GUAC_SCRATCH_PNG_ROWS, 4096));
+
+}
+
+void test_guac_scratch_trim() {
+
+    unsigned char* rows;
+    unsigned char* large;
+    int i;
+
+    /* Grow buffer well beyond the size typically needed */
+    large = guac_scratch_get(GUAC_SCRATCH_JPEG_SCANLINE, 64 * 1024 * 1024);
+    CU_ASSERT_PTR_NOT_NULL_FATAL(large);
+    memset(large, 0xAA, 64 * 1024 * 1024);
+
+    /* A buffer which is periodically needed at full size must be kept */
+    for (i = 0; i < GUAC_SCRATCH_TRIM_INTERVAL * 2; i++) {
+        rows = guac_scratch_get(GUAC_SCRATCH_JPEG_SCANLINE,
+                (i % 100 == 0) ? 64 * 1024 * 1024 : 4096);
+        CU_ASSERT_PTR_EQUAL(large, rows);
+    }
+
+    /* A buffer which is not needed at full size for an entire interval must
+     * be replaced with a buffer of the size actually requested */
+    for (i = 0; i < GUAC_SCRATCH_TRIM_INTERVAL; i++)
+        rows = guac_scratch_get(GUAC_SCRATCH_JPEG_SCANLINE, 4096);
+
+    CU_ASSERT_PTR_NOT_NULL_FATAL(rows);
+    CU_ASSERT_TRUE(rows != large);
+    memset(rows, 0x55, 4096);
+
+    /* The smaller buffer should then be reused */
+    CU_ASSERT_PTR_EQUAL(rows,
+            guac_scratch_get(GUAC_SCRATCH_JPEG_SCANLINE, 1024));
+
+}
+
+void test_guac_scratch_alloc() {
+
+    guac_palette* palette;
+    unsigned char* rows;
+    uint32_t image[64 * 64];
+    int i;
+
+    /* Image data with few enough colors to be encoded using a palette */
+    for (i = 0; i < 64 * 64; i++)
+        image[i] = (i % 13) * 0x010203;
+
+    /* Grow buffers to the working size, spanning enough requests for any
+     * trimming of buffers grown by other tests to complete */
+    for (i = 0; i < GUAC_SCRATCH_TRIM_INTERVAL * 2; i++) {
+        guac_scratch_get(GUAC_SCRATCH_PNG_PALETTE, sizeof(guac_palette));
+        guac_scratch_get(GUAC_SCRATCH_PNG_ROWS, 64 * 64);
+    }
+
+    test_alloc_hook_reset();
+
+    /* Nothing to verify if allocator calls cannot be counted */
+    if (test_alloc_hook_count() == -1)
+        return;
+
+    /* Once grown, requesting scratch memory and building a palette within
+     * that memory must not allocate */
+    for (i = 0; i < GUAC_SCRATCH_TRIM_INTERVAL * 2; i++) {
+
+        palette = guac_scratch_get(GUAC_SCRATCH_PNG_PALETTE,
+                sizeof(guac_palette));
+        rows = guac_scratch_get(GUAC_SCRATCH_PNG_ROWS, 64 * 64);
+
+        CU_ASSERT_PTR_NOT_NULL_FATAL(palette);
+        CU_ASSERT_PTR_NOT_NULL_FATAL(rows);
+        CU_ASSERT_EQUAL(guac_palette_build(palette, (unsigned char*) image,
+                    64, 64, 64 * 4), 0);
+
+    }
+
+    CU_ASSERT_EQUAL(test_alloc_hook_count(), 0);
+    CU_ASSERT_EQUAL(palette->size, 13);
+
+    /* A request larger than the working size must allocate */
+    test_alloc_hook_reset();
+    CU_ASSERT_PTR_NOT_NULL(guac_scratch_get(GUAC_SCRATCH_PNG_ROWS,
+                128 * 128));
+    CU_ASSERT_TRUE(test_alloc_hook_count() > 0);
+
+}
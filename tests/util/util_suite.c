@@ -43,7 +43,15 @@ int register_util_suite() {
 
     /* Add tests */
     if (
-           CU_add_test(suite, "guac-pool",    test_guac_pool)    == NULL
+           CU_add_test(suite, "guac-arena",   test_guac_arena)   == NULL
+        || CU_add_test(suite, "guac-arena-trim", test_guac_arena_trim) == NULL
+        || CU_add_test(suite, "guac-arena-stats", test_guac_arena_stats) == NULL
+        || CU_add_test(suite, "guac-pool",    test_guac_pool)    == NULL
+        || CU_add_test(suite, "guac-pool-churn", test_guac_pool_churn) == NULL
+        || CU_add_test(suite, "guac-resampler", test_guac_resampler) == NULL
+        || CU_add_test(suite, "guac-scratch", test_guac_scratch) == NULL
+        || CU_add_test(suite, "guac-scratch-trim", test_guac_scratch_trim) == NULL
+        || CU_add_test(suite, "guac-scratch-alloc", test_guac_scratch_alloc) == NULL
         || CU_add_test(suite, "guac-unicode", test_guac_unicode) == NULL
        ) {
         CU_cleanup_registry();
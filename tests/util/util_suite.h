@@ -56,6 +56,49 @@
  */
 int register_util_suite();
 
+/**
+ * Resets the number of allocator calls counted for the calling thread by
+ * test_alloc_hook_count() to zero.
+ */
+void test_alloc_hook_reset();
+
+/**
+ * Returns the number of calls to malloc(), calloc(), realloc() and free()
+ * made by the calling thread since test_alloc_hook_reset() was last invoked,
+ * including calls made within libguac. Allocator calls can only be counted
+ * if the C library is glibc.
+ *
+ * @return
+ *     The number of allocator calls made by the calling thread since the
+ *     last reset, or -1 if allocator calls cannot be counted.
+ */
+int test_alloc_hook_count();
+
+/**
+ * Unit test for libguac's per-thread arena allocator. This test checks that
+ * arena allocations are aligned, that memory is reclaimed when the arena is
+ * released or reset, and that a grown arena does not allocate further heap
+ * memory for a repeated workload.
+ */
+void test_guac_arena();
+
+/**
+ * Unit test for libguac's per-thread arena allocator which verifies that
+ * blocks still needed at full size are kept across resets, and that blocks
+ * which are no longer needed are freed after GUAC_ARENA_TRIM_INTERVAL
+ * resets.
+ */
+void test_guac_arena_trim();
+
+/**
+ * Unit test for the per-frame allocation counts of libguac's per-thread
+ * arena. If libguac was built with --enable-arena-stats, this test checks
+ * that each malloc() and free() made by the calling thread is counted until
+ * the arena is reset. Otherwise, this test checks that the counts remain
+ * zero.
+ */
+void test_guac_arena_stats();
+
 /**
  * Unit test for the guac_pool structure and related functions. The guac_pool
  * structure provides a consistent source of pooled integers. This unit test
@@ -64,6 +107,44 @@ int register_util_suite();
  */
 void test_guac_pool();
 
+/**
+ * Unit test for the guac_pool structure which verifies that freed integers
+ * are reused in the order they were freed, and that the pool continues to
+ * behave correctly as integers are repeatedly allocated and freed.
+ */
+void test_guac_pool_churn();
+
+/**
+ * Unit test for the guac_resampler structure, which converts PCM audio
+ * between formats. This test checks that sample size and channel conversions
+ * are exact, that rate conversion interpolates linearly, and that audio split
+ * arbitrarily across calls converts identically to audio converted at once.
+ */
+void test_guac_resampler();
+
+/**
+ * Unit test for libguac's thread-local scratch buffers, which are reused by
+ * the image encoders to avoid allocating memory for every image. This test
+ * checks that buffers are reused unless a larger buffer is requested, and
+ * that each purpose receives its own buffer.
+ */
+void test_guac_scratch();
+
+/**
+ * Unit test for libguac's thread-local scratch buffers which verifies that a
+ * buffer grown for an unusually large request is released once it has gone
+ * unneeded for GUAC_SCRATCH_TRIM_INTERVAL requests, and is otherwise kept.
+ */
+void test_guac_scratch_trim();
+
+/**
+ * Unit test for libguac's thread-local scratch memory which verifies, by
+ * counting all allocator calls, that once scratch buffers have grown to the
+ * working size, requesting scratch memory and building a PNG palette within
+ * it does not allocate.
+ */
+void test_guac_scratch_alloc();
+
 /**
  * Unit test for libguac's Unicode convenience functions. This test checks that
  * the functions provided for determining string length, character length, and